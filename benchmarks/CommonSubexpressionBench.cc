@@ -0,0 +1,88 @@
+// Tree versus hash-consed lowering of generator-style modules, where a few
+// subexpressions recur across many statements. Reports IR nodes and bytes,
+// emitted x86 instructions and lowering plus emission time for each.
+//
+//   bench_cse [statements] [distinct-subexpressions]
+
+#include "X86Emitter.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <fmt/core.h>
+
+using namespace argc;
+
+namespace {
+
+struct Result {
+  size_t nodes;
+  size_t bytes;
+  size_t deduplicated;
+  size_t instructions;
+  double ms;
+};
+
+// Every statement combines two of the recurring subexpressions, as in
+// 'ret (a*b) + (c*d) - (a*b) / 3', with a and b small literals
+auto lower_and_emit(const size_t statements, const unsigned distinct, const bool share) -> Result {
+  const auto start = std::chrono::steady_clock::now();
+
+  ir::Module module{ "bench", ir::ExprPool(share), {} };
+  auto& exprs = module.exprs;
+  std::mt19937 rng(7);
+
+  const auto subexpression = [&](const unsigned k) {
+    const auto a = exprs.make_const(static_cast<int64_t>(k % 7) + 2);
+    const auto b = exprs.make_const(static_cast<int64_t>(k / 7) + 3);
+    const auto ab = exprs.make_binary(ir::Op::Mul, a, b);
+    const auto c = exprs.make_const(static_cast<int64_t>(k % 5) + 1);
+    return exprs.make_binary(ir::Op::Add, ab, c);
+  };
+
+  for (size_t s = 0; s < statements; ++s) {
+    const auto first = static_cast<ir::NodeId>(exprs.size());
+    const unsigned k = rng() % distinct;
+    const auto lhs = subexpression(k);
+    const auto rhs = subexpression(rng() % distinct);
+    const auto sum = exprs.make_binary(ir::Op::Sub, lhs, rhs);
+    const auto repeated = subexpression(k);       // Lowered again, as a parser would
+    const auto three = exprs.make_const(3);
+    const auto root = exprs.make_binary(ir::Op::Add, sum, exprs.make_binary(ir::Op::Div, repeated, three));
+    const auto kind = s + 1 == statements ? ir::StmtKind::Return : ir::StmtKind::Expression;
+    module.statements.push_back(ir::Statement{ kind, first, root, static_cast<uint32_t>(s + 1) });
+  }
+
+  codegen::X86Emitter emitter;
+  const auto assembly = emitter.emit_module(module);
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+
+  if (assembly.empty()) std::abort();
+  return Result{
+    exprs.size(), exprs.memory_bytes(), exprs.stats().deduplicated, emitter.stats().instructions,
+    std::chrono::duration<double, std::milli>(elapsed).count()
+  };
+}
+
+}
+
+auto main(const int argc, char** argv) -> int {
+  const size_t statements = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100'000;
+  const unsigned distinct = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10)) : 64;
+
+  const auto tree = lower_and_emit(statements, distinct, false);
+  const auto dag = lower_and_emit(statements, distinct, true);
+
+  fmt::print("{} statement(s) over {} distinct subexpression(s)\n", statements, distinct);
+  fmt::print("{:>6} {:>10} {:>12} {:>12} {:>13} {:>10}\n", "", "nodes", "IR bytes", "deduplicated", "instructions", "ms");
+  for (const auto& [label, r] : { std::pair{ "tree", tree }, std::pair{ "dag", dag } }) {
+    fmt::print("{:>6} {:>10} {:>12} {:>12} {:>13} {:>10.2f}\n",
+               label, r.nodes, r.bytes, r.deduplicated, r.instructions, r.ms);
+  }
+  fmt::print("nodes -{:.1f}%, IR bytes -{:.1f}%, instructions -{:.1f}%\n",
+             100.0 * (1.0 - static_cast<double>(dag.nodes) / static_cast<double>(tree.nodes)),
+             100.0 * (1.0 - static_cast<double>(dag.bytes) / static_cast<double>(tree.bytes)),
+             100.0 * (1.0 - static_cast<double>(dag.instructions) / static_cast<double>(tree.instructions)));
+  return 0;
+}
@@ -0,0 +1,139 @@
+// Per-snippet latency of compiling generated one-module programs in-process
+// with libargc, against spawning the argc binary once per snippet. The
+// in-process side runs 100k consecutive compilations on one reused
+// CompilerInstance, and a smaller batch building a fresh instance each time
+// to show what the reuse is worth.
+//
+//   bench_compiler_instance <path-to-argc> [compilations] [spawns]
+
+#include "CompilerInstance.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fmt/core.h>
+
+extern char** environ;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// The shape of what a service generates: a header and a few short statements
+auto snippet(const int i) -> std::string {
+  return fmt::format("module snippet\n{} * {} + {}\n({} - {}) / {}\nret {} * ({} + {}) - {}\n",
+                     i % 97, i % 13 + 2, i % 7, i, i % 31, i % 5 + 1, i % 11, i % 17, i % 3, i % 29);
+}
+
+auto elapsed_us(const Clock::time_point start) -> double {
+  return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+auto percentile(std::vector<double> values, const double p) -> double {
+  std::sort(values.begin(), values.end());
+  return values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))];
+}
+
+auto report(const std::string_view name, const std::vector<double>& us) -> void {
+  double total = 0;
+  for (const double t : us) total += t;
+  fmt::print("{:<24} {:>9} {:>10.2f} {:>10.2f} {:>10.2f} {:>10.2f}\n", name, us.size(),
+             total / static_cast<double>(us.size()), percentile(us, 0.5), percentile(us, 0.9), percentile(us, 0.99));
+}
+
+// Runs argc on one file, output discarded, as a build step would
+auto spawn_argc(const std::string& argc_path, const std::string& input, const std::string& output) -> bool {
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_addopen(&actions, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+
+  std::vector<std::string> args { argc_path, "--emit=asm", "-o", output, input };
+  std::vector<char*> argv;
+  for (auto& a : args) argv.push_back(a.data());
+  argv.push_back(nullptr);
+
+  pid_t pid = 0;
+  const int spawned = posix_spawn(&pid, argc_path.c_str(), &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  if (spawned != 0) return false;
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+}
+
+auto main(const int argc, char* argv[]) -> int {
+  if (argc < 2) {
+    fmt::print(stderr, "usage: {} <path-to-argc> [compilations] [spawns]\n", argv[0]);
+    return 2;
+  }
+  const std::string argc_path = argv[1];
+  const int compilations = argc > 2 ? std::atoi(argv[2]) : 100'000;
+  const int spawns = argc > 3 ? std::atoi(argv[3]) : 200;
+
+  std::vector<double> reused, fresh, spawned;
+  size_t bytes = 0;
+
+  argc::CompilerInstance instance;
+  for (int i = 0; i < compilations; ++i) {
+    const auto source = snippet(i);
+    const auto start = Clock::now();
+    const auto result = instance.compile(source);
+    reused.push_back(elapsed_us(start));
+    if (!result.succeeded) {
+      fmt::print(stderr, "snippet {} failed to compile\n", i);
+      return 1;
+    }
+    bytes += result.artifacts.front().code.size();
+  }
+
+  for (int i = 0; i < std::max(compilations / 10, 1); ++i) {
+    const auto source = snippet(i);
+    const auto start = Clock::now();
+    argc::CompilerInstance once;
+    const auto result = once.compile(source);
+    fresh.push_back(elapsed_us(start));
+    if (!result.succeeded) return 1;
+  }
+
+  const auto dir = std::filesystem::temp_directory_path() / "argc_bench_instance";
+  std::filesystem::create_directories(dir);
+  const auto input = (dir / "snippet.ar").string();
+  const auto output = (dir / "snippet.s").string();
+  for (int i = 0; i < spawns; ++i) {
+    std::ofstream(input) << snippet(i);
+    const auto start = Clock::now();
+    if (!spawn_argc(argc_path, input, output)) {
+      fmt::print(stderr, "argc failed on snippet {}\n", i);
+      return 1;
+    }
+    if (i == 0) continue;           // Cold page cache
+    spawned.push_back(elapsed_us(start));
+  }
+
+  const auto& stats = instance.stats();
+  fmt::print("{} snippets in-process ({} KiB of assembly), {} symbol table(s) built for {} module(s)\n",
+             reused.size(), bytes / 1024, stats.symbol_tables, stats.modules);
+  fmt::print("{:<24} {:>9} {:>10} {:>10} {:>10} {:>10}\n", "us per snippet", "runs", "mean", "median", "p90", "p99");
+  report("reused instance", reused);
+  report("instance per snippet", fresh);
+  report("spawning argc", spawned);
+
+  double reused_total = 0, spawned_total = 0;
+  for (const double t : reused) reused_total += t;
+  for (const double t : spawned) spawned_total += t;
+  fmt::print("In-process is {:.0f}x faster per snippet than spawning argc\n",
+             (spawned_total / static_cast<double>(spawned.size())) / (reused_total / static_cast<double>(reused.size())));
+  return 0;
+}
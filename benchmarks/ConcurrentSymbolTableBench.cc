@@ -0,0 +1,118 @@
+// Lookup throughput on a shared module scope as analysis threads are added:
+// a plain SymbolTable behind one mutex (the only safe way to share it),
+// the sharded SharedScope while collection is still open, and the frozen
+// flat index. Every thread resolves names through its own ScopeCursor.
+//
+//   bench_concurrent_symbol_table [symbols] [lookups-per-thread] [max-threads]
+
+#include "ConcurrentSymbolTable.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+
+using namespace argc;
+
+namespace {
+
+auto symbol_name(const size_t i) -> std::string { return "sym_" + std::to_string(i); }
+
+// One cursor per thread with a nested scope open, as a function body would have
+auto cursors(const SharedScope& scope, const unsigned threads) -> std::vector<std::unique_ptr<ScopeCursor>> {
+  std::vector<std::unique_ptr<ScopeCursor>> list;
+  for (unsigned t = 0; t < threads; ++t) {
+    list.push_back(std::make_unique<ScopeCursor>(scope));
+    list.back()->enter_scope("body");
+  }
+  return list;
+}
+
+// Million lookups per second across all threads
+template<typename Lookup>
+auto throughput(const unsigned threads, const size_t lookups, const std::vector<std::string>& queries, Lookup lookup) -> double {
+  std::atomic<size_t> found { 0 };
+  const auto start = std::chrono::steady_clock::now();
+  {
+    std::vector<std::jthread> workers;
+    for (unsigned t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        size_t hits = 0;
+        for (size_t i = 0, q = (t * 7919) % queries.size(); i < lookups; ++i, q = (q + 1) % queries.size()) {
+          hits += lookup(t, queries[q]) ? 1 : 0;
+        }
+        found += hits;
+      });
+    }
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  if (found != threads * lookups) fmt::print(stderr, "lookup mismatch\n");
+  return static_cast<double>(threads * lookups) / elapsed.count() / 1e6;
+}
+
+}
+
+auto main(const int argc, char* argv[]) -> int {
+  const size_t symbols = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 20000;
+  const size_t lookups = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2'000'000;
+  const unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::atoi(argv[3]))
+                                        : std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::string> queries;
+  for (size_t i = 0; i < symbols; ++i) queries.push_back(symbol_name(i));
+  std::shuffle(queries.begin(), queries.end(), std::mt19937(7));
+
+  const loc::SourceLocation location(0, 0, "");
+
+  SymbolTable locked_table;
+  std::mutex table_mutex;
+  const auto* locked_int = locked_table.make_type<PrimitiveType>("int");
+  locked_table.enter_scope("m");
+  for (size_t i = 0; i < symbols; ++i) {
+    locked_table.insert(locked_table.make_symbol(symbol_name(i), SymbolKind::VARIABLE, locked_int, location));
+  }
+
+  ConcurrentSymbolTable shared_table;
+  const auto* shared_int = shared_table.make_type<PrimitiveType>("int");
+  auto* module = shared_table.add_module("m", location);
+  for (size_t i = 0; i < symbols; ++i) {
+    module->declare(symbol_name(i), SymbolKind::VARIABLE, shared_int, location);
+  }
+
+  fmt::print("{} symbols in one module scope, {} lookups per thread (M lookups/s)\n\n", symbols, lookups);
+  fmt::print("{:>8} {:>14} {:>14} {:>14}\n", "threads", "mutex", "sharded", "frozen");
+
+  for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+    const double locked = throughput(threads, lookups, queries, [&](unsigned, const std::string& name) {
+      std::lock_guard lock(table_mutex);
+      return locked_table.lookup(name) != nullptr;
+    });
+
+    // Freezing is one-way, so each row measures the open table first and
+    // then publishes a copy of it
+    const auto open = cursors(*module, threads);
+    const double sharded = throughput(threads, lookups, queries, [&](const unsigned t, const std::string& name) {
+      return open[t]->lookup(name) != nullptr;
+    });
+
+    ConcurrentSymbolTable frozen_table;
+    auto* frozen_module = frozen_table.add_module("m", location);
+    for (size_t i = 0; i < symbols; ++i) {
+      frozen_module->declare(symbol_name(i), SymbolKind::VARIABLE, shared_int, location);
+    }
+    frozen_table.freeze();
+    const auto published = cursors(*frozen_module, threads);
+    const double frozen = throughput(threads, lookups, queries, [&](const unsigned t, const std::string& name) {
+      return published[t]->lookup(name) != nullptr;
+    });
+
+    fmt::print("{:>8} {:>14.1f} {:>14.1f} {:>14.1f}\n", threads, locked, sharded, frozen);
+  }
+  return 0;
+}
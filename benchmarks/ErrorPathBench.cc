@@ -0,0 +1,210 @@
+// Throughput of the compile pipeline on corpora where half and then all of
+// the files fail, with failures handed up the stages as err::Status, and
+// with the same failures thrown and caught per file the way the driver used
+// to do it. A passing corpus gives the baseline.
+//
+// Each file is a module of statements over random expression trees. In a
+// failing file, a literal at a random leaf of a random statement is out of
+// range. Lowering walks the tree recursively, as the IRBuilder visitor did
+// when failures were thrown, so a throw unwinds as many frames. Passing
+// files go on through the TypeChecker and the X86Emitter. Files are shared
+// out over the threads like the BuildScheduler shares out modules.
+//
+//   bench_error_path [files] [threads] [repetitions]
+
+#include "ErrorReporter.hh"
+#include "TypeChecker.hh"
+#include "X86Emitter.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <fmt/core.h>
+
+using namespace argc;
+using namespace argc::err;
+
+namespace {
+
+constexpr int64_t out_of_range = int64_t{1} << 40;
+
+// A parsed expression, standing in for the ANTLR parse tree
+struct TreeNode {
+  ir::Op op;
+  int64_t value;
+  uint32_t lhs, rhs;
+};
+
+struct SourceFile {
+  std::vector<TreeNode> nodes;
+  std::vector<uint32_t> statements;   // Root of each statement
+  bool fails;
+};
+
+auto random_tree(std::vector<TreeNode>& nodes, std::mt19937& rng, const unsigned depth) -> uint32_t {
+  if (depth == 0 || rng() % 4 == 0) {
+    nodes.push_back(TreeNode{ ir::Op::Const, static_cast<int64_t>(rng() % 100) + 1, 0, 0 });
+  } else {
+    // No constant multiplies: their planning would dominate the passing files
+    static constexpr ir::Op ops[] { ir::Op::Add, ir::Op::Sub, ir::Op::Add, ir::Op::Sub };
+    const auto lhs = random_tree(nodes, rng, depth - 1);
+    const auto rhs = random_tree(nodes, rng, depth - 1);
+    nodes.push_back(TreeNode{ ops[rng() % 4], 0, lhs, rhs });
+  }
+  return static_cast<uint32_t>(nodes.size() - 1);
+}
+
+// Every failing_every-th file fails; 0 for none
+auto make_corpus(const size_t files, const size_t failing_every) -> std::vector<SourceFile> {
+  std::mt19937 rng(7);
+  std::vector<SourceFile> corpus(files);
+  for (size_t f = 0; f < files; ++f) {
+    auto& file = corpus[f];
+    for (int s = 0; s < 32; ++s) file.statements.push_back(random_tree(file.nodes, rng, 8));
+    file.fails = failing_every != 0 && f % failing_every == failing_every - 1;
+    if (file.fails) {
+      // Any literal will do; deep ones are the common case
+      std::vector<uint32_t> literals;
+      for (uint32_t i = 0; i < file.nodes.size(); ++i) {
+        if (file.nodes[i].op == ir::Op::Const) literals.push_back(i);
+      }
+      file.nodes[literals[rng() % literals.size()]].value = out_of_range;
+    }
+  }
+  return corpus;
+}
+
+auto literal_status(ErrorReporter& reporter, const int64_t value) -> Status {
+  if (value <= INT32_MAX) return {};
+  return reporter.report<ErrorCode::IntegerOutOfRange>(
+    CompileStage::CodeGeneration, ErrorSeverity::Error, SourceLocation("bench.ar", 1, 1), "1099511627776");
+}
+
+// Lowering as the stages do it now: the failure is returned frame by frame
+[[gnu::noinline]] auto lower(const SourceFile& file, const uint32_t index, ir::ExprPool& pool,
+                             ErrorReporter& reporter) -> Expected<ir::NodeId> {
+  const auto& node = file.nodes[index];
+  if (node.op == ir::Op::Const) {
+    if (auto status = literal_status(reporter, node.value); !status) return std::unexpected(status.error());
+    return pool.make_const(node.value);
+  }
+  const auto lhs = lower(file, node.lhs, pool, reporter);
+  if (!lhs) return lhs;
+  const auto rhs = lower(file, node.rhs, pool, reporter);
+  if (!rhs) return rhs;
+  return pool.make_binary(node.op, *lhs, *rhs);
+}
+
+// Lowering as it used to be: the reporter threw out of the visitor
+[[gnu::noinline]] auto lower_throwing(const SourceFile& file, const uint32_t index, ir::ExprPool& pool,
+                                      ErrorReporter& reporter) -> ir::NodeId {
+  const auto& node = file.nodes[index];
+  if (node.op == ir::Op::Const) {
+    if (!literal_status(reporter, node.value)) throw std::runtime_error("Fatal compilation error");
+    return pool.make_const(node.value);
+  }
+  const auto lhs = lower_throwing(file, node.lhs, pool, reporter);
+  const auto rhs = lower_throwing(file, node.rhs, pool, reporter);
+  return pool.make_binary(node.op, lhs, rhs);
+}
+
+auto finish(const ir::Module& module, ErrorReporter& reporter) -> bool {
+  const auto types = sema::TypeChecker(reporter).check(module);
+  if (!types) return false;
+  codegen::X86Emitter emitter;
+  return !emitter.emit_module(module, &*types).empty();
+}
+
+auto compile(const SourceFile& file, ErrorReporter& reporter) -> bool {
+  ir::Module module{ "bench", {}, {} };
+  for (const auto root : file.statements) {
+    const auto first = static_cast<ir::NodeId>(module.exprs.size());
+    const auto lowered = lower(file, root, module.exprs, reporter);
+    if (!lowered) return false;
+    module.statements.push_back(ir::Statement{ ir::StmtKind::Expression, first, *lowered, 1 });
+  }
+  return finish(module, reporter);
+}
+
+auto compile_throwing(const SourceFile& file, ErrorReporter& reporter) -> bool {
+  try {
+    ir::Module module{ "bench", {}, {} };
+    for (const auto root : file.statements) {
+      const auto first = static_cast<ir::NodeId>(module.exprs.size());
+      const auto lowered = lower_throwing(file, root, module.exprs, reporter);
+      module.statements.push_back(ir::Statement{ ir::StmtKind::Expression, first, lowered, 1 });
+    }
+    return finish(module, reporter);
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+}
+
+struct Run {
+  double files_per_second;
+  size_t failed;
+};
+
+template<typename Compile>
+auto run(const std::vector<SourceFile>& corpus, const unsigned threads, Compile compile_file) -> Run {
+  ErrorReporter reporter(true, 100);
+  reporter.setEcho(false);
+  std::atomic<size_t> next { 0 };
+  std::atomic<size_t> failed { 0 };
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> workers;
+  for (unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&] {
+      for (size_t i; (i = next.fetch_add(1)) < corpus.size();) {
+        if (!compile_file(corpus[i], reporter)) failed.fetch_add(1);
+      }
+    });
+  }
+  for (auto& worker : workers) worker.join();
+  const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return Run{ static_cast<double>(corpus.size()) / seconds, failed.load() };
+}
+
+template<typename Compile>
+auto median_run(const std::vector<SourceFile>& corpus, const unsigned threads, const int repetitions,
+                Compile compile_file) -> Run {
+  std::vector<Run> runs;
+  for (int r = 0; r < repetitions; ++r) runs.push_back(run(corpus, threads, compile_file));
+  std::sort(runs.begin(), runs.end(), [](const Run& a, const Run& b) { return a.files_per_second < b.files_per_second; });
+  return runs[runs.size() / 2];
+}
+
+}
+
+auto main(const int argc, char** argv) -> int {
+  const size_t files = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000;
+  const unsigned threads = argc > 2 ? static_cast<unsigned>(std::strtoul(argv[2], nullptr, 10))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+  const int repetitions = argc > 3 ? std::atoi(argv[3]) : 5;
+
+  const auto passing = make_corpus(files, 0);
+  const auto half_failing = make_corpus(files, 2);
+  const auto failing = make_corpus(files, 1);
+
+  fmt::print("{} files, {} thread(s)\n", files, threads);
+  fmt::print("{:>14} {:>12} {:>8} {:>12}\n", "corpus", "propagation", "failed", "files/s");
+  const auto report = [](const char* corpus, const char* propagation, const Run& r) {
+    fmt::print("{:>14} {:>12} {:>8} {:>12.0f}\n", corpus, propagation, r.failed, r.files_per_second);
+  };
+  report("passing", "status", median_run(passing, threads, repetitions, compile));
+  for (const auto& [name, corpus] : { std::pair{ "half failing", &half_failing }, std::pair{ "all failing", &failing } }) {
+    const auto status = median_run(*corpus, threads, repetitions, compile);
+    const auto thrown = median_run(*corpus, threads, repetitions, compile_throwing);
+    report(name, "status", status);
+    report(name, "exceptions", thrown);
+    fmt::print("{:>14} status propagation at {:.2f}x the throughput of exceptions\n", "",
+               status.files_per_second / thrown.files_per_second);
+  }
+  return 0;
+}
@@ -0,0 +1,161 @@
+// Spills, code size and run time of the code argc generates for wide and
+// deep expressions, lowered with the stack machine (-O0) and with
+// Sethi-Ullman ordering plus linear-scan allocation (-O1 and up). Both
+// versions are assembled with the host C compiler and loaded with dlopen.
+//
+//   bench_register_allocation [calls]
+
+#include "X86Emitter.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+#include <dlfcn.h>
+#include <fmt/core.h>
+
+using namespace argc;
+using namespace argc::codegen;
+
+namespace {
+
+using Function = int32_t (*)();
+
+struct Shape {
+  std::string name;
+  ir::Module module;
+};
+
+auto leaf(ir::ExprPool& exprs, std::mt19937& rng) -> ir::NodeId {
+  return exprs.make_const(static_cast<int64_t>(rng() % 9) + 1);
+}
+
+auto op(std::mt19937& rng) -> ir::Op {
+  constexpr ir::Op ops[] = { ir::Op::Add, ir::Op::Sub, ir::Op::Mul };
+  return ops[rng() % 3];
+}
+
+// Full binary tree: every level doubles the values waiting on the stack
+auto wide(ir::ExprPool& exprs, std::mt19937& rng, const int depth) -> ir::NodeId {
+  if (depth == 0) return leaf(exprs, rng);
+  const auto lhs = wide(exprs, rng, depth - 1);
+  const auto rhs = wide(exprs, rng, depth - 1);
+  return exprs.make_binary(op(rng), lhs, rhs);
+}
+
+// A long spine with a small product hanging off every level, on a random
+// side. Left to right, each product on the left waits for the whole spine.
+// Built recursively so nodes come in the order a parse creates them.
+auto deep(ir::ExprPool& exprs, std::mt19937& rng, const int length) -> ir::NodeId {
+  if (length == 0) return leaf(exprs, rng);
+  const auto product = [&] {
+    const auto a = leaf(exprs, rng);
+    return exprs.make_binary(ir::Op::Mul, a, leaf(exprs, rng));
+  };
+  const auto operation = op(rng);
+  if (rng() % 2) {
+    const auto lhs = product();
+    return exprs.make_binary(operation, lhs, deep(exprs, rng, length - 1));
+  }
+  const auto lhs = deep(exprs, rng, length - 1);
+  return exprs.make_binary(operation, lhs, product());
+}
+
+auto random_tree(ir::ExprPool& exprs, std::mt19937& rng, const int depth) -> ir::NodeId {
+  if (depth == 0 || rng() % 6 == 0) return leaf(exprs, rng);
+  const auto lhs = random_tree(exprs, rng, depth - 1);
+  const auto rhs = random_tree(exprs, rng, depth - 1);
+  return exprs.make_binary(op(rng), lhs, rhs);
+}
+
+template<typename Build>
+auto shape(std::string name, const size_t statements, Build&& build) -> Shape {
+  Shape s{ std::move(name), ir::Module{ "", ir::ExprPool(false), {} } };
+  std::mt19937 rng(11);
+  for (size_t i = 0; i < statements; ++i) {
+    const auto first = static_cast<ir::NodeId>(s.module.exprs.size());
+    const auto root = build(s.module.exprs, rng);
+    const auto kind = i + 1 == statements ? ir::StmtKind::Return : ir::StmtKind::Expression;
+    s.module.statements.push_back(ir::Statement{ kind, first, root, static_cast<uint32_t>(i + 1) });
+  }
+  return s;
+}
+
+auto time_function(const Function f, const int calls, int32_t& result) -> double {
+  result = f();
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < calls; ++i) result ^= f();
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / calls;
+}
+
+}
+
+auto main(const int argc, char* argv[]) -> int {
+  const int calls = argc > 1 ? std::atoi(argv[1]) : 2'000'000;
+
+  std::vector<Shape> shapes;
+  for (const int depth : { 4, 8, 12 }) {
+    shapes.push_back(shape(fmt::format("wide d={}", depth), 1,
+                           [&](auto& exprs, auto& rng) { return wide(exprs, rng, depth); }));
+  }
+  for (const int length : { 16, 256 }) {
+    shapes.push_back(shape(fmt::format("deep n={}", length), 1,
+                           [&](auto& exprs, auto& rng) { return deep(exprs, rng, length); }));
+  }
+  shapes.push_back(shape("random x16", 16, [](auto& exprs, auto& rng) { return random_tree(exprs, rng, 10); }));
+
+  const auto dir = std::filesystem::temp_directory_path() / "argc_bench_regalloc";
+  std::filesystem::create_directories(dir);
+
+  std::string source = X86Emitter::file_header();
+  std::vector<EmitStats> stack_stats, register_stats;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    X86Emitter stack(true, Allocation::Stack), registers(true, Allocation::Registers);
+    shapes[i].module.name = fmt::format("stack_{}", i);
+    source += stack.emit_module(shapes[i].module);
+    shapes[i].module.name = fmt::format("registers_{}", i);
+    source += registers.emit_module(shapes[i].module);
+    stack_stats.push_back(stack.stats());
+    register_stats.push_back(registers.stats());
+  }
+  source += X86Emitter::file_footer();
+  std::ofstream(dir / "functions.s") << source;
+
+  const char* cc = std::getenv("CC") ? std::getenv("CC") : "cc";
+  const auto command = fmt::format("{} -shared -o {} {}", cc, (dir / "functions.so").string(), (dir / "functions.s").string());
+  if (std::system(command.c_str()) != 0) {
+    fmt::print(stderr, "Failed to assemble functions: {}\n", command);
+    return 1;
+  }
+
+  void* lib = dlopen((dir / "functions.so").c_str(), RTLD_NOW);
+  if (!lib) {
+    fmt::print(stderr, "dlopen failed: {}\n", dlerror());
+    return 1;
+  }
+
+  fmt::print("{:<12}{:>14}{:>12}{:>16}{:>14}{:>12}{:>12}{:>12}{:>10}\n", "shape", "stack spills", "stack insts",
+             "values in regs", "spilled", "reg insts", "stack ns", "reg ns", "speedup");
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    const auto stack = reinterpret_cast<Function>(dlsym(lib, fmt::format("argon_stack_{}", i).c_str()));
+    const auto registers = reinterpret_cast<Function>(dlsym(lib, fmt::format("argon_registers_{}", i).c_str()));
+
+    int32_t stack_result = 0;
+    int32_t register_result = 0;
+    const double t_stack = time_function(stack, calls, stack_result);
+    const double t_registers = time_function(registers, calls, register_result);
+
+    const auto& s = stack_stats[i];
+    const auto& r = register_stats[i];
+    fmt::print("{:<12}{:>14}{:>12}{:>16}{:>14}{:>12}{:>12.2f}{:>12.2f}{:>9.2f}x{}\n",
+               shapes[i].name, s.spills, s.instructions,
+               r.register_values, r.spills, r.instructions, t_stack, t_registers, t_stack / t_registers,
+               stack_result == register_result ? "" : "  MISMATCH");
+  }
+
+  dlclose(lib);
+  return 0;
+}
@@ -0,0 +1,103 @@
+// End-to-end cost of a one-file argc run, the shape of a build that invokes
+// the compiler once per tiny file. Spawns argc repeatedly with
+// --time-report and reports wall time and time to the first finished parse.
+//
+//   bench_startup <path-to-argc> [input] [runs]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fmt/core.h>
+
+extern char** environ;
+
+namespace {
+
+struct Run {
+  double wall_ms;
+  double first_parse_ms;
+};
+
+// Runs argc once; stdout is discarded, stderr carries the time report
+auto run_once(const std::string& argc_path, const std::string& input, Run& run) -> bool {
+  int pipe_fds[2];
+  if (pipe(pipe_fds) != 0) return false;
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+  posix_spawn_file_actions_adddup2(&actions, pipe_fds[1], STDERR_FILENO);
+  posix_spawn_file_actions_addclose(&actions, pipe_fds[0]);
+
+  std::vector<std::string> args { argc_path, "--time-report", input };
+  std::vector<char*> argv;
+  for (auto& a : args) argv.push_back(a.data());
+  argv.push_back(nullptr);
+
+  const auto start = std::chrono::steady_clock::now();
+  pid_t pid = 0;
+  const int spawned = posix_spawn(&pid, argc_path.c_str(), &actions, nullptr, argv.data(), environ);
+  posix_spawn_file_actions_destroy(&actions);
+  close(pipe_fds[1]);
+  if (spawned != 0) {
+    close(pipe_fds[0]);
+    return false;
+  }
+
+  std::string report;
+  char buffer[4096];
+  for (ssize_t n; (n = read(pipe_fds[0], buffer, sizeof(buffer))) > 0;) report.append(buffer, static_cast<size_t>(n));
+  close(pipe_fds[0]);
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  run.wall_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  const auto line = report.find("first parse done");
+  if (line == std::string::npos) return false;
+  run.first_parse_ms = std::strtod(report.c_str() + line + std::string_view("first parse done").size(), nullptr);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+auto percentile(std::vector<double> values, const double p) -> double {
+  std::sort(values.begin(), values.end());
+  return values[static_cast<size_t>(p * static_cast<double>(values.size() - 1))];
+}
+
+}
+
+auto main(const int argc, char* argv[]) -> int {
+  if (argc < 2) {
+    fmt::print(stderr, "usage: {} <path-to-argc> [input] [runs]\n", argv[0]);
+    return 2;
+  }
+  const std::string argc_path = argv[1];
+  const std::string input = argc > 2 ? argv[2] : "input/1.ar";
+  const int runs = argc > 3 ? std::atoi(argv[3]) : 200;
+
+  std::vector<double> wall, first_parse;
+  for (int i = 0; i < runs; ++i) {
+    Run run {};
+    if (!run_once(argc_path, input, run)) {
+      fmt::print(stderr, "argc failed on {}\n", input);
+      return 1;
+    }
+    if (i == 0) continue;           // Cold page cache
+    wall.push_back(run.wall_ms);
+    first_parse.push_back(run.first_parse_ms);
+  }
+
+  fmt::print("{} runs of argc on {}\n", wall.size(), input);
+  fmt::print("{:<24} {:>9} {:>9} {:>9}\n", "", "min", "median", "p90");
+  fmt::print("{:<24} {:>9.3f} {:>9.3f} {:>9.3f}\n", "time to first parse ms",
+             percentile(first_parse, 0), percentile(first_parse, 0.5), percentile(first_parse, 0.9));
+  fmt::print("{:<24} {:>9.3f} {:>9.3f} {:>9.3f}\n", "wall time ms",
+             percentile(wall, 0), percentile(wall, 0.5), percentile(wall, 0.9));
+  return 0;
+}
@@ -0,0 +1,106 @@
+// Times the code argc generates for x * c and x / d with strength reduction
+// on and off. Kernels are assembled with the host C compiler and loaded with
+// dlopen, so what runs is exactly the emitter's output.
+//
+//   bench_strength_reduction [iterations]
+
+#include "X86Emitter.hh"
+
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <dlfcn.h>
+#include <fmt/core.h>
+
+using namespace argc;
+using namespace argc::codegen;
+
+namespace {
+
+using Kernel = int32_t (*)(int32_t count, int32_t offset);
+
+struct Case {
+  ir::Op op;
+  int32_t constant;
+};
+
+// Sums f(i + offset) for i in [0, count) so every operation feeds the next add
+auto kernel(const std::string& name, X86Emitter& emitter, const Case& c, const bool reduce) -> std::string {
+  if (c.op == ir::Op::Mul) {
+    if (reduce) emitter.emit_multiply(plan_multiplication(c.constant));
+    else emitter.emit_multiply(MulRecipe{ c.constant, true });
+  } else {
+    emitter.emit_divide(reduce ? plan_signed_division(c.constant) : DivisionPlan{ DivisionPlan::Kind::Hardware, c.constant });
+  }
+
+  return fmt::format(
+    "\t.globl {0}\n{0}:\n"
+    "\txor r8d, r8d\n\txor r9d, r9d\n"
+    "1:\n\tlea eax, [r9+rsi]\n{1}"
+    "\tadd r8d, eax\n\tinc r9d\n\tcmp r9d, edi\n\tjne 1b\n"
+    "\tmov eax, r8d\n\tret\n",
+    name, emitter.take());
+}
+
+auto time_kernel(const Kernel k, const int32_t count, int32_t& checksum) -> double {
+  checksum = k(count / 10, -count / 20);   // Warm up
+  const auto start = std::chrono::steady_clock::now();
+  checksum = k(count, -count / 2);
+  const std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+  return elapsed.count() / count;
+}
+
+}
+
+auto main(const int argc, char* argv[]) -> int {
+  const int32_t iterations = argc > 1 ? std::atoi(argv[1]) : 50'000'000;
+  const std::vector<Case> cases {
+    {ir::Op::Mul, 3}, {ir::Op::Mul, 10}, {ir::Op::Mul, 45}, {ir::Op::Mul, 1023}, {ir::Op::Mul, -6},
+    {ir::Op::Div, 2}, {ir::Op::Div, 7}, {ir::Op::Div, 10}, {ir::Op::Div, -3}, {ir::Op::Div, 1000}, {ir::Op::Div, 641},
+  };
+
+  const auto dir = std::filesystem::temp_directory_path() / "argc_bench_sr";
+  std::filesystem::create_directories(dir);
+
+  X86Emitter emitter;
+  std::string source = X86Emitter::file_header();
+  for (size_t i = 0; i < cases.size(); ++i) {
+    source += kernel(fmt::format("before_{}", i), emitter, cases[i], false);
+    source += kernel(fmt::format("after_{}", i), emitter, cases[i], true);
+  }
+  source += X86Emitter::file_footer();
+  std::ofstream(dir / "kernels.s") << source;
+
+  const char* cc = std::getenv("CC") ? std::getenv("CC") : "cc";
+  const auto command = fmt::format("{} -shared -o {} {}", cc, (dir / "kernels.so").string(), (dir / "kernels.s").string());
+  if (std::system(command.c_str()) != 0) {
+    fmt::print(stderr, "Failed to assemble kernels: {}\n", command);
+    return 1;
+  }
+
+  void* lib = dlopen((dir / "kernels.so").c_str(), RTLD_NOW);
+  if (!lib) {
+    fmt::print(stderr, "dlopen failed: {}\n", dlerror());
+    return 1;
+  }
+
+  fmt::print("{:<12}{:>14}{:>14}{:>10}\n", "operation", "before ns/op", "after ns/op", "speedup");
+  for (size_t i = 0; i < cases.size(); ++i) {
+    const auto before = reinterpret_cast<Kernel>(dlsym(lib, fmt::format("before_{}", i).c_str()));
+    const auto after = reinterpret_cast<Kernel>(dlsym(lib, fmt::format("after_{}", i).c_str()));
+
+    int32_t sum_before = 0;
+    int32_t sum_after = 0;
+    const double t_before = time_kernel(before, iterations, sum_before);
+    const double t_after = time_kernel(after, iterations, sum_after);
+
+    const auto label = fmt::format("x {} {}", cases[i].op == ir::Op::Mul ? '*' : '/', cases[i].constant);
+    fmt::print("{:<12}{:>14.3f}{:>14.3f}{:>9.2f}x{}\n", label, t_before, t_after, t_before / t_after,
+               sum_before == sum_after ? "" : "  MISMATCH");
+  }
+
+  dlclose(lib);
+  return 0;
+}
@@ -0,0 +1,170 @@
+// Compares the arena-backed symbol table with the shared_ptr graph it
+// replaced: heap allocations to build a module-shaped table, and lookup
+// latency from the innermost scope. The legacy layout is reproduced here so
+// both sides are measured in one binary.
+//
+//   bench_symbol_table [symbols-per-scope] [depth] [lookups]
+
+#include "SymbolTable.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <fmt/core.h>
+
+namespace {
+
+std::atomic<size_t> heap_allocations { 0 };
+
+}
+
+auto operator new(const size_t size) -> void* {
+  heap_allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void* p = std::malloc(size != 0 ? size : 1)) return p;
+  throw std::bad_alloc();
+}
+
+auto operator delete(void* p) noexcept -> void { std::free(p); }
+auto operator delete(void* p, size_t) noexcept -> void { std::free(p); }
+
+namespace legacy {
+
+  // Shape of the table before symbols moved into an arena
+  struct Type {
+    std::string name;
+  };
+
+  struct SymbolEntry {
+    std::string name;
+    argc::SymbolKind kind;
+    std::shared_ptr<Type> type;
+    int scope_level;
+    argc::loc::SourceLocation location;
+  };
+
+  struct Scope {
+    int level;
+    std::string name;
+    std::shared_ptr<Scope> parent;
+    std::unordered_map<std::string, std::shared_ptr<SymbolEntry>> symbols;
+
+    auto lookup(const std::string& key) const -> std::shared_ptr<SymbolEntry> {
+      if (const auto it = symbols.find(key); it != symbols.end()) return it->second;
+      return parent ? parent->lookup(key) : nullptr;
+    }
+  };
+
+  struct SymbolTable {
+    std::shared_ptr<Scope> current = std::make_shared<Scope>(Scope{ 0, "global", nullptr, {} });
+
+    auto enter_scope(const std::string& name) -> void {
+      current = std::make_shared<Scope>(Scope{ current->level + 1, name, current, {} });
+    }
+    auto insert(const std::string& name, const std::shared_ptr<Type>& type) -> void {
+      current->symbols.emplace(name, std::make_shared<SymbolEntry>(
+        SymbolEntry{ name, argc::SymbolKind::VARIABLE, type, current->level, argc::loc::SourceLocation(0, 0, "") }));
+    }
+  };
+
+}
+
+namespace {
+
+struct Result {
+  size_t allocations;
+  double build_ms;
+  double lookup_ns;
+  size_t found;
+};
+
+auto symbol_name(const int depth, const int index) -> std::string {
+  return fmt::format("sym_{}_{}", depth, index);
+}
+
+// Keys spread over every scope so lookups walk a realistic number of parents
+auto make_queries(const int per_scope, const int depth, const size_t count) -> std::vector<std::string> {
+  std::mt19937 rng(42);
+  std::uniform_int_distribution<int> pick_depth(0, depth - 1), pick_index(0, per_scope - 1);
+  std::vector<std::string> queries;
+  queries.reserve(count);
+  for (size_t i = 0; i < count; ++i) queries.push_back(symbol_name(pick_depth(rng), pick_index(rng)));
+  return queries;
+}
+
+template<typename Build, typename Lookup>
+auto measure(Build build, Lookup lookup, const std::vector<std::string>& queries) -> Result {
+  Result result {};
+  const size_t before = heap_allocations.load();
+  const auto build_start = std::chrono::steady_clock::now();
+  auto table = build();
+  const std::chrono::duration<double, std::milli> build_time = std::chrono::steady_clock::now() - build_start;
+  result.allocations = heap_allocations.load() - before;
+  result.build_ms = build_time.count();
+
+  const auto lookup_start = std::chrono::steady_clock::now();
+  for (const auto& q : queries) result.found += lookup(table, q) ? 1 : 0;
+  const std::chrono::duration<double, std::nano> lookup_time = std::chrono::steady_clock::now() - lookup_start;
+  result.lookup_ns = lookup_time.count() / static_cast<double>(queries.size());
+  return result;
+}
+
+}
+
+auto main(const int argc, char* argv[]) -> int {
+  const int per_scope = argc > 1 ? std::atoi(argv[1]) : 2000;
+  const int depth = argc > 2 ? std::atoi(argv[2]) : 8;
+  const size_t lookups = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2'000'000;
+
+  // Names are generated up front so neither side pays for formatting
+  std::vector<std::vector<std::string>> names(depth);
+  for (int d = 0; d < depth; ++d) {
+    for (int i = 0; i < per_scope; ++i) names[d].push_back(symbol_name(d, i));
+  }
+  const auto queries = make_queries(per_scope, depth, lookups);
+
+  const auto old_result = measure(
+    [&] {
+      legacy::SymbolTable table;
+      const auto type = std::make_shared<legacy::Type>(legacy::Type{ "int" });
+      for (int d = 0; d < depth; ++d) {
+        table.enter_scope(fmt::format("scope_{}", d));
+        for (const auto& name : names[d]) table.insert(name, type);
+      }
+      return table;
+    },
+    [](const legacy::SymbolTable& table, const std::string& key) { return table.current->lookup(key) != nullptr; },
+    queries);
+
+  const auto new_result = measure(
+    [&] {
+      argc::SymbolTable table;
+      const auto* type = table.make_type<argc::PrimitiveType>("int");
+      for (int d = 0; d < depth; ++d) {
+        table.enter_scope(fmt::format("scope_{}", d));
+        for (const auto& name : names[d]) {
+          table.insert(table.make_symbol(name, argc::SymbolKind::VARIABLE, type, argc::loc::SourceLocation(0, 0, "")));
+        }
+      }
+      return table;
+    },
+    [](const argc::SymbolTable& table, const std::string& key) { return table.lookup(key) != nullptr; },
+    queries);
+
+  const size_t symbols = static_cast<size_t>(per_scope) * depth;
+  fmt::print("{} symbols in {} nested scopes, {} lookups\n\n", symbols, depth, lookups);
+  fmt::print("{:<12} {:>12} {:>10} {:>12} {:>12}\n", "table", "allocations", "build ms", "lookup ns", "found");
+  for (const auto& [label, r] : { std::pair{ "shared_ptr", old_result }, std::pair{ "arena", new_result } }) {
+    fmt::print("{:<12} {:>12} {:>10.2f} {:>12.1f} {:>12}\n", label, r.allocations, r.build_ms, r.lookup_ns, r.found);
+  }
+  fmt::print("\nallocation reduction {:.1f}x, lookup speedup {:.2f}x\n",
+             static_cast<double>(old_result.allocations) / static_cast<double>(std::max<size_t>(new_result.allocations, 1)),
+             old_result.lookup_ns / new_result.lookup_ns);
+  return old_result.found == new_result.found ? 0 : 1;
+}
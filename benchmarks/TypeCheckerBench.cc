@@ -0,0 +1,93 @@
+// Type checking throughput on single expressions of one to several million
+// nodes, built directly in the IR. Reports ns/node per shape and size; the
+// pass is linear, so the figures should stay flat as the size doubles.
+//
+//   bench_type_checker [million-nodes] [repetitions]
+
+#include "TypeChecker.hh"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+#include <fmt/core.h>
+
+using namespace argc;
+
+namespace {
+
+// Operators with small literal operands so nothing wraps and no warning fires
+auto pick_op(std::mt19937& rng) -> ir::Op {
+  static constexpr ir::Op ops[] { ir::Op::Add, ir::Op::Sub, ir::Op::Add, ir::Op::Div };
+  return ops[rng() % 4];
+}
+
+// ((((1 op 2) op 3) op 4) ...), the shape of a long source line
+auto build_chain(const size_t nodes) -> ir::Module {
+  ir::Module module{ "chain", {}, {} };
+  std::mt19937 rng(1);
+  auto acc = module.exprs.make_const(1);
+  while (module.exprs.size() + 2 <= nodes) {
+    const auto rhs = module.exprs.make_const(static_cast<int64_t>(rng() % 9) + 1);
+    acc = module.exprs.make_binary(pick_op(rng), acc, rhs);
+  }
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Return, 0, acc, 1 });
+  return module;
+}
+
+// Complete binary tree over the literals, emitted in post-order
+auto build_balanced(const size_t nodes) -> ir::Module {
+  ir::Module module{ "balanced", {}, {} };
+  std::mt19937 rng(2);
+  std::vector<std::pair<ir::NodeId, unsigned>> stack;   // (node, height)
+  for (size_t leaves = (nodes + 1) / 2; leaves > 0; --leaves) {
+    stack.emplace_back(module.exprs.make_const(static_cast<int64_t>(rng() % 9) + 1), 0);
+    while (stack.size() >= 2 && stack[stack.size() - 2].second == stack.back().second) {
+      const auto [rhs, height] = stack.back();
+      stack.pop_back();
+      const auto lhs = stack.back().first;
+      // Only literal divisors, so no subtree can make a division by zero possible
+      const auto op = height == 0 ? pick_op(rng) : ir::Op::Sub;
+      stack.back() = { module.exprs.make_binary(op, lhs, rhs), height + 1 };
+    }
+  }
+  while (stack.size() >= 2) {
+    const auto rhs = stack.back().first;
+    stack.pop_back();
+    stack.back().first = module.exprs.make_binary(ir::Op::Add, stack.back().first, rhs);
+  }
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Return, 0, stack.back().first, 1 });
+  return module;
+}
+
+auto measure(const ir::Module& module, const int repetitions) -> double {
+  err::ErrorReporter reporter(false, 100);
+  std::vector<double> samples;
+  for (int r = 0; r < repetitions; ++r) {
+    sema::TypeChecker checker(reporter);
+    const auto start = std::chrono::steady_clock::now();
+    const auto info = checker.check(module);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    if (!info || info->stats.nodes != module.exprs.size() || reporter.errorCount() != 0) std::abort();
+    samples.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(module.exprs.size()));
+  }
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+}
+
+auto main(const int argc, char** argv) -> int {
+  const size_t millions = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 4;
+  const int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+
+  fmt::print("{:>10} {:>10} {:>14} {:>14}\n", "shape", "nodes", "ns/node", "Mnodes/s");
+  for (size_t m = 1; m <= millions; m *= 2) {
+    for (const auto& module : { build_chain(m * 1'000'000), build_balanced(m * 1'000'000) }) {
+      const double ns = measure(module, repetitions);
+      fmt::print("{:>10} {:>10} {:>14.2f} {:>14.1f}\n", module.name, module.exprs.size(), ns, 1e3 / ns);
+    }
+  }
+  return 0;
+}
@@ -1,7 +1,11 @@
 grammar Argon;
 
 moduleDeclaration
-	:	'module' IDENTIFIER NEWLINE statement* EOF
+	:	'module' IDENTIFIER NEWLINE importDeclaration* statement* EOF
+;
+
+importDeclaration
+    :   'import' IDENTIFIER NEWLINE
 ;
 
 statement
@@ -0,0 +1,150 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace argc::mem {
+
+  struct ArenaStats {
+    size_t allocations { 0 };       // Objects and raw blocks handed out
+    size_t bytes { 0 };             // Bytes handed out, including alignment padding
+    size_t blocks { 0 };            // Chunks obtained from the system
+    size_t reserved { 0 };          // Bytes held in those chunks
+  };
+
+  // Bump allocator owning everything created for one compilation. Objects
+  // are never freed individually; release() runs the pending destructors
+  // in reverse creation order and returns all memory at once.
+  //
+  // Also usable as a std::pmr::memory_resource so containers owned by arena
+  // objects allocate from the same chunks.
+  class Arena final : public std::pmr::memory_resource {
+    struct Block {
+      std::unique_ptr<std::byte[]> data;
+      size_t size;
+    };
+
+    struct Finalizer {
+      void (*destroy)(void*);
+      void* object;
+    };
+
+    size_t block_size_;
+    std::vector<Block> blocks_;
+    std::byte* cursor_ { nullptr };
+    std::byte* limit_ { nullptr };
+    std::vector<Finalizer> finalizers_;
+    ArenaStats stats_;
+
+  public:
+    static constexpr size_t default_block_size = 64 * 1024;
+
+    explicit Arena(const size_t block_size = default_block_size) : block_size_(block_size) {}
+    ~Arena() override { release(); }
+
+    Arena(const Arena&) = delete;
+    auto operator=(const Arena&) -> Arena& = delete;
+
+    auto allocate_bytes(const size_t size, const size_t align) -> void* {
+      auto* aligned = align_up(cursor_, align);
+      if (cursor_ == nullptr || aligned + size > limit_) {
+        grow(size + align);
+        aligned = align_up(cursor_, align);
+      }
+      stats_.allocations++;
+      stats_.bytes += static_cast<size_t>(aligned + size - cursor_);
+      cursor_ = aligned + size;
+      return aligned;
+    }
+
+    template<typename T, typename... Args>
+    auto create(Args&&... args) -> T* {
+      void* memory = allocate_bytes(sizeof(T), alignof(T));
+      T* object = ::new (memory) T(std::forward<Args>(args)...);
+      if constexpr (!std::is_trivially_destructible_v<T>) {
+        finalizers_.push_back(Finalizer{ [](void* p) { static_cast<T*>(p)->~T(); }, object });
+      }
+      return object;
+    }
+
+    // Copy of the characters that lives as long as the arena
+    auto intern(const std::string_view text) -> std::string_view {
+      if (text.empty()) return {};
+      auto* chars = static_cast<char*>(allocate_bytes(text.size(), 1));
+      std::memcpy(chars, text.data(), text.size());
+      return { chars, text.size() };
+    }
+
+    auto release() -> void {
+      for (auto it = finalizers_.rbegin(); it != finalizers_.rend(); ++it) {
+        it->destroy(it->object);
+      }
+      finalizers_.clear();
+      blocks_.clear();
+      cursor_ = limit_ = nullptr;
+      stats_ = {};
+    }
+
+    // Like release(), but keeps the largest chunk and starts over in it, so
+    // an arena reused for many small compilations stops asking the system
+    // for memory once it has grown to fit one
+    auto reset() -> void {
+      for (auto it = finalizers_.rbegin(); it != finalizers_.rend(); ++it) {
+        it->destroy(it->object);
+      }
+      finalizers_.clear();
+      stats_ = {};
+      if (blocks_.empty()) {
+        cursor_ = limit_ = nullptr;
+        return;
+      }
+
+      const auto largest = std::max_element(blocks_.begin(), blocks_.end(),
+                                            [](const Block& a, const Block& b) { return a.size < b.size; });
+      Block kept = std::move(*largest);
+      blocks_.clear();
+      blocks_.push_back(std::move(kept));
+      cursor_ = blocks_.back().data.get();
+      limit_ = cursor_ + blocks_.back().size;
+      stats_.blocks = 1;
+      stats_.reserved = blocks_.back().size;
+    }
+
+    [[nodiscard]] auto stats() const -> const ArenaStats& { return stats_; }
+
+  private:
+    static auto align_up(std::byte* p, const size_t align) -> std::byte* {
+      const auto address = reinterpret_cast<std::uintptr_t>(p);
+      return reinterpret_cast<std::byte*>((address + align - 1) & ~(static_cast<std::uintptr_t>(align) - 1));
+    }
+
+    auto grow(const size_t minimum) -> void {
+      const size_t size = std::max(block_size_, minimum);
+      blocks_.push_back(Block{ std::make_unique_for_overwrite<std::byte[]>(size), size });
+      cursor_ = blocks_.back().data.get();
+      limit_ = cursor_ + size;
+      stats_.blocks++;
+      stats_.reserved += size;
+    }
+
+    auto do_allocate(const size_t bytes, const size_t alignment) -> void* override {
+      return allocate_bytes(bytes, alignment);
+    }
+
+    auto do_deallocate(void*, size_t, size_t) -> void override {}
+
+    [[nodiscard]] auto do_is_equal(const std::pmr::memory_resource& other) const noexcept -> bool override {
+      return this == &other;
+    }
+  };
+
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ErrorReporter.hh"
+
+namespace argc::build {
+
+  struct ImportRef {
+    std::string module_name;
+    uint32_t line { 0 };
+    uint32_t column { 0 };
+  };
+
+  // One input file as seen by the scheduler: the module it declares and
+  // the modules it imports.
+  struct ModuleUnit {
+    std::string path;
+    std::string name;
+    std::vector<ImportRef> imports;
+  };
+
+  enum class ModuleStatus { Pending, Succeeded, Failed, Skipped };
+
+  struct ScheduleStats {
+    size_t modules { 0 };
+    size_t workers { 0 };
+    std::vector<std::vector<size_t>> waves;       // Topological levels, by module index
+    std::vector<size_t> critical_path;            // Longest dependency chain by wall time
+    std::chrono::nanoseconds critical_path_time { 0 };
+    std::chrono::nanoseconds wall_time { 0 };
+  };
+
+  // Discovers the import graph of all inputs, rejects unresolved and cyclic
+  // imports, then compiles modules on a worker pool. A module becomes ready
+  // the moment its last import finishes, so independent chains never wait
+  // on a whole wave to drain.
+  class BuildScheduler {
+  public:
+    using CompileFn = std::function<bool(size_t index, const ModuleUnit& unit)>;
+
+  private:
+    err::ErrorReporter& reporter_;
+    unsigned jobs_;
+    std::vector<ModuleUnit> units_;
+    std::unordered_map<std::string, size_t> index_by_name_;
+    std::vector<std::vector<size_t>> dependencies_;   // module -> modules it imports
+    std::vector<std::vector<size_t>> dependents_;     // module -> modules importing it
+    std::vector<ModuleStatus> status_;
+    std::vector<std::chrono::nanoseconds> durations_;
+    ScheduleStats stats_;
+    bool resolved_ { false };
+
+  public:
+    explicit BuildScheduler(err::ErrorReporter& reporter, unsigned jobs = 0);
+
+    auto add_module(ModuleUnit unit) -> bool;
+
+    // Map import names onto modules and reject cycles. Must succeed before run().
+    auto resolve() -> bool;
+
+    // Compile every module, dependencies first. Returns false if any module
+    // failed or was skipped because one of its imports failed.
+    auto run(const CompileFn& compile) -> bool;
+
+    [[nodiscard]] auto index_of(const std::string& module_name) const -> std::optional<size_t>;
+    [[nodiscard]] auto modules() const -> const std::vector<ModuleUnit>& { return units_; }
+    [[nodiscard]] auto dependencies(const size_t index) const -> const std::vector<size_t>& { return dependencies_[index]; }
+    [[nodiscard]] auto dependents(const size_t index) const -> const std::vector<size_t>& { return dependents_[index]; }
+    [[nodiscard]] auto status(const size_t index) const -> ModuleStatus { return status_[index]; }
+    [[nodiscard]] auto stats() const -> const ScheduleStats& { return stats_; }
+
+    auto print_summary(std::FILE* out) const -> void;
+
+  private:
+    auto find_cycle() const -> std::vector<size_t>;
+    auto compute_waves() -> void;
+    auto compute_critical_path() -> void;
+  };
+
+}
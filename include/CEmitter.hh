@@ -0,0 +1,46 @@
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "ExprIR.hh"
+#include "TypeChecker.hh"
+
+namespace argc::codegen {
+
+  struct CEmitStats {
+    size_t operations { 0 };
+    size_t wrapping_operations { 0 };     // Lowered through the argon_* helpers
+    size_t temporaries { 0 };
+    size_t shared_values { 0 };           // Common subexpressions named once and reused
+  };
+
+  // Translation to self-contained C99. Each module becomes a function
+  // returning its 'ret' value; module 'main' also defines main(). Argon's
+  // wrapping i32 arithmetic is kept through small helpers built on the
+  // overflow builtins. Operations the type checker proved cannot wrap are
+  // written as plain C operators so the output stays readable. Common
+  // subexpressions of a sharing pool become named constants.
+  class CEmitter {
+    std::string out_;
+    CEmitStats stats_;
+    std::vector<uint32_t> uses_;          // Per node, for sharing pools
+
+  public:
+    static auto file_header() -> std::string;
+
+    auto emit_module(const ir::Module& module, const sema::TypeInfo* types = nullptr) -> std::string;
+
+    auto take() -> std::string { return std::exchange(out_, {}); }
+    [[nodiscard]] auto stats() const -> const CEmitStats& { return stats_; }
+
+  private:
+    auto emit_statement(const ir::ExprPool& exprs, const ir::Statement& stmt, const sema::TypeInfo* types) -> void;
+  };
+
+  // Runs `compiler -O2 -o output source` and waits for it. Returns the
+  // compiler's exit status, or -1 if it could not be started.
+  auto compile_c(const std::string& compiler, const std::string& source, const std::string& output) -> int;
+
+}
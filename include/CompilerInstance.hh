@@ -0,0 +1,80 @@
+#pragma once
+
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "CEmitter.hh"
+#include "ConfigHandler.hh"
+#include "ErrorReporter.hh"
+#include "ModulePipeline.hh"
+#include "SymbolTable.hh"
+#include "X86Emitter.hh"
+
+namespace argc {
+
+  struct CompileOptions {
+    ConfigHandler::OptimisationLevel optimisation { ConfigHandler::OptimisationLevel::ONE };
+    ConfigHandler::EmitKind emit { ConfigHandler::EmitKind::ASM };
+    size_t max_errors { 100 };
+  };
+
+  // What one module compiled to: assembly or C without the file header and
+  // footer, so artifacts from several calls can be joined into one unit
+  struct Artifact {
+    std::string module;
+    std::string path;
+    std::string code;
+  };
+
+  struct CompileResult {
+    bool succeeded { false };
+    std::vector<err::ErrorReporter::Error> diagnostics;   // Warnings included, in report order
+    std::vector<Artifact> artifacts;                      // Dependencies first; empty unless succeeded
+    codegen::EmitStats asm_stats;                         // Summed over the artifacts
+    codegen::CEmitStats c_stats;
+
+    // Every artifact between the file header and footer of the emit kind
+    [[nodiscard]] auto unit(ConfigHandler::EmitKind emit) const -> std::string;
+  };
+
+  struct InstanceStats {
+    size_t compilations { 0 };
+    size_t modules { 0 };
+    size_t symbol_tables { 0 };       // Built from scratch; the rest were recycled
+  };
+
+  // Compiles source buffers in-process and hands back diagnostics and code as
+  // data; nothing is printed and no file is touched. Modules go through the
+  // same ModulePipeline as the argc driver. Made for services that compile
+  // many small inputs: the lexer, token stream and parser are built once and
+  // re-pointed at each module, ANTLR's DFA cache stays warm between calls,
+  // symbol tables keep their arena chunks and the reporter its storage.
+  //
+  // Not thread-safe; use one instance per thread.
+  class CompilerInstance {
+    CompileOptions options_;
+    err::ErrorReporter reporter_;
+    std::unique_ptr<Frontend> frontend_;
+    std::vector<SymbolTable> tables_;     // One per module of the current call, reset before reuse
+    InstanceStats stats_;
+
+  public:
+    explicit CompilerInstance(CompileOptions options = {});
+    ~CompilerInstance();
+
+    CompilerInstance(const CompilerInstance&) = delete;
+    auto operator=(const CompilerInstance&) -> CompilerInstance& = delete;
+
+    // Compiles the buffers as one program: imports resolve between them and
+    // modules are compiled dependencies first. Buffers need only live for the call.
+    auto compile(std::span<const SourceBuffer> sources) -> CompileResult;
+    auto compile(std::string_view text, std::string path = "<input>") -> CompileResult;
+
+    [[nodiscard]] auto options() const -> const CompileOptions& { return options_; }
+    [[nodiscard]] auto stats() const -> const InstanceStats& { return stats_; }
+  };
+
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Arena.hh"
+#include "SymbolTable.hh"
+
+namespace argc {
+
+  // Scope shared between analysis threads (the global scope and module
+  // scopes). While it is being collected, declarations and lookups go to one
+  // of a fixed number of shards, each behind its own reader/writer lock and
+  // arena. freeze() publishes it: the shards are folded into one flat,
+  // immutable index and from then on lookups take no lock at all.
+  class SharedScope {
+    static constexpr size_t shard_count = 16;
+
+    struct Shard {
+      mutable std::shared_mutex mutex;
+      mem::Arena arena { 16 * 1024 };
+      std::pmr::unordered_map<std::string_view, SymbolEntry*> symbols { &arena };
+    };
+
+    struct Slot {
+      size_t hash { 0 };
+      SymbolEntry* entry { nullptr };
+    };
+
+    int level_;
+    std::string name_;
+    const SharedScope* parent_;
+    std::array<Shard, shard_count> shards_;
+
+    std::atomic<bool> frozen_ { false };
+    std::mutex freeze_mutex_;
+    std::vector<Slot> index_;               // Open addressing, power-of-two size; written once before frozen_
+    size_t mask_ { 0 };
+
+  public:
+    SharedScope(int level, std::string_view name, const SharedScope* parent);
+
+    SharedScope(const SharedScope&) = delete;
+    auto operator=(const SharedScope&) -> SharedScope& = delete;
+
+    // nullptr if the name is already declared here or the scope is frozen
+    auto declare(std::string_view name, SymbolKind kind, const Type* type,
+                 const loc::SourceLocation& location) -> SymbolEntry*;
+
+    auto lookup_current(std::string_view name) const -> SymbolEntry*;
+    auto lookup(std::string_view name) const -> SymbolEntry*;
+
+    // Publish step; call once every declaration for this scope is in.
+    // Idempotent and safe against concurrent readers.
+    auto freeze() -> void;
+    [[nodiscard]] auto frozen() const -> bool { return frozen_.load(std::memory_order_acquire); }
+
+    [[nodiscard]] auto size() const -> size_t;
+    [[nodiscard]] auto level() const -> int { return level_; }
+    [[nodiscard]] auto name() const -> std::string_view { return name_; }
+    [[nodiscard]] auto parent() const -> const SharedScope* { return parent_; }
+
+  private:
+    static auto hash(const std::string_view name) -> size_t { return std::hash<std::string_view>{}(name); }
+    auto shard(const size_t h) const -> const Shard& { return shards_[h % shard_count]; }
+    auto shard(const size_t h) -> Shard& { return shards_[h % shard_count]; }
+  };
+
+  // Global scope plus one SharedScope per module. Modules are added during
+  // collection; freeze() publishes all of them once collection is over.
+  class ConcurrentSymbolTable {
+    SharedScope global_;
+    mutable std::shared_mutex modules_mutex_;
+    std::unordered_map<std::string_view, std::unique_ptr<SharedScope>> modules_;
+    std::mutex types_mutex_;
+    mem::Arena types_;
+
+  public:
+    ConcurrentSymbolTable() : global_(0, "global", nullptr) {}
+
+    // Declares the module symbol globally and creates its scope; nullptr if
+    // a module of that name exists already
+    auto add_module(std::string_view name, const loc::SourceLocation& location) -> SharedScope*;
+    auto module(std::string_view name) const -> SharedScope*;
+
+    template<typename T, typename... Args>
+    auto make_type(Args&&... args) -> T* {
+      std::lock_guard lock(types_mutex_);
+      return types_.create<T>(std::forward<Args>(args)...);
+    }
+
+    auto freeze() -> void;
+
+    [[nodiscard]] auto global() -> SharedScope& { return global_; }
+    [[nodiscard]] auto global() const -> const SharedScope& { return global_; }
+  };
+
+  // Per-thread view for analysing one function or module body. Nested
+  // scopes live in the cursor's own arena and are never shared; lookups that
+  // fall off the outermost nested scope continue into the shared scope the
+  // cursor was opened on. Not thread safe: one cursor per thread.
+  class ScopeCursor {
+    const SharedScope* base_;
+    mem::Arena arena_;
+    std::vector<Scope*> scopes_;
+    int anonymous_scope_counter_ { 0 };
+
+  public:
+    explicit ScopeCursor(const SharedScope& base) : base_(&base), arena_(4 * 1024) {}
+
+    ScopeCursor(const ScopeCursor&) = delete;
+    auto operator=(const ScopeCursor&) -> ScopeCursor& = delete;
+
+    auto enter_scope(std::string_view name = {}) -> void;
+    auto exit_scope() -> void;
+
+    // Declares in the innermost nested scope; false outside any nested scope
+    // (shared scopes are only written through SharedScope::declare)
+    auto insert(std::string_view name, SymbolKind kind, const Type* type,
+                const loc::SourceLocation& location) -> SymbolEntry*;
+
+    auto lookup(std::string_view name) const -> SymbolEntry*;
+    auto lookup_current(std::string_view name) const -> SymbolEntry*;
+
+    [[nodiscard]] auto depth() const -> size_t { return scopes_.size(); }
+    [[nodiscard]] auto base() const -> const SharedScope& { return *base_; }
+  };
+
+}
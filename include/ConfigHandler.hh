@@ -1,5 +1,6 @@
 #pragma once
 
+#include <charconv>
 #include <filesystem>
 #include <vector>
 #include <string>
@@ -9,7 +10,7 @@
 namespace argc {
 
 class ConfigHandler {
-
+public:
   enum class TargetArch {
     X86_64, ARM, UNKNOWN
   };
@@ -21,12 +22,28 @@ class ConfigHandler {
     THREE     // Maximum
   };
 
+  enum class EmitKind {
+    NONE,     // Stop after the front end
+    ASM,      // Target assembly
+    C         // Portable C source
+  };
+
+private:
   std::vector<std::string> input_files_;
   std::string output_file_;
   TargetArch target_arch_;
   OptimisationLevel optimisation_level_;
+  EmitKind emit_kind_;
   bool emit_debug_info_;
+  bool watch_;                            // Keep running and recheck inputs when they are saved
+  bool time_report_;                      // Print startup and stage timings on exit
+  bool profile_parser_;                   // Profile grammar decisions while parsing
+  std::string parser_profile_file_;       // JSON copy of the parser profile, if requested
+  bool mem_report_;                       // Account heap use per stage and file
+  std::string mem_report_file_;           // JSON copy of the memory report, if requested
+  std::string host_cc_;                   // Compiler building the --emit=c output, if any
   int8_t verbosity_level_;                // Level for diagnostics (0=none, 1 = basic, 2 = detailed)
+  unsigned jobs_;                         // Parallel module compilations (0 = one per core)
   err::ErrorReporter& reporter_;
 
 public:
@@ -34,17 +51,25 @@ public:
   output_file_("a.out"),
   target_arch_(TargetArch::X86_64),
   optimisation_level_(OptimisationLevel::ONE),
+  emit_kind_(EmitKind::NONE),
   emit_debug_info_(false),
+  watch_(false),
+  time_report_(false),
+  profile_parser_(false),
+  mem_report_(false),
   verbosity_level_(0),
+  jobs_(0),
   reporter_(reporter)
   {}
 
   auto parseArgs (const int argc, char* argv[]) -> bool {
+    bool output_given = false;
     for (int i =1; i < argc; ++i) {
       if (const std::string arg {argv[i]}; arg == "-o" && i + 1 < argc) {
         output_file_ = argv[++i];
+        output_given = true;
         if (!validateOutputFile(output_file_)) {
-          reporter_.reportQuick(
+          (void)reporter_.reportQuick(
             err::ErrorCode::InvalidToken,
             err::CompileStage::Lexing,
             err::ErrorSeverity::Fatal,
@@ -56,7 +81,7 @@ public:
         std::string arch = argv[++i];
         target_arch_ = parseTargetArch(arch);
         if (target_arch_ == TargetArch::UNKNOWN ) {
-          reporter_.reportQuick(
+          (void)reporter_.reportQuick(
           err::ErrorCode::InvalidToken,
           err::CompileStage::Lexing,
           err::ErrorSeverity::Fatal,
@@ -67,9 +92,76 @@ public:
       } else if (arg == "-O0" || arg == "-O1" || arg == "-O2" || arg == "-O3") {
         optimisation_level_ = parseOptLevel(arg);
       }
+      else if (arg.starts_with("--emit=")) {
+        emit_kind_ = parseEmitKind(arg.substr(7));
+        if (emit_kind_ == EmitKind::NONE) {
+          (void)reporter_.reportQuick(
+          err::ErrorCode::InvalidToken,
+          err::CompileStage::Lexing,
+          err::ErrorSeverity::Fatal,
+          "Unsupported output kind provided to --emit"
+          );
+          return false;
+        }
+      }
+      else if (arg == "--cc") {
+        host_cc_ = "cc";
+      }
+      else if (arg.starts_with("--cc=") && arg.size() > 5) {
+        host_cc_ = arg.substr(5);
+      }
       else if (arg == "-g") {
         emit_debug_info_ = true;
       }
+      else if (arg == "--watch") {
+        watch_ = true;
+      }
+      else if (arg == "--time-report") {
+        time_report_ = true;
+      }
+      else if (arg == "--profile-parser") {
+        profile_parser_ = true;
+      }
+      else if (arg.starts_with("--profile-parser=")) {
+        profile_parser_ = true;
+        parser_profile_file_ = arg.substr(17);
+        if (!validateOutputFile(parser_profile_file_)) {
+          (void)reporter_.reportQuick(
+          err::ErrorCode::InvalidToken,
+          err::CompileStage::Lexing,
+          err::ErrorSeverity::Fatal,
+          "Invalid file path provided to --profile-parser"
+          );
+          return false;
+        }
+      }
+      else if (arg == "--mem-report") {
+        mem_report_ = true;
+      }
+      else if (arg.starts_with("--mem-report=")) {
+        mem_report_ = true;
+        mem_report_file_ = arg.substr(13);
+        if (!validateOutputFile(mem_report_file_)) {
+          (void)reporter_.reportQuick(
+          err::ErrorCode::InvalidToken,
+          err::CompileStage::Lexing,
+          err::ErrorSeverity::Fatal,
+          "Invalid file path provided to --mem-report"
+          );
+          return false;
+        }
+      }
+      else if (arg == "-j" && i + 1 < argc) {
+        if (!parseJobs(argv[++i], jobs_)) {
+          (void)reporter_.reportQuick(
+          err::ErrorCode::InvalidToken,
+          err::CompileStage::Lexing,
+          err::ErrorSeverity::Fatal,
+          "Invalid job count provided"
+          );
+          return false;
+        }
+      }
       else if (arg == "-v") {
         verbosity_level_ = 1;
       }
@@ -78,7 +170,7 @@ public:
       }
       else if (arg[0] != '-') {
         if (!validateInputFile(arg)) {
-          reporter_.reportQuick(
+          (void)reporter_.reportQuick(
           err::ErrorCode::InvalidToken,
           err::CompileStage::Lexing,
           err::ErrorSeverity::Fatal,
@@ -89,7 +181,7 @@ public:
         input_files_.push_back(arg);
       }
       else {
-        reporter_.reportQuick(
+        (void)reporter_.reportQuick(
         err::ErrorCode::InvalidToken,
         err::CompileStage::Lexing,
         err::ErrorSeverity::Fatal,
@@ -98,8 +190,17 @@ public:
         return false;
       }
     }
+    if (!host_cc_.empty() && emit_kind_ != EmitKind::C) {
+      (void)reporter_.reportQuick(
+        err::ErrorCode::InvalidToken,
+        err::CompileStage::Lexing,
+        err::ErrorSeverity::Fatal,
+        "--cc requires --emit=c"
+      );
+      return false;
+    }
     if (input_files_.empty()) {
-      reporter_.reportQuick(
+      (void)reporter_.reportQuick(
         err::ErrorCode::InvalidToken,
         err::CompileStage::Lexing,
         err::ErrorSeverity::Fatal,
@@ -107,6 +208,11 @@ public:
       );
       return false;
     }
+    // Bare --emit=c writes C source, which should not land in a file named
+    // like an executable; with --cc the binary keeps a.out
+    if (!output_given && emit_kind_ == EmitKind::C && host_cc_.empty()) {
+      output_file_ = "a.c";
+    }
 
     return true;
   }
@@ -116,8 +222,17 @@ public:
   [[nodiscard]] std::string getOutputFile () const { return output_file_; }
   [[nodiscard]] TargetArch getTargetArch () const { return target_arch_; }
   [[nodiscard]] OptimisationLevel getOptimisationLevel () const { return optimisation_level_; }
+  [[nodiscard]] EmitKind getEmitKind () const { return emit_kind_; }
   [[nodiscard]] bool shouldEmitDebugInfo () const { return emit_debug_info_; }
+  [[nodiscard]] bool shouldWatch () const { return watch_; }
+  [[nodiscard]] bool shouldReportTime () const { return time_report_; }
+  [[nodiscard]] bool shouldProfileParser () const { return profile_parser_; }
+  [[nodiscard]] const std::string& getParserProfileFile () const { return parser_profile_file_; }
+  [[nodiscard]] bool shouldReportMemory () const { return mem_report_; }
+  [[nodiscard]] const std::string& getMemReportFile () const { return mem_report_file_; }
+  [[nodiscard]] const std::string& getHostCompiler () const { return host_cc_; }
   [[nodiscard]] int8_t getVerbosity () const { return verbosity_level_; }
+  [[nodiscard]] unsigned getJobs () const { return jobs_; }
 
   // Convert TargetArch to string for logging or display
   [[nodiscard]] auto getTargetArchString () const -> std::string {
@@ -151,6 +266,22 @@ private:
     return TargetArch::UNKNOWN;
   }
 
+  // Parse the value of --emit=
+  [[nodiscard]] static auto parseEmitKind (const std::string& kind) -> EmitKind {
+    if (kind == "asm") return EmitKind::ASM;
+    if (kind == "c") return EmitKind::C;
+    return EmitKind::NONE;
+  }
+
+  // Parse a positive job count for -j
+  static auto parseJobs (const std::string& value, unsigned& jobs) -> bool {
+    unsigned parsed = 0;
+    const auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed);
+    if (ec != std::errc{} || ptr != value.data() + value.size() || parsed == 0) return false;
+    jobs = parsed;
+    return true;
+  }
+
   // Parse optimization level string
   static auto parseOptLevel (const std::string& opt) -> OptimisationLevel {
     if (opt == "-O0") return OptimisationLevel::ZERO;
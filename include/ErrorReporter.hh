@@ -1,14 +1,20 @@
 #pragma once
 #include <filesystem>
 #include <algorithm>
+#include <array>
 #include <chrono>
+#include <expected>
+#include <initializer_list>
+#include <iterator>
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <type_traits>
 #include <mutex>
 #include <source_location>
 #include <vector>
 #include <fstream>
 #include <fmt/core.h>
+#include <fmt/format.h>
 
 /**
  * Usage Example
@@ -20,23 +26,34 @@ auto exampleUsage() {
     // Example source location
     SourceLocation loc("main.ar", 42, 10, "var x i8 = 42.0; // Type mismatch");
 
-    // Report a type mismatch error
-    reporter.report(
-        ErrorCode::TypeMismatch,
+    // Report a type mismatch error; the template and its argument types
+    // are checked against the diagnostic table at compile time. An Error
+    // only stops the stage when the reporter stops on errors.
+    if (!reporter.report<ErrorCode::TypeMismatch>(
         CompileStage::TypeChecking,
         ErrorSeverity::Error,
         loc,
         "i8", "f32"
-    );
+    )) {
+        return;
+    }
 
-    // Quick report without source location
-    reporter.reportQuick(
+    // Quick report without source location; a warning never stops a stage,
+    // so its Status is discarded explicitly
+    (void)reporter.reportQuick(
         ErrorCode::InvalidToken,
         CompileStage::Lexing,
         ErrorSeverity::Warning,
         "Invalid character sequence"
     );
 
+    // Fatal diagnostics (and errors, when stopping on errors) come back as
+    // a Failure for the caller to hand up; nothing is thrown
+    if (!reporter.reportQuick(ErrorCode::SyntaxError, CompileStage::Parsing,
+                              ErrorSeverity::Fatal, "Unexpected end of input")) {
+        return;
+    }
+
     // Check if we should continue
     if (!reporter.shouldContinue()) {
         fmt::print(stderr, "Compilation aborted due to errors\n");
@@ -84,6 +101,10 @@ namespace argc::err {
     // Symbol collection
     DuplicateSymbol,
     UndefinedSymbol,
+    DuplicateModule,
+    DuplicateImport,
+    UnresolvedImport,
+    CyclicImport,
 
     // Semantic analysis
     InvalidOperation,
@@ -92,35 +113,150 @@ namespace argc::err {
     // Type checking
     IncompatibleTypes,
     MissingReturn,
+    IntegerOverflow,
 
-    // Code generation
+    // Code generation, including lowering to the IR
+    IntegerOutOfRange,
     InvalidInstruction,
-    ResourceLimit
+    ResourceLimit,
+
+    Count
   };
 
-  class ErrorTemplateDatabase {
-    static inline const std::unordered_map<ErrorCode, std::string> templates{
-      {ErrorCode::InvalidToken, "Invalid token encountered: {}"},
-      {ErrorCode::UnterminatedString, "Unterminated string literal"},
-      {ErrorCode::SyntaxError, "Syntax error: {}"},
-      {ErrorCode::UnexpectedToken, "Unexpected token: {}"},
-      {ErrorCode::DuplicateSymbol, "Duplicate symbol definition: {}"},
-      {ErrorCode::UndefinedSymbol, "Undefined symbol: {}"},
-      {ErrorCode::InvalidOperation, "Invalid operation: {}"},
-      {ErrorCode::TypeMismatch, "Type mismatch: expected {}, got {}"},
-      {ErrorCode::IncompatibleTypes, "Incompatible types: {} and {}"},
-      {ErrorCode::MissingReturn, "Missing return statement in function {}"},
-      {ErrorCode::InvalidInstruction, "Invalid instruction generated: {}"},
-      {ErrorCode::ResourceLimit, "Resource limit exceeded: {}"}
-    };
+  // Kinds of value a diagnostic template accepts, one per placeholder
+  enum class DiagnosticArg : uint8_t { Text, Integer };
 
+  struct DiagnosticTemplate {
+    static constexpr size_t max_args = 3;
+
+    ErrorCode code;
+    std::string_view format;
+    std::array<DiagnosticArg, max_args> args {};
+    size_t arity { 0 };
+
+    constexpr DiagnosticTemplate(const ErrorCode c, const std::string_view f,
+                                 const std::initializer_list<DiagnosticArg> a = {})
+      : code(c), format(f), arity(a.size()) {
+      std::copy(a.begin(), a.end(), args.begin());
+    }
+  };
+
+  // Single source of truth for diagnostic text, in ErrorCode order
+  inline constexpr std::array<DiagnosticTemplate, static_cast<size_t>(ErrorCode::Count)> diagnostic_templates {{
+    {ErrorCode::InvalidToken,       "Invalid token encountered: {}",            {DiagnosticArg::Text}},
+    {ErrorCode::UnterminatedString, "Unterminated string literal"},
+    {ErrorCode::SyntaxError,        "Syntax error: {}",                         {DiagnosticArg::Text}},
+    {ErrorCode::UnexpectedToken,    "Unexpected token: {}",                     {DiagnosticArg::Text}},
+    {ErrorCode::DuplicateSymbol,    "Duplicate symbol definition: {}",          {DiagnosticArg::Text}},
+    {ErrorCode::UndefinedSymbol,    "Undefined symbol: {}",                     {DiagnosticArg::Text}},
+    {ErrorCode::DuplicateModule,    "Module '{}' is already declared in {}",    {DiagnosticArg::Text, DiagnosticArg::Text}},
+    {ErrorCode::DuplicateImport,    "Module '{}' is imported more than once",   {DiagnosticArg::Text}},
+    {ErrorCode::UnresolvedImport,   "Imported module not found among inputs: {}", {DiagnosticArg::Text}},
+    {ErrorCode::CyclicImport,       "Import cycle detected: {}",                {DiagnosticArg::Text}},
+    {ErrorCode::InvalidOperation,   "Invalid operation: {}",                    {DiagnosticArg::Text}},
+    {ErrorCode::TypeMismatch,       "Type mismatch: expected {}, got {}",       {DiagnosticArg::Text, DiagnosticArg::Text}},
+    {ErrorCode::IncompatibleTypes,  "Incompatible types: {} and {}",            {DiagnosticArg::Text, DiagnosticArg::Text}},
+    {ErrorCode::MissingReturn,      "Missing return statement in function {}",  {DiagnosticArg::Text}},
+    {ErrorCode::IntegerOverflow,    "Integer overflow: '{}' wraps around in {}", {DiagnosticArg::Text, DiagnosticArg::Text}},
+    {ErrorCode::IntegerOutOfRange,  "Integer literal out of range: {}",         {DiagnosticArg::Text}},
+    {ErrorCode::InvalidInstruction, "Invalid instruction generated: {}",        {DiagnosticArg::Text}},
+    {ErrorCode::ResourceLimit,      "Resource limit exceeded: {} nested {} deep (the limit is {})",
+                                    {DiagnosticArg::Text, DiagnosticArg::Integer, DiagnosticArg::Integer}},
+  }};
+
+  namespace detail {
+    // Number of replacement fields, skipping {{ and }} escapes
+    constexpr auto count_placeholders(const std::string_view format) -> size_t {
+      size_t count = 0;
+      for (size_t i = 0; i < format.size(); ++i) {
+        if (format[i] == '{') {
+          if (i + 1 < format.size() && format[i + 1] == '{') { ++i; continue; }
+          ++count;
+        } else if (format[i] == '}' && i + 1 < format.size() && format[i + 1] == '}') {
+          ++i;
+        }
+      }
+      return count;
+    }
+
+    constexpr auto table_is_consistent() -> bool {
+      for (size_t i = 0; i < diagnostic_templates.size(); ++i) {
+        const auto& entry = diagnostic_templates[i];
+        if (static_cast<size_t>(entry.code) != i) return false;
+        if (count_placeholders(entry.format) != entry.arity) return false;
+      }
+      return true;
+    }
+
+    template<typename T>
+    constexpr auto accepts(const DiagnosticArg kind) -> bool {
+      using U = std::remove_cvref_t<T>;
+      switch (kind) {
+        case DiagnosticArg::Text:    return std::is_convertible_v<const U&, std::string_view>;
+        case DiagnosticArg::Integer: return std::is_integral_v<U> && !std::is_same_v<U, bool>;
+      }
+      return false;
+    }
+  }
+
+  static_assert(detail::table_is_consistent(),
+                "diagnostic_templates must list every ErrorCode in order, with one argument per placeholder");
+
+  class ErrorTemplateDatabase {
   public:
-    static std::string getTemplate(ErrorCode code) {
-      const auto it = templates.find(code);
-      return it != templates.end() ? it->second : "Unknown error";
+    static constexpr auto get(const ErrorCode code) -> const DiagnosticTemplate& {
+      return diagnostic_templates[static_cast<size_t>(code)];
     }
+
+    static constexpr auto getTemplate(const ErrorCode code) -> std::string_view {
+      return get(code).format;
+    }
+
+    template<ErrorCode Code, typename... Args>
+    static constexpr auto accepts() -> bool {
+      constexpr auto& entry = get(Code);
+      if (sizeof...(Args) != entry.arity) return false;
+      size_t i = 0;
+      return (detail::accepts<Args>(entry.args[i++]) && ...);
+    }
+  };
+
+  // Source position of a diagnostic plus the compiler code that raised it.
+  // Converts implicitly from SourceLocation so the caller is captured at
+  // the call site.
+  struct ReportSite {
+    SourceLocation location;
+    std::source_location caller;
+
+    ReportSite(SourceLocation loc = SourceLocation{},
+               const std::source_location src = std::source_location::current())
+      : location(std::move(loc)), caller(src) {}
+  };
+
+  // Format string checked against its arguments at compile time, carrying
+  // the caller's location (a defaulted parameter cannot follow a pack)
+  template<typename... Args>
+  struct CheckedFormat {
+    fmt::format_string<Args...> format;
+    std::source_location caller;
+
+    template<typename S>
+    consteval CheckedFormat(const S& s, const std::source_location src = std::source_location::current())
+      : format(s), caller(src) {}
+  };
+
+  // The diagnostic that stopped a stage: a Fatal one, or an Error when the
+  // reporter stops on errors. Stages hand it back up instead of throwing, so
+  // a failing file costs no more than a passing one.
+  struct Failure {
+    ErrorCode code;
+    CompileStage stage;
   };
 
+  template<typename T = void>
+  using Expected = std::expected<T, Failure>;
+  using Status = Expected<>;
+
   class ErrorReporter {
   public:
     struct Error {
@@ -139,11 +275,12 @@ namespace argc::err {
 
   private:
     std::vector<Error> errors_;
-    std::mutex mutex_;
+    mutable std::mutex mutex_;                     // Workers report concurrently under -j
     bool stop_on_error_ = false;
     size_t max_errors_ = 100;
     std::filesystem::path output_file_;
     bool verbose_ = false;
+    bool echo_ = true;
 
   public:
     explicit ErrorReporter(const bool stop_on_error = false, size_t max_errors = 100,
@@ -156,68 +293,76 @@ namespace argc::err {
     auto setMaxErrors(size_t max) { max_errors_ = max; }
     auto setStopOnError(bool stop) { stop_on_error_ = stop; }
     auto setOutputFile(const std::string &path) { output_file_ = path; }
+    auto setEcho(bool echo) { echo_ = echo; }      // Print diagnostics as they are reported
+
+    // Every report returns the Failure that should stop the current stage,
+    // if the diagnostic is one; see emit(). Discarding it needs a (void)
+    // cast, so a fatal diagnostic never lets a stage run on by accident.
 
     // Report error with source location
     template<typename... Args>
-    auto reportError(ErrorCode code,
+    [[nodiscard]] auto reportError(ErrorCode code,
                      CompileStage stage,
                      ErrorSeverity severity,
                      SourceLocation loc,
-                     fmt::format_string<Args...> fmt,
-                     Args &&... args,
-                     std::source_location src_loc = std::source_location::current()) -> void {
-      std::lock_guard<std::mutex> lock(mutex_);
-
-      if (errors_.size() >= max_errors_) {
-        return;
-      }
-
-      auto message = fmt::format(fmt, std::forward<Args>(args)...);
-      errors_.emplace_back(code, severity, stage, std::move(loc), std::move(message));
-
-      printError(errors_.back(), src_loc);
-
-      if (severity == ErrorSeverity::Fatal ||
-          (stop_on_error_ && severity == ErrorSeverity::Error)) {
-        throw std::runtime_error("Fatal compilation error");
-      }
+                     CheckedFormat<std::type_identity_t<Args>...> fmt,
+                     Args &&... args) -> Status {
+      return emit(code, stage, severity, std::move(loc), fmt.caller, fmt.format, std::forward<Args>(args)...);
     }
 
-    // Convenience method for reporting with error code template
-    template<typename... Args>
-    void report(ErrorCode code,
-                CompileStage stage,
+    // Report using the template registered for the error code. The argument
+    // count and types are checked against diagnostic_templates at compile time.
+    template<ErrorCode Code, typename... Args>
+    [[nodiscard]] auto report(CompileStage stage,
                 ErrorSeverity severity,
-                SourceLocation loc,
-                Args &&... args,
-                std::source_location src_loc = std::source_location::current()) {
-      report_error(code, stage, severity, loc,
-                   ErrorTemplateDatabase::getTemplate(code),
-                   std::forward<Args>(args)...,
-                   src_loc);
+                ReportSite site,
+                Args &&... args) -> Status {
+      static_assert(ErrorTemplateDatabase::accepts<Code, Args...>(),
+                    "arguments do not match the diagnostic template for this ErrorCode");
+      static constexpr fmt::format_string<Args...> format { ErrorTemplateDatabase::getTemplate(Code) };
+      return emit(Code, stage, severity, std::move(site.location), site.caller, format, std::forward<Args>(args)...);
     }
 
     // Quick report without source location
     template<typename... Args>
-    void reportQuick(ErrorCode code,
+    [[nodiscard]] auto reportQuick(ErrorCode code,
                      CompileStage stage,
                      ErrorSeverity severity,
-                     fmt::format_string<Args...> fmt,
-                     Args &&... args,
-                     std::source_location src_loc = std::source_location::current()) {
-      reportError(code, stage, severity, SourceLocation{}, fmt,
-                   std::forward<Args>(args)..., src_loc);
+                     CheckedFormat<std::type_identity_t<Args>...> fmt,
+                     Args &&... args) -> Status {
+      return emit(code, stage, severity, SourceLocation{}, fmt.caller, fmt.format, std::forward<Args>(args)...);
+    }
+
+    // Print and record a diagnostic collected elsewhere (e.g. by a reporter
+    // with echo off). It has already stopped whatever stage raised it.
+    auto replay(Error error, const std::source_location &src_loc = std::source_location::current()) -> void {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (errors_.size() >= max_errors_) {
+        return;
+      }
+      errors_.push_back(std::move(error));
+      if (echo_) {
+        printError(errors_.back(), src_loc);
+      }
     }
 
+    // Unlocked: only read it once no other thread can be reporting
+    [[nodiscard]] auto errors() const -> const std::vector<Error>& { return errors_; }
+
     // Get error statistics
-    [[nodiscard]] auto errorCount() const -> size_t { return errors_.size(); }
+    [[nodiscard]] auto errorCount() const -> size_t {
+      std::lock_guard<std::mutex> lock(mutex_);
+      return errors_.size();
+    }
 
     [[nodiscard]] auto warningCount() const -> size_t {
+      std::lock_guard<std::mutex> lock(mutex_);
       return std::count_if(errors_.begin(), errors_.end(),
                            [](const Error &e) { return e.severity == ErrorSeverity::Warning; });
     }
 
     [[nodiscard]] auto fatalCount() const -> size_t {
+      std::lock_guard<std::mutex> lock(mutex_);
       return std::count_if(errors_.begin(), errors_.end(),
                            [](const Error &e) { return e.severity == ErrorSeverity::Fatal; });
     }
@@ -228,42 +373,69 @@ namespace argc::err {
       errors_.clear();
     }
 
-    // Check if compilation should continue
+    // Check if compilation should continue. Counts every file's diagnostics,
+    // so a stage deciding about its own module should use its Status instead.
     [[nodiscard]] auto shouldContinue() const -> bool {
+      std::lock_guard<std::mutex> lock(mutex_);
       return errors_.size() < max_errors_ &&
              std::none_of(errors_.begin(), errors_.end(),
                           [](const Error &e) { return e.severity == ErrorSeverity::Fatal; });
     }
 
   private:
-    auto printError(const Error &error, const std::source_location &src_loc) const -> void {
-      std::string stage_str = stageToString(error.stage);
-      std::string severity_str = severityToString(error.severity);
+    // Nothing is formatted for diagnostics dropped by max_errors_, but a
+    // dropped fatal diagnostic still stops the stage
+    template<typename... Args>
+    [[nodiscard]] auto emit(ErrorCode code,
+              CompileStage stage,
+              ErrorSeverity severity,
+              SourceLocation loc,
+              const std::source_location &src_loc,
+              fmt::format_string<Args...> fmt,
+              Args &&... args) -> Status {
+      const bool stops = severity == ErrorSeverity::Fatal ||
+                         (stop_on_error_ && severity == ErrorSeverity::Error);
+      std::lock_guard<std::mutex> lock(mutex_);
 
-      std::string location_info;
-      if (!error.location.file.empty()) {
-        location_info = fmt::format("{}:{}:{}",
-                                    error.location.file, error.location.line, error.location.column);
+      if (errors_.size() < max_errors_) {
+        auto message = fmt::format(fmt, std::forward<Args>(args)...);
+        errors_.emplace_back(code, severity, stage, std::move(loc), std::move(message));
+
+        if (echo_) {
+          printError(errors_.back(), src_loc);
+        }
       }
 
+      if (stops) {
+        return std::unexpected(Failure{ code, stage });
+      }
+      return {};
+    }
+
+    auto printError(const Error &error, const std::source_location &src_loc) const -> void {
+      fmt::memory_buffer output;
+      auto out = std::back_inserter(output);
+
       // Basic error format
-      std::string output = fmt::format(
-        "{}: {} in {}: {}\n",
-        location_info.empty() ? "Compiler" : location_info,
-        severity_str,
-        stage_str,
-        error.message
-      );
+      if (!error.location.file.empty()) {
+        fmt::format_to(out, "{}:{}:{}", error.location.file, error.location.line, error.location.column);
+      } else {
+        fmt::format_to(out, "Compiler");
+      }
+      fmt::format_to(out, ": {} in {}: {}\n",
+                     severityToString(error.severity),
+                     stageToString(error.stage),
+                     error.message);
 
       // Add context if available
       if (!error.location.line_content.empty()) {
-        output += fmt::format("  {}\n", error.location.line_content);
-        output += fmt::format("  {}^ here\n", std::string(error.location.column - 1, ' '));
+        fmt::format_to(out, "  {}\n", error.location.line_content);
+        fmt::format_to(out, "  {:>{}}^ here\n", "", error.location.column > 0 ? error.location.column - 1 : 0);
       }
 
       // Add verbose information if enabled
       if (verbose_) {
-        output += fmt::format(
+        fmt::format_to(out,
           "  [ErrorCode: {}] [Time: {}] [Caller: {}:{}]\n",
           static_cast<int>(error.code),
           formatTimestamp(error.timestamp),
@@ -272,18 +444,19 @@ namespace argc::err {
         );
       }
 
-      fmt::print(stderr, "{}", output);
+      const std::string_view text(output.data(), output.size());
+      fmt::print(stderr, "{}", text);
 
       // Write to file if specified
       if (!output_file_.empty()) {
-        std::ofstream out(output_file_, std::ios::app);
-        if (out.is_open()) {
-          out << output;
+        std::ofstream out_file(output_file_, std::ios::app);
+        if (out_file.is_open()) {
+          out_file << text;
         }
       }
     }
 
-    static auto stageToString(CompileStage stage) -> std::string {
+    static constexpr auto stageToString(CompileStage stage) -> std::string_view {
       switch (stage) {
         case CompileStage::Lexing: return "Lexing";
         case CompileStage::Parsing: return "Parsing";
@@ -296,7 +469,7 @@ namespace argc::err {
       }
     }
 
-    static auto severityToString(ErrorSeverity severity) -> std::string {
+    static constexpr auto severityToString(ErrorSeverity severity) -> std::string_view {
       switch (severity) {
         case ErrorSeverity::Warning: return "warning";
         case ErrorSeverity::Error: return "error";
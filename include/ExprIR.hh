@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace argc::ir {
+
+  using NodeId = uint32_t;
+
+  enum class Op : uint8_t { Const, Add, Sub, Mul, Div };
+
+  struct Node {
+    Op op { Op::Const };
+    int64_t value { 0 };      // Const only
+    NodeId lhs { 0 };
+    NodeId rhs { 0 };
+
+    friend auto operator==(const Node&, const Node&) -> bool = default;
+  };
+
+  struct PoolStats {
+    size_t requested { 0 };       // Nodes asked for through make_*
+    size_t deduplicated { 0 };    // Requests answered with an existing node
+  };
+
+  // Flat expression storage. Operands are always created before the node
+  // using them, so for every statement the nodes [first, root] are already
+  // in post-order and passes can run as plain loops over indices.
+  //
+  // A sharing pool hash-conses: asking for a node identical to an existing
+  // one returns the existing id, so the expressions form a DAG. A statement
+  // then only owns the nodes it created ([first, root] is empty when its
+  // whole expression already existed), operands may belong to earlier
+  // statements, and one node may be an operand several times.
+  class ExprPool {
+    static constexpr NodeId empty_bucket = UINT32_MAX;
+
+    std::vector<Node> nodes_;
+    std::vector<NodeId> buckets_;     // Open addressing over nodes_, sharing pools only
+    bool share_ { false };
+    PoolStats stats_;
+
+  public:
+    ExprPool() = default;
+    explicit ExprPool(const bool share) : share_(share) {}
+
+    auto make_const(const int64_t value) -> NodeId {
+      return intern(Node{ Op::Const, value, 0, 0 });
+    }
+
+    auto make_binary(const Op op, const NodeId lhs, const NodeId rhs) -> NodeId {
+      return intern(Node{ op, 0, lhs, rhs });
+    }
+
+    [[nodiscard]] auto node(const NodeId id) const -> const Node& { return nodes_[id]; }
+    [[nodiscard]] auto size() const -> size_t { return nodes_.size(); }
+    [[nodiscard]] auto nodes() const -> const std::vector<Node>& { return nodes_; }
+    [[nodiscard]] auto shares() const -> bool { return share_; }
+    [[nodiscard]] auto stats() const -> const PoolStats& { return stats_; }
+
+    // Bytes held by the nodes and the sharing index
+    [[nodiscard]] auto memory_bytes() const -> size_t {
+      return nodes_.capacity() * sizeof(Node) + buckets_.capacity() * sizeof(NodeId);
+    }
+
+  private:
+    static auto hash(const Node& n) -> uint64_t {
+      uint64_t h = static_cast<uint64_t>(n.value) * 0x9e3779b97f4a7c15ull;
+      h ^= (static_cast<uint64_t>(n.lhs) << 32 | n.rhs) + 0x632be59bd9b4e019ull + (h << 6) + (h >> 2);
+      h ^= static_cast<uint64_t>(n.op) * 0xbf58476d1ce4e5b9ull;
+      return h ^ (h >> 31);
+    }
+
+    auto intern(const Node& n) -> NodeId {
+      ++stats_.requested;
+      if (!share_) return append(n);
+
+      if ((nodes_.size() + 1) * 2 > buckets_.size()) rehash();
+      const size_t mask = buckets_.size() - 1;
+      for (size_t i = hash(n) & mask;; i = (i + 1) & mask) {
+        if (buckets_[i] == empty_bucket) {
+          buckets_[i] = append(n);
+          return buckets_[i];
+        }
+        if (nodes_[buckets_[i]] == n) {
+          ++stats_.deduplicated;
+          return buckets_[i];
+        }
+      }
+    }
+
+    auto append(const Node& n) -> NodeId {
+      nodes_.push_back(n);
+      return static_cast<NodeId>(nodes_.size() - 1);
+    }
+
+    // Load factor stays at or below one half
+    auto rehash() -> void {
+      buckets_.assign(buckets_.empty() ? 64 : buckets_.size() * 2, empty_bucket);
+      const size_t mask = buckets_.size() - 1;
+      for (NodeId id = 0; id < nodes_.size(); ++id) {
+        size_t i = hash(nodes_[id]) & mask;
+        while (buckets_[i] != empty_bucket) i = (i + 1) & mask;
+        buckets_[i] = id;
+      }
+    }
+  };
+
+  enum class StmtKind : uint8_t { Expression, Return };
+
+  struct Statement {
+    StmtKind kind;
+    NodeId first;     // First node of this statement's expression
+    NodeId root;      // Value of the statement; nodes [first, root] belong to it
+    uint32_t line;
+  };
+
+  struct Module {
+    std::string name;
+    ExprPool exprs;
+    std::vector<Statement> statements;
+  };
+
+  [[nodiscard]] inline auto is_binary(const Op op) -> bool { return op != Op::Const; }
+
+  // How often each node's value is needed: once per operand reference and
+  // once per statement it is the value of. Always 1 for a tree; a node
+  // above 1 is a common subexpression.
+  [[nodiscard]] inline auto count_uses(const Module& module) -> std::vector<uint32_t> {
+    std::vector<uint32_t> uses(module.exprs.size(), 0);
+    for (const auto& n : module.exprs.nodes()) {
+      if (is_binary(n.op)) {
+        ++uses[n.lhs];
+        ++uses[n.rhs];
+      }
+    }
+    for (const auto& stmt : module.statements) ++uses[stmt.root];
+    return uses;
+  }
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <vector>
+
+#include "ArgonParser.h"
+
+namespace argc {
+
+  // Visits an expression's parse tree in post-order with an explicit stack,
+  // so the C++ stack stays flat however deep the tree is: the parser builds
+  // 'a + b + ... + z' as a left-deep tree, one level per operator.
+  // Parentheses are transparent.
+  //
+  //   on_binary(op, ctx)    after both operands; op is '+', '-', '*' or '/'
+  //   on_literal(ctx)       for each IntAtom; null for an operand that error
+  //                         recovery left out, so operands always pair up
+  template<typename OnBinary, typename OnLiteral>
+  auto walk_expression(ArgonParser::ExpressionContext* root, OnBinary&& on_binary, OnLiteral&& on_literal) -> void {
+    struct Pending {
+      antlr4::ParserRuleContext* node;
+      bool operands_done;
+    };
+    std::vector<Pending> stack { { root, false } };
+
+    while (!stack.empty()) {
+      const auto [node, operands_done] = stack.back();
+      stack.pop_back();
+
+      ArgonParser::ExpressionContext* lhs = nullptr;
+      ArgonParser::ExpressionContext* rhs = nullptr;
+      antlr4::Token* op = nullptr;
+      if (auto* add = dynamic_cast<ArgonParser::AddSubExprContext*>(node)) {
+        lhs = add->expression(0);
+        rhs = add->expression(1);
+        op = add->op;
+      } else if (auto* mul = dynamic_cast<ArgonParser::MulDivExprContext*>(node)) {
+        lhs = mul->expression(0);
+        rhs = mul->expression(1);
+        op = mul->op;
+      } else if (auto* atom = dynamic_cast<ArgonParser::AtomExprContext*>(node)) {
+        stack.push_back({ atom->atom(), false });
+        continue;
+      } else if (auto* paren = dynamic_cast<ArgonParser::ParenExprContext*>(node)) {
+        stack.push_back({ paren->expression(), false });
+        continue;
+      } else {
+        on_literal(dynamic_cast<ArgonParser::IntAtomContext*>(node));
+        continue;
+      }
+
+      if (operands_done || !op) {
+        if (op) {
+          on_binary(op->getText().front(), node);
+        } else {
+          on_literal(nullptr);      // The operator itself is missing; stands in for the whole node
+        }
+        continue;
+      }
+      stack.push_back({ node, true });
+      stack.push_back({ rhs, false });
+      stack.push_back({ lhs, false });
+    }
+  }
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace argc {
+
+  // Reports writes to a fixed set of files using inotify. The parent
+  // directories are watched rather than the files, so editors that save by
+  // renaming a temporary over the original are still seen. Only available
+  // on Linux; valid() is false elsewhere.
+  class FileWatcher {
+    int fd_ { -1 };
+    std::unordered_map<int, std::string> directories_;        // Watch descriptor -> directory
+    std::unordered_map<std::string, std::string> files_;      // Canonical path -> path as given
+
+  public:
+    FileWatcher();
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    auto operator=(const FileWatcher&) -> FileWatcher& = delete;
+
+    [[nodiscard]] auto valid() const -> bool { return fd_ >= 0; }
+
+    auto add(const std::string& path) -> bool;
+
+    // Blocks until a watched file changes, then keeps collecting for 'settle'
+    // so one save producing several events is reported once. Returns the
+    // changed paths as they were passed to add().
+    auto wait(std::chrono::milliseconds settle = std::chrono::milliseconds(15)) -> std::vector<std::string>;
+  };
+
+}
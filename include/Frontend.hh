@@ -0,0 +1,56 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "ArgonLexer.h"
+#include "ArgonParser.h"
+#include "ErrorReporter.hh"
+
+namespace argc {
+
+  // Lexer, token stream and parser, built once and re-pointed at each
+  // module, the same way LineCompiler serves watch mode. Syntax errors are
+  // reported instead of printed by ANTLR's console listener.
+  //
+  // One module at a time; a build compiling modules in parallel needs one
+  // per worker.
+  class Frontend {
+    class SyntaxErrorSink final : public antlr4::BaseErrorListener {
+      err::ErrorReporter& reporter_;
+      std::string path_;
+      size_t count_ { 0 };
+
+    public:
+      explicit SyntaxErrorSink(err::ErrorReporter& reporter) : reporter_(reporter) {}
+
+      auto bind(std::string path) -> void;
+      [[nodiscard]] auto count() const -> size_t { return count_; }
+
+      void syntaxError(antlr4::Recognizer*, antlr4::Token*, size_t line, size_t column,
+                       const std::string& msg, std::exception_ptr) override;
+    };
+
+    SyntaxErrorSink errors_;
+    std::unique_ptr<antlr4::ANTLRInputStream> input_;
+    ArgonLexer lexer_;
+    antlr4::CommonTokenStream tokens_;
+    ArgonParser parser_;
+
+  public:
+    explicit Frontend(err::ErrorReporter& reporter);
+
+    // Points the lexer at the module. Tokens are lexed as the parser asks
+    // for them unless lex_all() runs first.
+    auto load(std::string_view text, const std::string& path) -> void;
+    auto lex_all() -> void { tokens_.fill(); }
+
+    // The tree is owned by the parser and lives until the next load. Null if
+    // the module has syntax errors; a recovered tree is not worth lowering.
+    auto parse() -> ArgonParser::ModuleDeclarationContext*;
+
+    [[nodiscard]] auto parser() -> ArgonParser& { return parser_; }
+  };
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "ArgonBaseVisitor.h"
+#include "ExprIR.hh"
+#include "ErrorReporter.hh"
+
+namespace argc {
+// Lowers the parse tree of one module into the flat expression IR
+class IRBuilder : public ArgonBaseVisitor {
+  ir::Module module_;
+  err::ErrorReporter& error_reporter_;
+  std::string source_file_;
+  err::Status status_;        // First failure of the current lowering, if any
+
+public:
+
+  // With share_subexpressions the module's expressions are hash-consed
+  // into a DAG, so identical subexpressions are lowered to one node
+  explicit IRBuilder(err::ErrorReporter& reporter, std::string source_file = "", const bool share_subexpressions = false)
+    : module_{ {}, ir::ExprPool(share_subexpressions), {} },
+      error_reporter_(reporter), source_file_(std::move(source_file)) {}
+
+  // Lowers the module, stopping after the statement that fails the stage
+  auto build(ArgonParser::ModuleDeclarationContext *ctx) -> err::Status;
+
+  std::any visitModuleDeclaration(ArgonParser::ModuleDeclarationContext *ctx) override;
+
+  std::any visitExpressionStmt(ArgonParser::ExpressionStmtContext *ctx) override;
+  std::any visitReturnStmt(ArgonParser::ReturnStmtContext *ctx) override;
+
+  auto getModule () -> ir::Module& {
+    return module_;
+  }
+
+private:
+  // Lowers with walk_expression rather than the visitor, so the expression's
+  // depth never reaches the C++ stack
+  auto lower_statement(ir::StmtKind kind, ArgonParser::ExpressionContext *expr, antlr4::ParserRuleContext *stmt) -> void;
+  auto lower_literal(ArgonParser::IntAtomContext *ctx) -> ir::NodeId;
+};
+}
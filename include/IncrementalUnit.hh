@@ -0,0 +1,191 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace argc::incr {
+
+  // Byte range that differs between two versions of a buffer
+  struct TextEdit {
+    size_t offset { 0 };
+    size_t removed { 0 };       // Bytes of the old text replaced
+    size_t inserted { 0 };      // Bytes of the new text in their place
+
+    [[nodiscard]] auto empty() const -> bool { return removed == 0 && inserted == 0; }
+  };
+
+  // One top-level item of a module. The grammar is line oriented, so every
+  // line holding a token is a header, an import or a statement on its own.
+  struct Segment {
+    size_t begin;               // Start of the line, so columns match a full parse
+    size_t end;                 // Line break excluded
+    uint32_t line;              // 1-based, counted on '\n' like the lexer does
+
+    auto operator==(const Segment&) const -> bool = default;
+  };
+
+  struct UpdateStats {
+    TextEdit edit;
+    size_t first { 0 };         // Index of the first entry replaced
+    size_t removed { 0 };       // Entries dropped from the old text
+    size_t compiled { 0 };      // Entries compiled from the new text
+    size_t reused { 0 };        // Entries carried over untouched
+  };
+
+  constexpr auto is_line_break(const char c) -> bool { return c == '\n' || c == '\r'; }
+
+  // Shortest single edit turning 'before' into 'after' (common prefix and suffix trimmed)
+  auto diff_text(std::string_view before, std::string_view after) -> TextEdit;
+
+  // Non-blank lines of text[begin, end); 'line' is the line number at 'begin'
+  auto segment_lines(std::string_view text, size_t begin, size_t end, uint32_t line, std::vector<Segment>& out) -> void;
+  auto segment_lines(std::string_view text) -> std::vector<Segment>;
+
+  auto count_newlines(std::string_view text) -> uint32_t;
+
+  // Keeps one compiled result per segment of a buffer. update() diffs the new
+  // buffer against the previous one and recompiles only the segments on the
+  // lines the edit touched; everything after them is shifted, not recompiled.
+  // Results must therefore not depend on the segment's position: the compile
+  // callback sees the line alone and reports positions relative to it.
+  template<typename Result>
+  class IncrementalUnit {
+  public:
+    using CompileFn = std::function<Result(std::string_view line_text)>;
+
+    struct Entry {
+      Segment segment;
+      Result result;
+    };
+
+  private:
+    CompileFn compile_;
+    std::string text_;
+    std::vector<Entry> entries_;
+
+  public:
+    explicit IncrementalUnit(CompileFn compile) : compile_(std::move(compile)) {}
+
+    auto reset(std::string text) -> size_t {
+      text_ = std::move(text);
+      entries_.clear();
+      for (const auto& segment : segment_lines(text_)) {
+        entries_.push_back(Entry{ segment, compile_(slice(segment)) });
+      }
+      return entries_.size();
+    }
+
+    auto update(std::string text) -> UpdateStats {
+      UpdateStats stats;
+      stats.edit = diff_text(text_, text);
+      if (stats.edit.empty()) {
+        stats.reused = entries_.size();
+        return stats;
+      }
+
+      // Widen the edit to whole lines on both sides
+      const auto& edit = stats.edit;
+      size_t line_begin = edit.offset;
+      while (line_begin > 0 && !is_line_break(text_[line_begin - 1])) --line_begin;
+      const size_t old_end = line_end(text_, edit.offset + edit.removed);
+      const size_t new_end = line_end(text, edit.offset + edit.inserted);
+
+      const auto first = std::lower_bound(entries_.begin(), entries_.end(), line_begin,
+                                          [](const Entry& e, const size_t pos) { return e.segment.begin < pos; });
+      const auto last = std::lower_bound(first, entries_.end(), old_end,
+                                         [](const Entry& e, const size_t pos) { return e.segment.begin < pos; });
+      stats.first = static_cast<size_t>(first - entries_.begin());
+      stats.removed = static_cast<size_t>(last - first);
+
+      uint32_t line = 1;
+      if (first != entries_.begin()) {
+        const auto& prev = std::prev(first)->segment;
+        line = prev.line + count_newlines(std::string_view(text_).substr(prev.end, line_begin - prev.end));
+      } else {
+        line += count_newlines(std::string_view(text_).substr(0, line_begin));
+      }
+
+      std::vector<Segment> fresh;
+      segment_lines(text, line_begin, new_end, line, fresh);
+
+      const auto byte_delta = static_cast<std::ptrdiff_t>(edit.inserted) - static_cast<std::ptrdiff_t>(edit.removed);
+      const auto line_delta = static_cast<int64_t>(count_newlines(std::string_view(text).substr(line_begin, new_end - line_begin))) -
+                              static_cast<int64_t>(count_newlines(std::string_view(text_).substr(line_begin, old_end - line_begin)));
+
+      const std::string old_text = std::exchange(text_, std::move(text));
+      const size_t start = stats.first;
+
+      // Lines that only moved (e.g. a blank line inserted above them) keep
+      // their results; match unchanged lines from both ends of the region
+      std::vector<Entry> replacement;
+      replacement.reserve(fresh.size());
+      size_t front = 0;
+      while (front < std::min(stats.removed, fresh.size()) &&
+             old_slice(old_text, entries_[start + front].segment) == slice(fresh[front])) {
+        replacement.push_back(Entry{ fresh[front], std::move(entries_[start + front].result) });
+        ++front;
+      }
+      size_t back = 0;
+      while (back < std::min(stats.removed, fresh.size()) - front &&
+             old_slice(old_text, entries_[start + stats.removed - 1 - back].segment) == slice(fresh[fresh.size() - 1 - back])) {
+        ++back;
+      }
+      for (size_t i = front; i < fresh.size() - back; ++i) {
+        replacement.push_back(Entry{ fresh[i], compile_(slice(fresh[i])) });
+      }
+      for (size_t i = fresh.size() - back; i < fresh.size(); ++i) {
+        const size_t old_index = start + stats.removed - (fresh.size() - i);
+        replacement.push_back(Entry{ fresh[i], std::move(entries_[old_index].result) });
+      }
+      stats.compiled = fresh.size() - front - back;
+
+      // Replace in place where the counts overlap so a one-line edit moves nothing
+      const size_t overlap = std::min(stats.removed, fresh.size());
+      std::move(replacement.begin(), replacement.begin() + static_cast<std::ptrdiff_t>(overlap),
+                entries_.begin() + static_cast<std::ptrdiff_t>(start));
+      if (stats.removed > fresh.size()) {
+        entries_.erase(entries_.begin() + static_cast<std::ptrdiff_t>(start + overlap),
+                       entries_.begin() + static_cast<std::ptrdiff_t>(start + stats.removed));
+      } else if (fresh.size() > stats.removed) {
+        entries_.insert(entries_.begin() + static_cast<std::ptrdiff_t>(start + overlap),
+                        std::make_move_iterator(replacement.begin() + static_cast<std::ptrdiff_t>(overlap)),
+                        std::make_move_iterator(replacement.end()));
+      }
+
+      const size_t tail = start + fresh.size();
+      stats.reused = entries_.size() - stats.compiled;
+      if (byte_delta != 0 || line_delta != 0) {
+        for (size_t i = tail; i < entries_.size(); ++i) {
+          auto& segment = entries_[i].segment;
+          segment.begin = static_cast<size_t>(static_cast<std::ptrdiff_t>(segment.begin) + byte_delta);
+          segment.end = static_cast<size_t>(static_cast<std::ptrdiff_t>(segment.end) + byte_delta);
+          segment.line = static_cast<uint32_t>(static_cast<int64_t>(segment.line) + line_delta);
+        }
+      }
+      return stats;
+    }
+
+    [[nodiscard]] auto text() const -> const std::string& { return text_; }
+    [[nodiscard]] auto entries() const -> const std::vector<Entry>& { return entries_; }
+    [[nodiscard]] auto slice(const Segment& segment) const -> std::string_view {
+      return std::string_view(text_).substr(segment.begin, segment.end - segment.begin);
+    }
+
+  private:
+    static auto old_slice(const std::string_view text, const Segment& segment) -> std::string_view {
+      return text.substr(segment.begin, segment.end - segment.begin);
+    }
+
+    static auto line_end(const std::string_view text, size_t pos) -> size_t {
+      while (pos < text.size() && !is_line_break(text[pos])) ++pos;
+      return pos;
+    }
+  };
+
+}
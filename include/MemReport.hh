@@ -0,0 +1,81 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ErrorReporter.hh"
+
+namespace argc::mem {
+
+  // One slot per err::CompileStage, plus one for work on a file outside any stage
+  inline constexpr size_t stage_slots = static_cast<size_t>(err::CompileStage::Optimisation) + 2;
+
+  struct TrackedFile {
+    std::string path;
+    uint64_t input_bytes;
+  };
+
+  // Global operator new/delete are replaced by a hook that, until
+  // start_tracking(), tests one flag and calls malloc/free. Once tracking,
+  // every allocation is counted against the file and stage the calling
+  // thread has declared, and against its file as a whole. A small header on
+  // the block records both, so its free is charged back to them whichever
+  // thread or stage it happens in.
+  //
+  // A stage's live bytes are what it allocated and has not yet been freed,
+  // so its peak is the most it held at once, including memory a later
+  // stage still reads. Blocks from before tracking started are not counted.
+
+  // False where the allocator cannot report block sizes (glibc is required)
+  [[nodiscard]] auto tracking_available() -> bool;
+
+  // Call before the worker threads start; restarting discards earlier counts
+  auto start_tracking(std::vector<TrackedFile> files) -> void;
+
+  // Attributes the calling thread's allocations to one file until destroyed
+  class FileScope {
+  public:
+    explicit FileScope(size_t file);
+    ~FileScope();
+
+    FileScope(const FileScope&) = delete;
+    auto operator=(const FileScope&) -> FileScope& = delete;
+  };
+
+  // Attributes the calling thread's allocations to a stage of the current
+  // file, until the next stage or the end of the FileScope
+  auto enter_stage(err::CompileStage stage) -> void;
+
+  struct MemoryUsage {
+    uint64_t allocations { 0 };
+    uint64_t bytes { 0 };           // Total allocated
+    int64_t peak_live { 0 };        // Highest net live bytes
+  };
+
+  struct FileMemory {
+    std::string path;
+    uint64_t input_bytes { 0 };
+    std::array<MemoryUsage, stage_slots> stages {};
+    MemoryUsage total;
+  };
+
+  // Snapshot of the counters, for --mem-report
+  struct MemoryReport {
+    std::vector<FileMemory> files;
+    MemoryUsage driver;             // Allocations outside any file
+    int64_t peak_live { 0 };        // Process-wide, since tracking started
+    uint64_t peak_rss { 0 };        // Bytes; includes everything before tracking
+
+    [[nodiscard]] static auto collect() -> MemoryReport;
+
+    // Over all files: summed counts and the highest per-file peak
+    [[nodiscard]] auto stage_totals() const -> std::array<MemoryUsage, stage_slots>;
+
+    auto write_text(std::FILE* out) const -> void;
+    auto write_json(std::FILE* out) const -> void;
+  };
+
+}
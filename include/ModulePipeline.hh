@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "BuildScheduler.hh"
+#include "CEmitter.hh"
+#include "ConfigHandler.hh"
+#include "ErrorReporter.hh"
+#include "ExprIR.hh"
+#include "SymbolTable.hh"
+#include "TypeChecker.hh"
+#include "X86Emitter.hh"
+
+class ArgonParser;
+
+namespace argc {
+
+  class Frontend;
+
+  // One input held in memory. The path only names it in diagnostics.
+  struct SourceBuffer {
+    std::string path;
+    std::string_view text;
+  };
+
+  // Checks each input's module header and parenthesis nesting before adding
+  // it to the scheduler, then resolves the import graph. Stops at the first
+  // input that fails, with the reason reported.
+  auto discover_modules(err::ErrorReporter& reporter, build::BuildScheduler& scheduler,
+                        std::span<const SourceBuffer> sources) -> bool;
+
+  struct PipelineOptions {
+    ConfigHandler::OptimisationLevel optimisation { ConfigHandler::OptimisationLevel::ONE };
+    ConfigHandler::EmitKind emit { ConfigHandler::EmitKind::ASM };
+    bool lex_ahead { false };         // Lex the whole module before parsing, so lexing is a stage of its own
+  };
+
+  // What one module compiled to, without the emit kind's file header and footer
+  struct ModuleOutput {
+    std::string code;
+    codegen::EmitStats asm_stats;
+    codegen::CEmitStats c_stats;
+  };
+
+  // Where a driver hangs its reporting; any may be left empty. They run on
+  // the worker compiling the module.
+  struct PipelineHooks {
+    std::function<void(const build::ModuleUnit&, err::CompileStage)> stage;     // On entering each stage
+    std::function<void(ArgonParser&)> parsing;                                  // Before the parse
+    std::function<void(ArgonParser&)> parsed;                                   // After it, even if it failed
+    std::function<void(const build::ModuleUnit&, const SymbolTable&, bool collected)> collected;
+    std::function<void(const build::ModuleUnit&, const ir::Module&)> lowered;
+    std::function<void(const build::ModuleUnit&, const sema::TypeInfo&)> checked;
+  };
+
+  // Parsing, symbol collection, IR, type checking and code generation of the
+  // modules one scheduler discovered; the argc driver and CompilerInstance
+  // both compile through it. Each module's symbol table goes to its slot in
+  // tables, where the modules importing it find it. compile() may run on
+  // several scheduler workers at once, each on its own module and Frontend.
+  class ModulePipeline {
+    err::ErrorReporter& reporter_;
+    const build::BuildScheduler& scheduler_;
+    std::span<SymbolTable> tables_;
+    PipelineOptions options_;
+    PipelineHooks hooks_;
+    std::vector<ModuleOutput> outputs_;     // By module index
+
+  public:
+    ModulePipeline(err::ErrorReporter& reporter, const build::BuildScheduler& scheduler,
+                   std::span<SymbolTable> tables, PipelineOptions options, PipelineHooks hooks = {});
+
+    // Whether the module compiled, decided by its own diagnostics only: the
+    // reporter may be shared with workers compiling other modules
+    auto compile(Frontend& frontend, size_t index, std::string_view text) -> bool;
+
+    // Module indices, dependencies first, in the order the scheduler resolved them
+    [[nodiscard]] auto build_order() const -> std::vector<size_t>;
+
+    [[nodiscard]] auto output(const size_t index) -> ModuleOutput& { return outputs_[index]; }
+    [[nodiscard]] auto asm_totals() const -> codegen::EmitStats;
+    [[nodiscard]] auto c_totals() const -> codegen::CEmitStats;
+  };
+
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "BuildScheduler.hh"
+
+namespace argc::build {
+
+  // Token-level scan of a source file's header ('module' and 'import' lines),
+  // enough to build the import graph without parsing every statement.
+  // Returns nullopt if the file does not start with a module declaration.
+  auto scan_module_header(const std::string& path, std::string_view source) -> std::optional<ModuleUnit>;
+
+  // ANTLR's generated parser recurses a few frames per parenthesis, so
+  // nesting is capped before parsing rather than left to the stack. Parsing
+  // and lowering measured about 0.4 KiB of stack per level; at this cap the
+  // 2 MiB the pathological-input gate allows covers levels some 40 times
+  // that, leaving room for the real runtime's larger frames.
+  inline constexpr size_t max_paren_nesting = 128;
+
+  struct Nesting {
+    size_t depth { 0 };         // Most '(' open at once
+    uint32_t line { 0 };        // Where that depth was first reached
+    uint32_t column { 0 };
+  };
+
+  // Byte scan, no lexing. Never resets at a newline: error recovery can
+  // carry an unclosed expression into the next line.
+  [[nodiscard]] auto paren_nesting(std::string_view source) -> Nesting;
+
+}
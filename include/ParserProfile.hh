@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace antlr4 { class Parser; }
+
+namespace argc {
+
+  // Prediction statistics of one grammar decision, summed over every parse
+  // recorded. Lookahead is counted in tokens; time is spent inside
+  // adaptivePredict, in nanoseconds.
+  struct DecisionProfile {
+    size_t decision { 0 };
+    std::string rule;
+    uint64_t invocations { 0 };
+    uint64_t sll_lookahead { 0 };         // Total tokens examined by SLL prediction
+    uint64_t sll_max_lookahead { 0 };
+    uint64_t ll_fallbacks { 0 };          // Predictions SLL could not settle
+    uint64_t ll_lookahead { 0 };
+    uint64_t ll_max_lookahead { 0 };
+    uint64_t ambiguities { 0 };
+    uint64_t context_sensitivities { 0 };
+    uint64_t errors { 0 };
+    uint64_t atn_transitions { 0 };       // DFA cache misses, SLL and LL
+    uint64_t time_ns { 0 };
+
+    auto merge(const DecisionProfile& other) -> void;
+
+    [[nodiscard]] auto mean_lookahead() const -> double {
+      return invocations ? static_cast<double>(sll_lookahead + ll_lookahead) / static_cast<double>(invocations) : 0.0;
+    }
+  };
+
+  // Collects per-decision profiles from parsers run with setProfile(true)
+  // for --profile-parser. Parsers on different worker threads may record
+  // concurrently.
+  class ParserProfile {
+    mutable std::mutex mutex_;
+    std::vector<DecisionProfile> decisions_;        // Indexed by decision number
+    size_t parses_ { 0 };
+
+  public:
+    // Adds the decisions of a parser whose interpreter is ANTLR's profiling simulator
+    auto record(const antlr4::Parser& parser) -> void;
+
+    auto record(const std::vector<DecisionProfile>& decisions) -> void;
+
+    // Decisions that were predicted at least once, most expensive first
+    [[nodiscard]] auto ranked() const -> std::vector<DecisionProfile>;
+    [[nodiscard]] auto parses() const -> size_t;
+
+    auto write_text(std::FILE* out) const -> void;
+    auto write_json(std::FILE* out) const -> void;
+  };
+
+}
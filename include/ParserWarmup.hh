@@ -0,0 +1,25 @@
+#pragma once
+
+#include <thread>
+
+#include "TimeReport.hh"
+
+namespace argc {
+
+  // Builds ANTLR's shared lexer and parser tables (ATN deserialisation and
+  // the empty per-decision DFAs) on a background thread, so the work
+  // overlaps argument parsing and reading the inputs instead of sitting in
+  // front of the first parse. Anything constructing a lexer or parser
+  // before it is done simply waits on ANTLR's own once-flag.
+  class ParserWarmup {
+    std::jthread thread_;
+
+  public:
+    explicit ParserWarmup(TimeReport& report);
+
+    auto wait() -> void {
+      if (thread_.joinable()) thread_.join();
+    }
+  };
+
+}
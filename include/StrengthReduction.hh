@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Strength reduction of multiplication and signed division by constants.
+// Argon integers are 32-bit two's complement with wrapping arithmetic, and
+// division truncates toward zero. Plans describe the exact instruction
+// sequence the emitter produces, so evaluate() doubles as its reference model.
+
+namespace argc::codegen {
+
+  // One step applied to the accumulator. The accumulator starts as a copy of
+  // the multiplicand (src), which stays live in a second register.
+  struct MulStep {
+    enum class Op : uint8_t {
+      Zero,       // acc = 0                     xor  eax, eax
+      Shl,        // acc <<= amount              shl  eax, amount
+      LeaSelf,    // acc *= amount (3, 5, 9)     lea  eax, [rax+rax*(amount-1)]
+      LeaSrc,     // acc = src + acc * amount    lea  eax, [rcx+rax*amount]
+      LeaAddSrc,  // acc = acc + src * amount    lea  eax, [rax+rcx*amount]
+      AddSrc,     // acc += src                  add  eax, ecx
+      SubSrc,     // acc -= src                  sub  eax, ecx
+      Neg         // acc = -acc                  neg  eax
+    };
+
+    Op op;
+    uint8_t amount { 0 };
+  };
+
+  struct MulRecipe {
+    int32_t multiplier { 1 };
+    bool use_imul { false };      // No sequence within budget; emit imul
+    bool needs_src { false };     // Some step reads the original multiplicand
+    std::vector<MulStep> steps;
+  };
+
+  struct DivisionPlan {
+    enum class Kind : uint8_t {
+      Hardware,     // idiv (division by zero keeps its runtime trap)
+      Identity,     // d == 1
+      Negate,       // d == -1, wraps for INT32_MIN like the other paths
+      PowerOfTwo,   // |d| == 2^shift: bias negative dividends, then sar
+      Magic         // multiply-high by magic number, correct, shift, round toward zero
+    };
+
+    Kind kind { Kind::Hardware };
+    int32_t divisor { 0 };
+    int32_t multiplier { 0 };
+    uint8_t shift { 0 };
+    bool add_dividend { false };  // d > 0 and multiplier < 0
+    bool sub_dividend { false };  // d < 0 and multiplier > 0
+    bool negate { false };        // PowerOfTwo with negative divisor
+    bool nonnegative_dividend { false };  // Proven by the type checker; drops the rounding fixups
+  };
+
+  struct SignedMagic {
+    int32_t multiplier;
+    uint8_t shift;
+  };
+
+  // Hacker's Delight, 10-1. Requires d not in {-1, 0, 1}.
+  auto signed_magic(int32_t d) -> SignedMagic;
+
+  // Shortest shift/lea/add sequence computing x * c within max_steps
+  // single-cycle operations, or an imul recipe if there is none.
+  auto plan_multiplication(int32_t c, size_t max_steps = 2) -> MulRecipe;
+
+  auto plan_signed_division(int32_t d, bool nonnegative_dividend = false) -> DivisionPlan;
+
+  auto evaluate(const MulRecipe& recipe, int32_t x) -> int32_t;
+  auto evaluate(const DivisionPlan& plan, int32_t n) -> int32_t;
+
+}
@@ -1,30 +1,48 @@
 #pragma once
 
+#include <functional>
+
 #include "ArgonBaseVisitor.h"
 #include "SymbolTable.hh"
 #include "ErrorReporter.hh"
 
 namespace argc {
 class SymbolCollector : public ArgonBaseVisitor {
+public:
+  // Maps an imported module name onto the symbol table it was collected into
+  using ImportResolver = std::function<const SymbolTable*(const std::string&)>;
+
+private:
   SymbolTable symbol_table_;
   err::ErrorReporter& error_reporter_;
+  ImportResolver import_resolver_;
+  std::string source_file_;
+  err::Status status_;        // First failure of the current traversal, if any
 
 public:
 
-  explicit SymbolCollector(err::ErrorReporter& reporter)
-    : error_reporter_(reporter) {}
+  explicit SymbolCollector(err::ErrorReporter& reporter, ImportResolver resolver = {}, std::string source_file = "")
+    : error_reporter_(reporter), import_resolver_(std::move(resolver)), source_file_(std::move(source_file)) {}
+
+  // Collects into a table the caller recycles, typically one reset() after
+  // an earlier module so its arena is reused; take it back with getSymbolTable()
+  SymbolCollector(err::ErrorReporter& reporter, SymbolTable table, ImportResolver resolver = {}, std::string source_file = "")
+    : symbol_table_(std::move(table)), error_reporter_(reporter), import_resolver_(std::move(resolver)),
+      source_file_(std::move(source_file)) {}
+
+  // Collects the module's symbols, stopping at the first diagnostic that
+  // fails the stage
+  auto collect(ArgonParser::ModuleDeclarationContext *ctx) -> err::Status;
 
   std::any visitModuleDeclaration(ArgonParser::ModuleDeclarationContext *ctx) override;
+  std::any visitImportDeclaration(ArgonParser::ImportDeclarationContext *ctx) override;
 
   std::any visitExpressionStmt(ArgonParser::ExpressionStmtContext *ctx) override;
   std::any visitReturnStmt(ArgonParser::ReturnStmtContext *ctx) override;
 
-  std::any visitAddSubExpr(ArgonParser::AddSubExprContext *ctx) override;
-  std::any visitMulDivExpr(ArgonParser::MulDivExprContext *ctx) override;
-  std::any visitAtomExpr(ArgonParser::AtomExprContext *ctx) override;
-
+  // Statements walk their expression with walk_expression, which reaches
+  // every atom without recursing once per operator or parenthesis
   std::any visitIntAtom(ArgonParser::IntAtomContext *ctx) override;
-  std::any visitParenExpr(ArgonParser::ParenExprContext *ctx) override;
 
   std::any visitIdentifier(ArgonParser::AtomContext *ctx);
 
@@ -33,7 +51,7 @@ public:
   }
 
 private:
+  auto collect_expression(ArgonParser::ExpressionContext *expr) -> void;
   auto extract_source_location(antlr4::ParserRuleContext* ctx) -> loc::SourceLocation;
-  auto create_primitive_type(const std::string& type_name) -> std::shared_ptr<Type>;
 };
 }
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 #include <ostream>
 
+#include "Arena.hh"
 #include "SourceLocation.hh"
 
 namespace argc {
@@ -13,6 +20,9 @@ namespace argc {
 
   enum class TypeKind { MODULE, PRIMITIVE, STRUCT, ARRAY, FUNCTION };
 
+  // Symbols, scopes and types are owned by the SymbolTable's arena and
+  // referenced through plain pointers; they live until the table is released.
+
   class Type {
   protected:
     TypeKind kind_ { TypeKind::PRIMITIVE };
@@ -41,47 +51,79 @@ namespace argc {
 
   class ArrayType final : public Type {
     int size_ = 0;
-    std::shared_ptr<Type> element_type_;
+    const Type* element_type_;
   public:
-    ArrayType(std::shared_ptr<Type> element_type, const int size) {
+    ArrayType(const Type* element_type, const int size) {
       kind_ = TypeKind::ARRAY;
-      element_type_ = std::move(element_type);
+      element_type_ = element_type;
       size_ = size;
       name_ = "array<" + element_type_->name() + ">";
     }
+
+    // The stride is target-dependent; see layout::LayoutEngine
+    [[nodiscard]] auto element_type () const -> const Type* { return element_type_; }
+    [[nodiscard]] auto size () const -> int { return size_; }
+  };
+
+  // How a struct's fields may be placed in memory
+  enum class LayoutPolicy : uint8_t {
+    Declared,     // Declaration order, as C lays it out
+    Reorder       // Opted in: the layout engine may reorder fields from -O2
+  };
+
+  struct StructField {
+    std::string name;
+    const Type* type;
+    bool hot;                   // Accessed together often; kept in the first cache line when reordering
   };
 
+  // Fields are kept in declaration order. Lookup by name goes through a flat
+  // open-addressed index of field positions rather than a node-based map.
   class StructType final : public Type {
-    std::unordered_map<std::string, std::shared_ptr<Type> > fields_;
+    static constexpr uint32_t empty_slot = UINT32_MAX;
+
+    std::vector<StructField> fields_;
+    std::vector<uint32_t> index_;         // Power-of-two sized, load at most one half
+    LayoutPolicy policy_ { LayoutPolicy::Declared };
   public:
     explicit StructType(std::string type_name) {
       name_ = std::move(type_name);
       kind_ = TypeKind::STRUCT;
     }
-    auto add_field(const std::string& name, std::shared_ptr<Type> type) -> void;
-    auto get_field(const std::string& name) const -> std::shared_ptr<Type>;
+
+    // False if a field of that name already exists
+    auto add_field(const std::string& name, const Type* type, bool hot = false) -> bool;
+    auto get_field(std::string_view name) const -> const Type*;
+    auto field_index(std::string_view name) const -> std::optional<size_t>;
+
+    [[nodiscard]] auto fields () const -> const std::vector<StructField>& { return fields_; }
+    [[nodiscard]] auto layout_policy () const -> LayoutPolicy { return policy_; }
+    auto set_layout_policy (const LayoutPolicy policy) -> void { policy_ = policy; }
+
+  private:
+    auto rehash() -> void;
   };
 
   class FunctionType final : public Type {
-    std::vector<std::shared_ptr<Type>> parameter_types_;
-    std::shared_ptr<Type> return_type_;
+    std::vector<const Type*> parameter_types_;
+    const Type* return_type_;
   public:
-    FunctionType (std::vector<std::shared_ptr<Type>> params, std::shared_ptr<Type> ret ) {
+    FunctionType (std::vector<const Type*> params, const Type* ret ) {
       kind_ = TypeKind::FUNCTION;
       parameter_types_ = std::move(params);
-      return_type_ = std::move(ret);
+      return_type_ = ret;
       name_ = "func";
     }
   };
 
   class TypeTable {
-    std::unordered_map<std::string, std::shared_ptr<Type>> types_;
+    std::unordered_map<std::string, const Type*> types_;
   public:
-    auto insert (std::shared_ptr<Type> t) -> void {
+    auto insert (const Type* t) -> void {
       types_[t->name()] = t;
     }
 
-    auto lookup (const std::string& name) const -> std::shared_ptr<Type> {
+    auto lookup (const std::string& name) const -> const Type* {
       const auto it = types_.find(name);
       return it != types_.end() ? it->second : nullptr;
     }
@@ -89,128 +131,244 @@ namespace argc {
   };
 
   class SymbolEntry {
-    std::string name_;
+    std::string_view name_;
     SymbolKind kind_;
-    std::shared_ptr<Type> type_;
+    const Type* type_;
     int scope_level_;
     bool is_defined_;
+    bool is_imported_ { false };
     loc::SourceLocation location_;
   public:
     SymbolEntry (
-      const std::string &name,
+      const std::string_view name,
       const SymbolKind kind,
-      std::shared_ptr<Type> type,
+      const Type* type,
       const int scope_level,
       const loc::SourceLocation &location
       )
       :
     name_(name),
     kind_(kind),
-    type_(std::move(type)),
+    type_(type),
     scope_level_(scope_level),
     is_defined_(false),
     location_(location)
     {
     }
 
-    auto name () -> std::string { return name_; }
+    auto name () const -> std::string_view { return name_; }
     auto scope_level () const -> int { return scope_level_; }
     auto set_scope_level (const int level) -> void { scope_level_ = level; }
     auto kind () const -> SymbolKind { return kind_; }
-    auto type () const -> std::shared_ptr<Type> { return type_; }
-    auto location () const -> loc::SourceLocation { return location_; }
+    auto type () const -> const Type* { return type_; }
+    auto location () const -> const loc::SourceLocation& { return location_; }
     auto is_defined () const -> bool { return is_defined_; }
     auto set_defined (const bool val) -> void { is_defined_ = val; }
+    auto is_imported () const -> bool { return is_imported_; }
+    auto set_imported (const bool val) -> void { is_imported_ = val; }
 
   };
 
   class Scope {
     int level_;
-    std::string name_;
-    std::shared_ptr<Scope> parent_;
-    std::unordered_map<std::string, std::shared_ptr<SymbolEntry>> symbols_;
+    std::string_view name_;
+    Scope* parent_;
+    std::pmr::unordered_map<std::string_view, SymbolEntry*> symbols_;
   public:
 
-    Scope(const int lvl, const std::string& scope_name, const std::shared_ptr<Scope> &parent_scope = nullptr)
-        : level_(lvl), name_(scope_name), parent_(parent_scope) {}
+    Scope(const int lvl, const std::string_view scope_name, Scope* parent_scope, std::pmr::memory_resource* memory)
+        : level_(lvl), name_(scope_name), parent_(parent_scope), symbols_(memory) {}
 
-    auto insert(const std::shared_ptr<SymbolEntry> &entry) -> bool {
-      if (symbols_.contains(entry->name())) return false; // already declared in this scope
-      symbols_[entry->name()] = entry;
-      return true;
+    auto insert(SymbolEntry* entry) -> bool {
+      return symbols_.emplace(entry->name(), entry).second; // false if already declared in this scope
+    }
+
+    auto erase(const std::string_view name) -> bool {
+      return symbols_.erase(name) > 0;
     }
 
-    auto lookup(const std::string& name) const -> std::shared_ptr<SymbolEntry> {
-      auto it = symbols_.find(name);
-      if (it != symbols_.end()) return it->second;
-      return parent_ ? parent_->lookup(name) : nullptr;
+    auto lookup(const std::string_view name) const -> SymbolEntry* {
+      for (const Scope* scope = this; scope; scope = scope->parent_) {
+        if (const auto it = scope->symbols_.find(name); it != scope->symbols_.end()) return it->second;
+      }
+      return nullptr;
     }
 
-    auto lookup_current(const std::string& name) const -> std::shared_ptr<SymbolEntry> {
+    auto lookup_current(const std::string_view name) const -> SymbolEntry* {
       const auto it = symbols_.find(name);
       return it != symbols_.end() ? it->second : nullptr;
     }
 
     auto level () const -> int { return level_; }
-    auto name () -> std::string { return name_; }
-    auto parent () -> std::shared_ptr<Scope> { return parent_; }
-    auto symbols() const -> const std::unordered_map<std::string, std::shared_ptr<SymbolEntry>>& { return symbols_; }
+    auto name () const -> std::string_view { return name_; }
+    auto parent () const -> Scope* { return parent_; }
+    auto symbols() const -> const std::pmr::unordered_map<std::string_view, SymbolEntry*>& { return symbols_; }
     auto full_scope_name() const -> std::string {
-      if (!parent_) return name_;
-      return parent_->full_scope_name() + "::" + name_;
+      if (!parent_) return std::string(name_);
+      return parent_->full_scope_name() + "::" + std::string(name_);
     }
 
   };
 
   class SymbolTable {
-    std::shared_ptr<Scope> current_scope_;
+    std::unique_ptr<mem::Arena> arena_;              // Heap-held so scopes keep a stable memory resource across moves
+    Scope* current_scope_ { nullptr };               // Null until the global scope is first needed
+    std::vector<Scope*> scopes_;                     // Every scope ever entered, for imports
+    std::unordered_map<std::string, const Scope*> imported_scopes_;
     int current_level_ { 0 };
     int anonymous_scope_counter_ { 0 };
 
   public:
-    SymbolTable() {
-      current_scope_ = std::make_shared<Scope>(0, "global");
+    // The arena and the global scope are created on first use, so
+    // placeholder tables, and the empty ones assigned to release a table's
+    // memory, allocate nothing
+    SymbolTable() = default;
+
+    SymbolTable(SymbolTable&& other) noexcept { *this = std::move(other); }
+
+    // Leaves 'other' empty rather than pointing into the arena it gave away
+    auto operator=(SymbolTable&& other) noexcept -> SymbolTable& {
+      if (this != &other) {
+        arena_ = std::move(other.arena_);
+        current_scope_ = std::exchange(other.current_scope_, nullptr);
+        scopes_ = std::move(other.scopes_);
+        other.scopes_.clear();
+        imported_scopes_ = std::move(other.imported_scopes_);
+        other.imported_scopes_.clear();
+        current_level_ = std::exchange(other.current_level_, 0);
+        anonymous_scope_counter_ = std::exchange(other.anonymous_scope_counter_, 0);
+      }
+      return *this;
+    }
+
+    // Empty again, keeping the arena's memory for the next module. Every
+    // symbol, scope and type handed out is destroyed.
+    auto reset() -> void {
+      scopes_.clear();
+      imported_scopes_.clear();
+      current_scope_ = nullptr;
+      current_level_ = 0;
+      anonymous_scope_counter_ = 0;
+      if (arena_) arena_->reset();
+    }
+
+    template<typename T, typename... Args>
+    auto make_type(Args&&... args) -> T* {
+      return arena().create<T>(std::forward<Args>(args)...);
+    }
+
+    auto make_symbol(const std::string_view name, const SymbolKind kind, const Type* type,
+                     const loc::SourceLocation& location) -> SymbolEntry* {
+      return arena().create<SymbolEntry>(arena_->intern(name), kind, type, current_level_, location);
     }
 
     auto enter_scope(const std::string& name = "") -> void {
-      std::string scope_name = name.empty()
+      const std::string scope_name = name.empty()
           ? "block_" + std::to_string(anonymous_scope_counter_++)
           : name;
+      auto* parent = scope();
       current_level_++;
-      current_scope_ = std::make_shared<Scope>(current_level_, scope_name, current_scope_);
+      current_scope_ = arena_->create<Scope>(current_level_, arena_->intern(scope_name), parent, arena_.get());
+      scopes_.push_back(current_scope_);
     }
 
     auto exit_scope() -> void {
-      if (current_scope_->parent()) {
+      if (current_scope_ && current_scope_->parent()) {
         current_scope_ = current_scope_->parent();
         current_level_--;
       }
     }
 
-    auto insert(const std::shared_ptr<SymbolEntry> &entry) const -> bool {
+    auto insert(SymbolEntry* entry) -> bool {
       entry->set_scope_level(current_level_);
-      return current_scope_->insert(entry);
+      return scope()->insert(entry);
+    }
+
+    auto lookup(const std::string_view name) const -> SymbolEntry* {
+      return current_scope_ ? current_scope_->lookup(name) : nullptr;
+    }
+
+    auto lookup_current(const std::string_view name) const -> SymbolEntry* {
+      return current_scope_ ? current_scope_->lookup_current(name) : nullptr;
+    }
+
+    auto current_scope_name() const -> std::string_view {
+      return current_scope_ ? current_scope_->name() : "global";
+    }
+
+    // Module-level scope (level 1) declared under the given name, if any
+    auto module_scope(const std::string_view module_name) const -> const Scope* {
+      for (const auto* scope : scopes_) {
+        if (scope->level() == 1 && scope->name() == module_name) return scope;
+      }
+      return nullptr;
+    }
+
+    // Make a module collected into another table visible in the current scope.
+    // The module symbol is re-declared locally and its module scope becomes
+    // reachable through lookup_qualified(). The source table must outlive this one's use of it.
+    auto import_module(const std::string& module_name, const SymbolTable& source) -> bool {
+      if (source.scopes_.empty()) return false;
+      const auto* exported = source.scopes_.front()->lookup_current(module_name);
+      if (!exported || exported->kind() != SymbolKind::MODULE) return false;
+
+      auto* entry = make_symbol(module_name, SymbolKind::MODULE, exported->type(), exported->location());
+      entry->set_defined(true);
+      entry->set_imported(true);
+      if (!insert(entry)) return false;
+
+      imported_scopes_[module_name] = source.module_scope(module_name);
+      return true;
     }
 
-    auto lookup(const std::string& name) const -> std::shared_ptr<SymbolEntry> {
-      return current_scope_->lookup(name);
+    // Undo import_module(); the symbol stays in the arena but is no longer visible
+    auto remove_import(const std::string& module_name) -> bool {
+      const auto it = imported_scopes_.find(module_name);
+      if (it == imported_scopes_.end()) return false;
+      imported_scopes_.erase(it);
+
+      const auto* entry = lookup_current(module_name);
+      return entry && entry->is_imported() && current_scope_->erase(module_name);
     }
 
-    auto lookup_current(const std::string& name) const -> std::shared_ptr<SymbolEntry> {
-      return current_scope_->lookup_current(name);
+    auto lookup_qualified(const std::string& module_name, const std::string_view name) const -> SymbolEntry* {
+      const auto it = imported_scopes_.find(module_name);
+      if (it == imported_scopes_.end() || !it->second) return nullptr;
+      return it->second->lookup_current(name);
     }
 
-    auto current_scope_name() const -> std::string {
-      return current_scope_->name();
+    auto imported_modules() const -> std::vector<std::string> {
+      std::vector<std::string> names;
+      names.reserve(imported_scopes_.size());
+      for (const auto& [name, _] : imported_scopes_) names.push_back(name);
+      return names;
     }
 
     auto dump_current_scope(std::ostream& os) const -> void {
-      os << "Scope: " << current_scope_->name() << "\n";
+      os << "Scope: " << current_scope_name() << "\n";
+      if (!current_scope_) return;
       for (const auto& [k, v] : current_scope_->symbols()) {
         os << "  " << k << " : " << std::to_string(static_cast<int>(v->kind())) << "\n";
       }
     }
 
+    [[nodiscard]] auto memory_stats() const -> mem::ArenaStats { return arena_ ? arena_->stats() : mem::ArenaStats{}; }
+
+  private:
+    auto arena() -> mem::Arena& {
+      if (!arena_) arena_ = std::make_unique<mem::Arena>();
+      return *arena_;
+    }
+
+    // The current scope, entering the global one if nothing has been yet
+    auto scope() -> Scope* {
+      if (!current_scope_) {
+        current_scope_ = arena().create<Scope>(0, "global", nullptr, arena_.get());
+        scopes_.push_back(current_scope_);
+      }
+      return current_scope_;
+    }
+
   };
 
 
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string_view>
+#include <vector>
+
+namespace argc {
+
+  // Wall-clock checkpoints for --time-report. Times are measured from the
+  // static initialisation of the executable, the closest portable stand-in
+  // for exec; the dynamic loader's share before that is not included.
+  class TimeReport {
+    using Clock = std::chrono::steady_clock;
+
+    struct Mark {
+      std::string_view label;
+      Clock::duration at;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<Mark> marks_;
+    bool enabled_ { false };
+
+  public:
+    TimeReport() { mark("main entered"); }
+
+    // Prints on destruction once enabled, so every exit path of main() reports
+    ~TimeReport();
+
+    TimeReport(const TimeReport&) = delete;
+    auto operator=(const TimeReport&) -> TimeReport& = delete;
+
+    auto enable() -> void { enabled_ = true; }
+
+    // Later marks with a label already recorded are ignored, so a stage
+    // running once per module records its first completion
+    auto mark(std::string_view label) -> void;
+
+    auto print(std::FILE* out) const -> void;
+
+    static auto since_start() -> Clock::duration;
+  };
+
+}
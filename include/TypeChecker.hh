@@ -0,0 +1,75 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ErrorReporter.hh"
+#include "ExprIR.hh"
+
+namespace argc::sema {
+
+  // Argon integers are 32-bit and wrap; narrower types are an inference
+  // result, never something a program declares
+  enum class IntType : uint8_t { I8, I16, I32 };
+
+  inline constexpr std::array<std::string_view, 3> int_type_names { "i8", "i16", "i32" };
+
+  [[nodiscard]] constexpr auto type_name(const IntType type) -> std::string_view {
+    return int_type_names[static_cast<size_t>(type)];
+  }
+
+  // Inclusive bounds on the values a node can take at run time
+  struct ValueRange {
+    int64_t lo;
+    int64_t hi;
+
+    [[nodiscard]] auto is_constant() const -> bool { return lo == hi; }
+    [[nodiscard]] auto is_nonnegative() const -> bool { return lo >= 0; }
+  };
+
+  // Narrowest type holding every value of the range
+  [[nodiscard]] auto narrowest_type(ValueRange range) -> IntType;
+
+  struct TypeStats {
+    size_t nodes { 0 };
+    std::array<size_t, 3> by_type {};     // Indexed by IntType
+    size_t overflows { 0 };
+  };
+
+  // Per-node results, indexed by ir::NodeId
+  struct TypeInfo {
+    std::vector<IntType> types;
+    std::vector<ValueRange> ranges;
+    std::vector<bool> wrapping;           // Exact result left i32; the node wraps
+    TypeStats stats;
+
+    [[nodiscard]] auto type(const ir::NodeId id) const -> IntType { return types[id]; }
+    [[nodiscard]] auto range(const ir::NodeId id) const -> const ValueRange& { return ranges[id]; }
+    [[nodiscard]] auto wraps(const ir::NodeId id) const -> bool { return wrapping[id]; }
+  };
+
+  // Assigns every expression node an integer type and a value range in one
+  // pass over the flat IR. Ranges follow the run-time semantics (32-bit,
+  // wrapping, truncating division), so a width inferred here is sound for
+  // the backends to rely on. Operations whose exact result does not fit i32
+  // are reported as IntegerOverflow warnings since they wrap; constant division
+  // by zero is an error.
+  class TypeChecker {
+    err::ErrorReporter& error_reporter_;
+    std::string source_file_;
+
+  public:
+    explicit TypeChecker(err::ErrorReporter& reporter, std::string source_file = "")
+      : error_reporter_(reporter), source_file_(std::move(source_file)) {}
+
+    // Stops at the first statement whose diagnostic fails the stage
+    auto check(const ir::Module& module) -> err::Expected<TypeInfo>;
+
+  private:
+    auto check_statement(const ir::ExprPool& exprs, const ir::Statement& stmt, TypeInfo& info) -> err::Status;
+  };
+
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "ConfigHandler.hh"
+#include "SymbolTable.hh"
+
+namespace argc::layout {
+
+  // Data model of a target: what the layout of every type derives from
+  struct TargetLayout {
+    uint32_t pointer_size;
+    uint32_t i64_align;       // Alignment of 8-byte integers and floats
+    uint32_t cache_line;
+
+    // x86_64 is LP64 with 64-byte lines; arm is 32-bit AAPCS (8-byte
+    // aligned i64, 4-byte pointers) with 32-byte lines
+    [[nodiscard]] static auto for_arch(ConfigHandler::TargetArch arch) -> TargetLayout;
+  };
+
+  struct FieldLayout {
+    uint32_t field;           // Index into StructType::fields(), i.e. declaration order
+    uint64_t offset;
+    uint64_t size;
+  };
+
+  struct Layout {
+    uint64_t size { 0 };      // A multiple of align, so an array of the type needs no extra padding
+    uint32_t align { 1 };
+    uint64_t padding { 0 };   // Bytes of size no field or element occupies
+    uint64_t stride { 0 };    // Arrays only: distance between consecutive elements
+    std::vector<FieldLayout> fields;      // Structs only, in memory order
+    bool reordered { false };
+
+    // Offset of a field by its declaration index
+    [[nodiscard]] auto offset_of(const size_t field) const -> std::optional<uint64_t> {
+      for (const auto& f : fields) {
+        if (f.field == field) return f.offset;
+      }
+      return std::nullopt;
+    }
+  };
+
+  struct LayoutStats {
+    size_t structs { 0 };
+    size_t structs_reordered { 0 };
+    uint64_t padding_saved { 0 };       // Bytes reordering removed, over all reordered structs
+  };
+
+  // Computes size, alignment, field offsets and array strides for one
+  // target, the way C does on that target. Structs that opt in with
+  // LayoutPolicy::Reorder are reordered when reordering is enabled (-O2
+  // and above): hot fields first so they share the first cache line, then
+  // the rest placed to leave as little padding as possible. Layouts are
+  // cached per type.
+  class LayoutEngine {
+    TargetLayout target_;
+    bool reorder_fields_;
+    std::unordered_map<const Type*, std::optional<Layout>> cache_;    // nullopt while in progress
+    LayoutStats stats_;
+
+  public:
+    explicit LayoutEngine(const TargetLayout& target, const bool reorder_fields = false)
+      : target_(target), reorder_fields_(reorder_fields) {}
+
+    // Target and reordering as selected on the command line
+    [[nodiscard]] static auto for_config(const ConfigHandler& config) -> LayoutEngine;
+
+    // Null for types without a size: modules, unknown primitives, negative
+    // array lengths and structs that contain themselves by value
+    auto layout(const Type& type) -> const Layout*;
+
+    [[nodiscard]] auto target() const -> const TargetLayout& { return target_; }
+    [[nodiscard]] auto stats() const -> const LayoutStats& { return stats_; }
+
+  private:
+    auto compute(const Type& type) -> std::optional<Layout>;
+    auto primitive(const Type& type) const -> std::optional<Layout>;
+    auto structure(const StructType& type) -> std::optional<Layout>;
+  };
+
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ConfigHandler.hh"
+#include "ErrorReporter.hh"
+#include "IncrementalUnit.hh"
+#include "SymbolTable.hh"
+
+namespace argc {
+
+  // What one line of a module compiles to in watch mode. Diagnostics are
+  // positioned relative to the line (line 1, no file) so the result stays
+  // valid when edits above it move the line around.
+  struct LineResult {
+    enum class Kind : uint8_t { Header, Import, Statement };
+
+    Kind kind { Kind::Statement };
+    std::string name;                                     // Declared or imported module
+    std::vector<err::ErrorReporter::Error> diagnostics;
+  };
+
+  class LineCompiler;
+
+  // --watch: compiles every input line by line, then waits for saves and
+  // recompiles only the lines an edit touched. Module structure and imports
+  // are re-derived from the cached line results; symbol tables are only
+  // touched when a header or an import changes. The import graph goes
+  // through the same checks as a full build, so watch mode never accepts
+  // a program the build would refuse.
+  class WatchSession {
+    struct ImportLine {
+      std::string name;
+      uint32_t line;
+      uint32_t column;
+    };
+
+    struct WatchedFile {
+      std::string path;
+      incr::IncrementalUnit<LineResult> unit;
+      std::string module_name;
+      std::vector<ImportLine> imports;
+      std::vector<std::string> bound_imports;             // Successfully imported into 'symbols'
+      std::vector<err::ErrorReporter::Error> structure_diagnostics;
+      std::vector<err::ErrorReporter::Error> graph_diagnostics;   // From the build scheduler's checks
+      SymbolTable symbols;
+    };
+
+    const ConfigHandler& config_;
+    err::ErrorReporter& reporter_;
+    std::unique_ptr<LineCompiler> compiler_;
+    std::vector<std::unique_ptr<WatchedFile>> files_;
+
+  public:
+    WatchSession(const ConfigHandler& config, err::ErrorReporter& reporter);
+    ~WatchSession();
+
+    WatchSession(const WatchSession&) = delete;
+    auto operator=(const WatchSession&) -> WatchSession& = delete;
+
+    // Full compile of every input, then the watch loop; only returns on error
+    auto run() -> int;
+
+    // What a save does in the watch loop, without the file system or the
+    // printing: recompiles the file against its previous text, or adds it
+    auto update(const std::string& path, std::string text) -> incr::UpdateStats;
+
+    // Everything emit() would print for the file, sorted by line
+    [[nodiscard]] auto diagnostics(const std::string& path) const -> std::vector<err::ErrorReporter::Error>;
+
+  private:
+    auto load(const std::string& path) -> bool;
+    auto add(const std::string& path, std::string text) -> WatchedFile&;
+    auto recheck(WatchedFile& file, std::string text) -> incr::UpdateStats;
+    auto scan_structure(WatchedFile& file) -> void;
+    auto rebuild_symbols() -> void;
+    auto sync_imports(WatchedFile& file) -> void;
+    auto check_graph() -> std::vector<const WatchedFile*>;
+    auto emit(const WatchedFile& file, const incr::UpdateStats* stats, double elapsed_ms) -> void;
+  };
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "ExprIR.hh"
+#include "StrengthReduction.hh"
+#include "TypeChecker.hh"
+
+namespace argc::codegen {
+
+  struct EmitStats {
+    size_t instructions { 0 };
+    size_t multiplies_reduced { 0 };
+    size_t divisions_reduced { 0 };
+    size_t shared_values { 0 };           // Common subexpressions computed once and reused
+    size_t register_values { 0 };         // Values held in a register until their last use
+    size_t spills { 0 };                  // Values held in memory instead: pushed, or in a frame slot
+    size_t callee_saved { 0 };            // Callee-saved registers the allocator had to preserve
+  };
+
+  // Where values wait between being computed and being used
+  enum class Allocation : uint8_t {
+    Stack,          // Pushed on the machine stack, evaluated left to right
+    Registers,      // Sethi-Ullman evaluation order, linear-scan register allocation
+  };
+
+  // Instruction selection for x86-64, GNU assembler Intel syntax. Each module
+  // becomes one function returning its 'ret' value in eax. Every operation
+  // leaves its result in eax; immediates are folded into the instruction
+  // consuming them so constant operands can be reduced.
+  //
+  // With Allocation::Stack a value that cannot stay in eax until it is used
+  // is pushed, and common subexpressions of a sharing pool are kept in
+  // rbp-based frame slots. With Allocation::Registers each statement's
+  // operands are evaluated needier first (Sethi-Ullman numbering), which
+  // keeps the fewest values waiting, and the waiting values of the whole
+  // statement sequence, shared ones included, get registers from a linear
+  // scan over their live ranges. A value that does not fit is spilled to a
+  // frame slot for its whole range. eax, ecx and edx stay free for the
+  // operation sequences.
+  //
+  // With type information, divisions by a constant whose dividend is proven
+  // non-negative drop the rounding fixups.
+  class X86Emitter {
+  public:
+    // esi, edi, r8d-r11d, then the callee-saved ebx and r12d-r15d
+    static constexpr size_t allocatable_registers = 11;
+
+  private:
+    bool strength_reduction_;
+    Allocation allocation_;
+    size_t register_limit_;
+    const sema::TypeInfo* types_ { nullptr };
+    std::vector<uint32_t> slots_;         // Frame slot per node (Stack: shared nodes only)
+    std::vector<uint8_t> registers_;      // Register per node, for Registers
+    std::string out_;
+    EmitStats stats_;
+
+  public:
+    // register_limit caps the registers the allocator may use, down to none
+    explicit X86Emitter(const bool strength_reduction = true,
+                        const Allocation allocation = Allocation::Registers,
+                        const size_t register_limit = allocatable_registers)
+      : strength_reduction_(strength_reduction), allocation_(allocation),
+        register_limit_(std::min(register_limit, allocatable_registers)) {}
+
+    static auto file_header() -> std::string;
+    static auto file_footer() -> std::string;
+
+    auto emit_module(const ir::Module& module, const sema::TypeInfo* types = nullptr) -> std::string;
+
+    // Sequences computing eax = eax op constant; they clobber ecx and edx
+    auto emit_multiply(const MulRecipe& recipe) -> void;
+    auto emit_divide(const DivisionPlan& plan) -> void;
+
+    auto take() -> std::string { return std::exchange(out_, {}); }
+    [[nodiscard]] auto stats() const -> const EmitStats& { return stats_; }
+
+  private:
+    struct Schedule;
+
+    struct Frame {
+      uint32_t slots { 0 };               // 4-byte rbp-based slots
+      uint32_t saved_registers { 0 };     // Bit per allocatable register pushed on entry
+    };
+
+    auto emit_statement(const ir::ExprPool& exprs, const ir::Statement& stmt) -> void;
+    auto schedule(const ir::Module& module) const -> Schedule;
+    auto allocate(const ir::Module& module, const Schedule& order) -> Frame;
+    auto emit_scheduled(const ir::ExprPool& exprs, const Schedule& order, size_t position, ir::NodeId& in_eax) -> void;
+    auto load_result(const ir::ExprPool& exprs, ir::NodeId root, ir::NodeId in_eax) -> void;
+    auto emit_op_reg(ir::Op op, std::string_view source = "ecx") -> void;
+    auto emit_op_imm(ir::Op op, int32_t imm, bool lhs_nonnegative = false) -> void;
+    auto emit_op_imm_lhs(ir::Op op, int32_t imm) -> void;
+    auto inst(std::string_view text) -> void;
+  };
+
+}
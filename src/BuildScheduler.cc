@@ -0,0 +1,294 @@
+#include "BuildScheduler.hh"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <fmt/core.h>
+
+namespace argc::build {
+
+using namespace err;
+
+BuildScheduler::BuildScheduler(ErrorReporter& reporter, const unsigned jobs)
+  : reporter_(reporter),
+    jobs_(jobs != 0 ? jobs : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+auto BuildScheduler::add_module(ModuleUnit unit) -> bool {
+  if (const auto it = index_by_name_.find(unit.name); it != index_by_name_.end()) {
+    (void)reporter_.report<ErrorCode::DuplicateModule>(
+      CompileStage::SymbolCollection,
+      ErrorSeverity::Error,
+      SourceLocation(unit.path, 1, 1),
+      unit.name, units_[it->second].path
+    );
+    return false;
+  }
+
+  index_by_name_.emplace(unit.name, units_.size());
+  units_.push_back(std::move(unit));
+  resolved_ = false;
+  return true;
+}
+
+auto BuildScheduler::index_of(const std::string& module_name) const -> std::optional<size_t> {
+  const auto it = index_by_name_.find(module_name);
+  if (it == index_by_name_.end()) return std::nullopt;
+  return it->second;
+}
+
+auto BuildScheduler::resolve() -> bool {
+  const size_t n = units_.size();
+  dependencies_.assign(n, {});
+  dependents_.assign(n, {});
+
+  bool ok = true;
+  for (size_t i = 0; i < n; ++i) {
+    for (const auto& import : units_[i].imports) {
+      const auto target = index_of(import.module_name);
+      if (!target) {
+        (void)reporter_.report<ErrorCode::UnresolvedImport>(
+          CompileStage::SymbolCollection,
+          ErrorSeverity::Error,
+          SourceLocation(units_[i].path, import.line, import.column),
+          import.module_name
+        );
+        ok = false;
+        continue;
+      }
+      auto& deps = dependencies_[i];
+      if (std::find(deps.begin(), deps.end(), *target) == deps.end()) {
+        deps.push_back(*target);
+        dependents_[*target].push_back(i);
+      }
+    }
+  }
+  if (!ok) return false;
+
+  if (const auto cycle = find_cycle(); !cycle.empty()) {
+    // Spell out every edge so the offending import lines can be found directly
+    std::string chain;
+    for (size_t k = 0; k + 1 < cycle.size(); ++k) {
+      const auto& from = units_[cycle[k]];
+      const auto& to = units_[cycle[k + 1]];
+      const auto edge = std::find_if(from.imports.begin(), from.imports.end(),
+                                     [&](const ImportRef& r) { return r.module_name == to.name; });
+      chain += fmt::format("{} ({}:{}) -> ", from.name, from.path, edge->line);
+    }
+    chain += units_[cycle.back()].name;
+
+    const auto& head = units_[cycle.front()];
+    const auto first_edge = std::find_if(head.imports.begin(), head.imports.end(),
+                                         [&](const ImportRef& r) { return r.module_name == units_[cycle[1]].name; });
+    (void)reporter_.report<ErrorCode::CyclicImport>(
+      CompileStage::SymbolCollection,
+      ErrorSeverity::Error,
+      SourceLocation(head.path, first_edge->line, first_edge->column),
+      chain
+    );
+    return false;
+  }
+
+  compute_waves();
+  resolved_ = true;
+  return true;
+}
+
+// Iterative DFS; returns the first cycle found as [a, b, ..., a], or empty
+auto BuildScheduler::find_cycle() const -> std::vector<size_t> {
+  enum class Mark : uint8_t { White, Grey, Black };
+  const size_t n = units_.size();
+  std::vector<Mark> mark(n, Mark::White);
+  std::vector<std::pair<size_t, size_t>> stack;   // (module, next dependency to visit)
+
+  for (size_t root = 0; root < n; ++root) {
+    if (mark[root] != Mark::White) continue;
+    stack.emplace_back(root, 0);
+    mark[root] = Mark::Grey;
+
+    while (!stack.empty()) {
+      auto& [node, next] = stack.back();
+      if (next == dependencies_[node].size()) {
+        mark[node] = Mark::Black;
+        stack.pop_back();
+        continue;
+      }
+      const size_t dep = dependencies_[node][next++];
+      if (mark[dep] == Mark::Grey) {
+        std::vector<size_t> cycle;
+        auto it = std::find_if(stack.begin(), stack.end(), [&](const auto& frame) { return frame.first == dep; });
+        for (; it != stack.end(); ++it) cycle.push_back(it->first);
+        cycle.push_back(dep);
+        return cycle;
+      }
+      if (mark[dep] == Mark::White) {
+        mark[dep] = Mark::Grey;
+        stack.emplace_back(dep, 0);
+      }
+    }
+  }
+  return {};
+}
+
+auto BuildScheduler::compute_waves() -> void {
+  const size_t n = units_.size();
+  std::vector<size_t> level(n, 0);
+  std::vector<size_t> pending(n);
+  std::deque<size_t> queue;
+  for (size_t i = 0; i < n; ++i) {
+    pending[i] = dependencies_[i].size();
+    if (pending[i] == 0) queue.push_back(i);
+  }
+
+  stats_.waves.clear();
+  while (!queue.empty()) {
+    const size_t node = queue.front();
+    queue.pop_front();
+    if (stats_.waves.size() <= level[node]) stats_.waves.resize(level[node] + 1);
+    stats_.waves[level[node]].push_back(node);
+    for (const size_t dependent : dependents_[node]) {
+      level[dependent] = std::max(level[dependent], level[node] + 1);
+      if (--pending[dependent] == 0) queue.push_back(dependent);
+    }
+  }
+}
+
+auto BuildScheduler::run(const CompileFn& compile) -> bool {
+  if (!resolved_ && !resolve()) return false;
+
+  const size_t n = units_.size();
+  status_.assign(n, ModuleStatus::Pending);
+  durations_.assign(n, std::chrono::nanoseconds{0});
+  stats_.modules = n;
+  stats_.workers = std::min<size_t>(jobs_, n);
+  if (n == 0) return true;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<size_t> ready;
+  std::vector<size_t> pending(n);
+  size_t finished = 0;
+
+  for (size_t i = 0; i < n; ++i) {
+    pending[i] = dependencies_[i].size();
+    if (pending[i] == 0) ready.push_back(i);
+  }
+
+  // Caller holds the lock. A failed module takes every transitive dependent
+  // down with it; they are marked now so the workers can drain.
+  auto complete = [&](const size_t index, const ModuleStatus result) {
+    status_[index] = result;
+    ++finished;
+
+    if (result == ModuleStatus::Succeeded) {
+      for (const size_t dependent : dependents_[index]) {
+        if (--pending[dependent] == 0 && status_[dependent] == ModuleStatus::Pending) {
+          ready.push_back(dependent);
+        }
+      }
+      return;
+    }
+
+    std::vector<size_t> to_skip(dependents_[index].begin(), dependents_[index].end());
+    while (!to_skip.empty()) {
+      const size_t dependent = to_skip.back();
+      to_skip.pop_back();
+      if (status_[dependent] != ModuleStatus::Pending) continue;
+      status_[dependent] = ModuleStatus::Skipped;
+      ++finished;
+      to_skip.insert(to_skip.end(), dependents_[dependent].begin(), dependents_[dependent].end());
+    }
+  };
+
+  auto worker = [&] {
+    std::unique_lock lock(mutex);
+    while (true) {
+      cv.wait(lock, [&] { return !ready.empty() || finished == n; });
+      if (ready.empty()) return;
+
+      const size_t index = ready.front();
+      ready.pop_front();
+      lock.unlock();
+
+      const auto start = std::chrono::steady_clock::now();
+      bool ok = false;
+      try {
+        ok = compile(index, units_[index]);
+      } catch (...) {
+        ok = false;
+      }
+      const auto elapsed = std::chrono::steady_clock::now() - start;
+
+      lock.lock();
+      durations_[index] = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed);
+      complete(index, ok ? ModuleStatus::Succeeded : ModuleStatus::Failed);
+      cv.notify_all();
+    }
+  };
+
+  const auto build_start = std::chrono::steady_clock::now();
+  if (stats_.workers == 1) {
+    worker();       // A single module (or -j 1) is not worth a thread
+  } else {
+    std::vector<std::jthread> workers;
+    workers.reserve(stats_.workers);
+    for (size_t w = 0; w < stats_.workers; ++w) workers.emplace_back(worker);
+  }
+  stats_.wall_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now() - build_start);
+
+  compute_critical_path();
+
+  return std::all_of(status_.begin(), status_.end(),
+                     [](const ModuleStatus s) { return s == ModuleStatus::Succeeded; });
+}
+
+auto BuildScheduler::compute_critical_path() -> void {
+  const size_t n = units_.size();
+  std::vector<std::chrono::nanoseconds> finish(n, std::chrono::nanoseconds{0});
+  std::vector<std::optional<size_t>> via(n);
+
+  // Waves are already a topological order
+  for (const auto& wave : stats_.waves) {
+    for (const size_t node : wave) {
+      for (const size_t dep : dependencies_[node]) {
+        if (!via[node] || finish[dep] > finish[*via[node]]) via[node] = dep;
+      }
+      finish[node] = durations_[node] + (via[node] ? finish[*via[node]] : std::chrono::nanoseconds{0});
+    }
+  }
+
+  const auto tail = std::max_element(finish.begin(), finish.end());
+  stats_.critical_path.clear();
+  stats_.critical_path_time = *tail;
+  for (std::optional<size_t> node = static_cast<size_t>(tail - finish.begin()); node; node = via[*node]) {
+    stats_.critical_path.push_back(*node);
+  }
+  std::reverse(stats_.critical_path.begin(), stats_.critical_path.end());
+}
+
+auto BuildScheduler::print_summary(std::FILE* out) const -> void {
+  const auto to_ms = [](const std::chrono::nanoseconds ns) { return static_cast<double>(ns.count()) / 1e6; };
+
+  fmt::print(out, "Build schedule: {} module(s) in {} wave(s) on {} worker(s), {:.3f} ms\n",
+             stats_.modules, stats_.waves.size(), stats_.workers, to_ms(stats_.wall_time));
+  for (size_t w = 0; w < stats_.waves.size(); ++w) {
+    std::string names;
+    for (const size_t node : stats_.waves[w]) {
+      names += (names.empty() ? "" : ", ") + units_[node].name;
+    }
+    fmt::print(out, "  wave {}: {}\n", w, names);
+  }
+
+  std::string path;
+  for (const size_t node : stats_.critical_path) {
+    path += (path.empty() ? "" : " -> ") + units_[node].name;
+  }
+  fmt::print(out, "Critical path: {} ({} module(s), {:.3f} ms)\n",
+             path, stats_.critical_path.size(), to_ms(stats_.critical_path_time));
+}
+
+}
@@ -0,0 +1,188 @@
+#include "CEmitter.hh"
+
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+#include <fmt/core.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace argc::codegen {
+
+namespace {
+
+  // Nesting and length past which a subexpression is moved into a named
+  // temporary. Keeps the C compiler's recursion shallow on very deep
+  // expressions and every string built here short, so emission is linear.
+  constexpr unsigned max_nesting = 32;
+  constexpr size_t max_inline_length = 96;
+
+  // C precedence of the operator producing a value; atoms bind tightest
+  enum class Prec : uint8_t { Additive, Multiplicative, Atom };
+
+  struct Fragment {
+    std::string text;
+    Prec prec { Prec::Atom };
+    unsigned depth { 0 };
+  };
+
+  constexpr auto op_symbol(const ir::Op op) -> const char* {
+    switch (op) {
+      case ir::Op::Add: return "+";
+      case ir::Op::Sub: return "-";
+      case ir::Op::Mul: return "*";
+      case ir::Op::Div: return "/";
+      case ir::Op::Const: break;
+    }
+    return "?";
+  }
+
+  constexpr auto helper_name(const ir::Op op) -> const char* {
+    switch (op) {
+      case ir::Op::Add: return "argon_add";
+      case ir::Op::Sub: return "argon_sub";
+      case ir::Op::Mul: return "argon_mul";
+      case ir::Op::Div: return "argon_div";
+      case ir::Op::Const: break;
+    }
+    return "?";
+  }
+
+  constexpr auto precedence(const ir::Op op) -> Prec {
+    return op == ir::Op::Mul || op == ir::Op::Div ? Prec::Multiplicative : Prec::Additive;
+  }
+
+  auto parenthesised(const Fragment& f, const bool needed) -> std::string {
+    return needed ? "(" + f.text + ")" : f.text;
+  }
+
+}
+
+auto CEmitter::file_header() -> std::string {
+  return
+    "/* Generated by argc. Argon integers are 32-bit and wrap on overflow. */\n"
+    "#include <stdint.h>\n"
+    "\n"
+    "#if defined(__GNUC__) || defined(__clang__)\n"
+    "static inline int32_t argon_add(int32_t a, int32_t b) { int32_t r; (void)__builtin_add_overflow(a, b, &r); return r; }\n"
+    "static inline int32_t argon_sub(int32_t a, int32_t b) { int32_t r; (void)__builtin_sub_overflow(a, b, &r); return r; }\n"
+    "static inline int32_t argon_mul(int32_t a, int32_t b) { int32_t r; (void)__builtin_mul_overflow(a, b, &r); return r; }\n"
+    "#else\n"
+    "static inline int32_t argon_add(int32_t a, int32_t b) { return (int32_t)((uint32_t)a + (uint32_t)b); }\n"
+    "static inline int32_t argon_sub(int32_t a, int32_t b) { return (int32_t)((uint32_t)a - (uint32_t)b); }\n"
+    "static inline int32_t argon_mul(int32_t a, int32_t b) { return (int32_t)((uint32_t)a * (uint32_t)b); }\n"
+    "#endif\n"
+    "/* INT32_MIN / -1 is the only quotient that overflows */\n"
+    "static inline int32_t argon_div(int32_t a, int32_t b) { return b == -1 ? argon_sub(0, a) : a / b; }\n";
+}
+
+auto CEmitter::emit_module(const ir::Module& module, const sema::TypeInfo* types) -> std::string {
+  const std::string symbol = "argon_" + module.name;
+  out_ += fmt::format("\n/* module {} */\nint32_t {}(void)\n{{\n", module.name, symbol);
+
+  uses_.clear();
+  if (module.exprs.shares()) {
+    uses_ = ir::count_uses(module);
+    for (ir::NodeId id = 0; id < uses_.size(); ++id) {
+      if (uses_[id] > 1 && ir::is_binary(module.exprs.node(id).op)) ++stats_.shared_values;
+    }
+  }
+
+  bool returned = false;
+  for (const auto& stmt : module.statements) {
+    emit_statement(module.exprs, stmt, types);
+    if (stmt.kind == ir::StmtKind::Return) {
+      returned = true;
+      break;            // Anything after 'ret' is unreachable
+    }
+  }
+  if (!returned) {
+    out_ += "    return 0;\n";
+  }
+  out_ += "}\n";
+
+  if (module.name == "main") {
+    out_ += fmt::format("\nint main(void)\n{{\n    return (int){}();\n}}\n", symbol);
+  }
+  return take();
+}
+
+auto CEmitter::emit_statement(const ir::ExprPool& exprs, const ir::Statement& stmt,
+                              const sema::TypeInfo* types) -> void {
+  // Single-use values are consumed in post-order, so they form a stack;
+  // constants and shared values are referenced by literal or name instead
+  std::vector<Fragment> operands;
+
+  const auto is_shared = [&](const ir::NodeId id) { return !uses_.empty() && uses_[id] > 1; };
+  const auto take_operand = [&](const ir::NodeId id) -> Fragment {
+    if (const auto& n = exprs.node(id); n.op == ir::Op::Const) return Fragment{ std::to_string(n.value) };
+    if (is_shared(id)) return Fragment{ fmt::format("v{}", id) };
+    Fragment top = std::move(operands.back());
+    operands.pop_back();
+    return top;
+  };
+
+  for (ir::NodeId id = stmt.first; id <= stmt.root; ++id) {
+    const auto& node = exprs.node(id);
+    if (node.op == ir::Op::Const) continue;
+
+    const Fragment rhs = take_operand(node.rhs);
+    const Fragment lhs = take_operand(node.lhs);
+    ++stats_.operations;
+
+    Fragment result;
+    result.depth = std::max(lhs.depth, rhs.depth) + 1;
+    if (!types || types->wraps(id)) {
+      ++stats_.wrapping_operations;
+      result.text = fmt::format("{}({}, {})", helper_name(node.op), lhs.text, rhs.text);
+      result.prec = Prec::Atom;
+    } else {
+      // Left-associative: an equal-precedence right operand keeps its parentheses
+      const Prec prec = precedence(node.op);
+      result.text = fmt::format("{} {} {}", parenthesised(lhs, lhs.prec < prec), op_symbol(node.op),
+                                parenthesised(rhs, rhs.prec <= prec));
+      result.prec = prec;
+    }
+
+    if (is_shared(id)) {
+      out_ += fmt::format("    const int32_t v{} = {};\n", id, result.text);
+      continue;
+    }
+    if (id != stmt.root && (result.depth >= max_nesting || result.text.size() > max_inline_length)) {
+      const std::string name = fmt::format("t{}", stats_.temporaries++);
+      out_ += fmt::format("    const int32_t {} = {};\n", name, result.text);
+      result = Fragment{ name };
+    }
+    operands.push_back(std::move(result));
+  }
+
+  const std::string value = take_operand(stmt.root).text;
+  if (stmt.kind == ir::StmtKind::Return) {
+    out_ += fmt::format("    return {};\n", value);
+  } else {
+    out_ += fmt::format("    (void)({});\n", value);
+  }
+}
+
+auto compile_c(const std::string& compiler, const std::string& source, const std::string& output) -> int {
+#if defined(__unix__) || defined(__APPLE__)
+  // Spawned directly so paths need no shell quoting
+  std::string program = compiler, opt = "-O2", flag = "-o", out = output, in = source;
+  char* argv[] = { program.data(), opt.data(), flag.data(), out.data(), in.data(), nullptr };
+
+  pid_t pid = 0;
+  if (posix_spawnp(&pid, program.c_str(), nullptr, nullptr, argv, environ) != 0) return -1;
+  int status = 0;
+  if (waitpid(pid, &status, 0) < 0) return -1;
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#else
+  return std::system(fmt::format("{} -O2 -o \"{}\" \"{}\"", compiler, output, source).c_str());
+#endif
+}
+
+}
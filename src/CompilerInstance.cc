@@ -0,0 +1,86 @@
+#include "CompilerInstance.hh"
+
+#include "BuildScheduler.hh"
+#include "Frontend.hh"
+
+namespace argc {
+
+using namespace err;
+
+auto CompileResult::unit(const ConfigHandler::EmitKind emit) const -> std::string {
+  std::string text;
+  if (emit == ConfigHandler::EmitKind::ASM) text = codegen::X86Emitter::file_header();
+  if (emit == ConfigHandler::EmitKind::C) text = codegen::CEmitter::file_header();
+  for (const auto& artifact : artifacts) text += artifact.code;
+  if (emit == ConfigHandler::EmitKind::ASM) text += codegen::X86Emitter::file_footer();
+  return text;
+}
+
+CompilerInstance::CompilerInstance(CompileOptions options)
+  : options_(options),
+    reporter_(true, options.max_errors),
+    frontend_(std::make_unique<Frontend>(reporter_))
+{
+  reporter_.setEcho(false);
+}
+
+CompilerInstance::~CompilerInstance() = default;
+
+auto CompilerInstance::compile(const std::string_view text, std::string path) -> CompileResult {
+  const SourceBuffer source { std::move(path), text };
+  return compile(std::span(&source, 1));
+}
+
+auto CompilerInstance::compile(const std::span<const SourceBuffer> sources) -> CompileResult {
+  CompileResult result;
+  reporter_.clear();
+  ++stats_.compilations;
+
+  const auto finish = [&](const bool succeeded) -> CompileResult {
+    result.succeeded = succeeded && reporter_.fatalCount() == 0;
+    result.diagnostics = reporter_.errors();
+    if (!result.succeeded) {
+      result.artifacts.clear();
+      result.asm_stats = {};
+      result.c_stats = {};
+    }
+    return std::move(result);
+  };
+
+  // === MODULE DISCOVERY ===
+  // One job: modules are compiled inline, on the one parser
+  build::BuildScheduler scheduler(reporter_, 1);
+  if (!discover_modules(reporter_, scheduler, sources)) {
+    return finish(false);
+  }
+
+  // Sized before any module runs: importers hold pointers into the tables
+  while (tables_.size() < sources.size()) {
+    tables_.emplace_back();
+    ++stats_.symbol_tables;
+  }
+  stats_.modules += sources.size();
+
+  ModulePipeline pipeline(
+    reporter_,
+    scheduler,
+    std::span(tables_.data(), sources.size()),
+    PipelineOptions{ .optimisation = options_.optimisation, .emit = options_.emit }
+  );
+  const bool built = scheduler.run([&](const size_t index, const build::ModuleUnit&) {
+    return pipeline.compile(*frontend_, index, sources[index].text);
+  });
+  if (!built) {
+    return finish(false);
+  }
+
+  for (const size_t index : pipeline.build_order()) {
+    const auto& unit = scheduler.modules()[index];
+    result.artifacts.push_back(Artifact{ unit.name, unit.path, std::move(pipeline.output(index).code) });
+  }
+  result.asm_stats = pipeline.asm_totals();
+  result.c_stats = pipeline.c_totals();
+  return finish(true);
+}
+
+}
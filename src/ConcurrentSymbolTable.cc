@@ -0,0 +1,152 @@
+#include "ConcurrentSymbolTable.hh"
+
+#include <bit>
+#include <string>
+
+namespace argc {
+
+SharedScope::SharedScope(const int level, const std::string_view name, const SharedScope* parent)
+  : level_(level), name_(name), parent_(parent)
+{
+}
+
+auto SharedScope::declare(const std::string_view name, const SymbolKind kind, const Type* type,
+                          const loc::SourceLocation& location) -> SymbolEntry* {
+  if (frozen()) return nullptr;
+
+  auto& s = shard(hash(name));
+  std::unique_lock lock(s.mutex);
+  // freeze() may have folded this shard into the index while we waited for
+  // it; it holds the lock until frozen_ is set, so the recheck is exact
+  if (frozen_.load(std::memory_order_relaxed) || s.symbols.contains(name)) return nullptr;
+
+  auto* entry = s.arena.create<SymbolEntry>(s.arena.intern(name), kind, type, level_, location);
+  entry->set_defined(true);
+  s.symbols.emplace(entry->name(), entry);
+  return entry;
+}
+
+auto SharedScope::lookup_current(const std::string_view name) const -> SymbolEntry* {
+  const size_t h = hash(name);
+
+  if (frozen()) {
+    for (size_t i = h & mask_;; i = (i + 1) & mask_) {
+      const auto& slot = index_[i];
+      if (!slot.entry) return nullptr;
+      if (slot.hash == h && slot.entry->name() == name) return slot.entry;
+    }
+  }
+
+  const auto& s = shard(h);
+  std::shared_lock lock(s.mutex);
+  const auto it = s.symbols.find(name);
+  return it != s.symbols.end() ? it->second : nullptr;
+}
+
+auto SharedScope::lookup(const std::string_view name) const -> SymbolEntry* {
+  for (const SharedScope* scope = this; scope; scope = scope->parent_) {
+    if (auto* entry = scope->lookup_current(name)) return entry;
+  }
+  return nullptr;
+}
+
+auto SharedScope::freeze() -> void {
+  std::lock_guard guard(freeze_mutex_);
+  if (frozen()) return;
+
+  // Writers are shut out shard by shard; lookups keep using the shards
+  // until the index is published below
+  std::vector<std::unique_lock<std::shared_mutex>> locks;
+  size_t count = 0;
+  for (auto& s : shards_) {
+    locks.emplace_back(s.mutex);
+    count += s.symbols.size();
+  }
+
+  // At most half full keeps probe chains short and guarantees an empty slot
+  const size_t capacity = std::bit_ceil(std::max<size_t>(8, count * 2));
+  index_.assign(capacity, Slot{});
+  mask_ = capacity - 1;
+  for (const auto& s : shards_) {
+    for (const auto& [key, entry] : s.symbols) {
+      const size_t h = hash(key);
+      size_t i = h & mask_;
+      while (index_[i].entry) i = (i + 1) & mask_;
+      index_[i] = Slot{ h, entry };
+    }
+  }
+
+  frozen_.store(true, std::memory_order_release);
+}
+
+auto SharedScope::size() const -> size_t {
+  size_t count = 0;
+  for (const auto& s : shards_) {
+    std::shared_lock lock(s.mutex);
+    count += s.symbols.size();
+  }
+  return count;
+}
+
+auto ConcurrentSymbolTable::add_module(const std::string_view name, const loc::SourceLocation& location) -> SharedScope* {
+  const auto* type = make_type<ModuleType>("module");
+  auto* entry = global_.declare(name, SymbolKind::MODULE, type, location);
+  if (!entry) return nullptr;
+
+  auto scope = std::make_unique<SharedScope>(1, name, &global_);
+  auto* raw = scope.get();
+  std::unique_lock lock(modules_mutex_);
+  modules_.emplace(entry->name(), std::move(scope));   // Key lives in the global scope's arena
+  return raw;
+}
+
+auto ConcurrentSymbolTable::module(const std::string_view name) const -> SharedScope* {
+  std::shared_lock lock(modules_mutex_);
+  const auto it = modules_.find(name);
+  return it != modules_.end() ? it->second.get() : nullptr;
+}
+
+auto ConcurrentSymbolTable::freeze() -> void {
+  global_.freeze();
+  std::shared_lock lock(modules_mutex_);
+  for (const auto& [_, scope] : modules_) {
+    scope->freeze();
+  }
+}
+
+auto ScopeCursor::enter_scope(const std::string_view name) -> void {
+  Scope* parent = scopes_.empty() ? nullptr : scopes_.back();
+  const int level = base_->level() + static_cast<int>(scopes_.size()) + 1;
+  const std::string_view scope_name = name.empty()
+      ? arena_.intern("block_" + std::to_string(anonymous_scope_counter_++))
+      : arena_.intern(name);
+  scopes_.push_back(arena_.create<Scope>(level, scope_name, parent, &arena_));
+}
+
+auto ScopeCursor::exit_scope() -> void {
+  if (!scopes_.empty()) scopes_.pop_back();
+}
+
+auto ScopeCursor::insert(const std::string_view name, const SymbolKind kind, const Type* type,
+                         const loc::SourceLocation& location) -> SymbolEntry* {
+  if (scopes_.empty()) return nullptr;
+  Scope* scope = scopes_.back();
+  if (scope->lookup_current(name)) return nullptr;
+
+  auto* entry = arena_.create<SymbolEntry>(arena_.intern(name), kind, type, scope->level(), location);
+  scope->insert(entry);
+  return entry;
+}
+
+auto ScopeCursor::lookup(const std::string_view name) const -> SymbolEntry* {
+  if (!scopes_.empty()) {
+    if (auto* entry = scopes_.back()->lookup(name)) return entry;
+  }
+  return base_->lookup(name);
+}
+
+auto ScopeCursor::lookup_current(const std::string_view name) const -> SymbolEntry* {
+  return scopes_.empty() ? base_->lookup_current(name) : scopes_.back()->lookup_current(name);
+}
+
+}
@@ -0,0 +1,87 @@
+#include "FileWatcher.hh"
+
+#include <algorithm>
+#include <cerrno>
+#include <filesystem>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace argc {
+
+#if defined(__linux__)
+
+FileWatcher::FileWatcher() : fd_(inotify_init1(IN_CLOEXEC)) {}
+
+FileWatcher::~FileWatcher() {
+  if (fd_ >= 0) close(fd_);
+}
+
+auto FileWatcher::add(const std::string& path) -> bool {
+  if (fd_ < 0) return false;
+
+  std::error_code ec;
+  const auto canonical = std::filesystem::weakly_canonical(path, ec);
+  if (ec) return false;
+
+  const std::string directory = canonical.parent_path().string();
+  const bool known = std::any_of(directories_.begin(), directories_.end(),
+                                 [&](const auto& entry) { return entry.second == directory; });
+  if (!known) {
+    const int wd = inotify_add_watch(fd_, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+    if (wd < 0) return false;
+    directories_.emplace(wd, directory);
+  }
+  files_.emplace(canonical.string(), path);
+  return true;
+}
+
+auto FileWatcher::wait(const std::chrono::milliseconds settle) -> std::vector<std::string> {
+  std::vector<std::string> changed;
+  if (fd_ < 0) return changed;
+
+  alignas(inotify_event) char buffer[16 * 1024];
+  int timeout = -1;      // The first read blocks; later ones only drain the burst
+
+  while (true) {
+    pollfd pfd { fd_, POLLIN, 0 };
+    const int ready = poll(&pfd, 1, timeout);
+    if (ready < 0 && errno == EINTR) continue;
+    if (ready <= 0) break;
+
+    const ssize_t length = read(fd_, buffer, sizeof(buffer));
+    if (length <= 0) break;
+
+    for (ssize_t offset = 0; offset < length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      if (event->len == 0) continue;
+
+      const auto dir = directories_.find(event->wd);
+      if (dir == directories_.end()) continue;
+      const auto file = files_.find((std::filesystem::path(dir->second) / event->name).string());
+      if (file == files_.end()) continue;
+      if (std::find(changed.begin(), changed.end(), file->second) == changed.end()) {
+        changed.push_back(file->second);
+      }
+    }
+    if (!changed.empty()) timeout = static_cast<int>(settle.count());
+  }
+  return changed;
+}
+
+#else
+
+FileWatcher::FileWatcher() = default;
+FileWatcher::~FileWatcher() = default;
+
+auto FileWatcher::add(const std::string&) -> bool { return false; }
+
+auto FileWatcher::wait(std::chrono::milliseconds) -> std::vector<std::string> { return {}; }
+
+#endif
+
+}
@@ -0,0 +1,50 @@
+#include "Frontend.hh"
+
+namespace argc {
+
+using namespace err;
+
+auto Frontend::SyntaxErrorSink::bind(std::string path) -> void {
+  path_ = std::move(path);
+  count_ = 0;
+}
+
+void Frontend::SyntaxErrorSink::syntaxError(antlr4::Recognizer*, antlr4::Token*, const size_t line, const size_t column,
+                                            const std::string& msg, std::exception_ptr) {
+  ++count_;     // ANTLR recovers regardless; parse() fails the module on the count
+  (void)reporter_.report<ErrorCode::SyntaxError>(
+    CompileStage::Parsing,
+    ErrorSeverity::Error,
+    SourceLocation(path_, static_cast<uint32_t>(line), static_cast<uint32_t>(column + 1)),
+    msg
+  );
+}
+
+Frontend::Frontend(ErrorReporter& reporter)
+  : errors_(reporter),
+    input_(std::make_unique<antlr4::ANTLRInputStream>(std::string_view{})),
+    lexer_(input_.get()),
+    tokens_(&lexer_),
+    parser_(&tokens_)
+{
+  lexer_.removeErrorListeners();
+  lexer_.addErrorListener(&errors_);
+  parser_.removeErrorListeners();
+  parser_.addErrorListener(&errors_);
+}
+
+auto Frontend::load(const std::string_view text, const std::string& path) -> void {
+  errors_.bind(path);
+  auto input = std::make_unique<antlr4::ANTLRInputStream>(text);
+  lexer_.setInputStream(input.get());     // Rewinds the previous input, so it must still be alive here
+  input_ = std::move(input);
+  tokens_.setTokenSource(&lexer_);
+  parser_.setTokenStream(&tokens_);
+}
+
+auto Frontend::parse() -> ArgonParser::ModuleDeclarationContext* {
+  auto* tree = parser_.moduleDeclaration();
+  return errors_.count() == 0 ? tree : nullptr;
+}
+
+}
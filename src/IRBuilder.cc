@@ -0,0 +1,95 @@
+#include "IRBuilder.hh"
+#include "ExpressionWalk.hh"
+#include <charconv>
+#include <limits>
+#include <string_view>
+#include <vector>
+#include <fmt/core.h>
+
+using namespace argc;
+using namespace err;
+
+
+auto IRBuilder::build(ArgonParser::ModuleDeclarationContext *ctx) -> Status {
+    status_ = {};
+    visitModuleDeclaration(ctx);
+    return status_;
+}
+
+std::any IRBuilder::visitModuleDeclaration(ArgonParser::ModuleDeclarationContext *ctx) {
+    module_.name = ctx->IDENTIFIER()->getText();
+    for (auto *stmt : ctx->statement()) {
+        // The statement that failed is still lowered whole, with a 0 in
+        // place of the bad literal; nothing after it is
+        if (!status_) break;
+        visit(stmt);
+    }
+    return nullptr;
+}
+
+std::any IRBuilder::visitExpressionStmt(ArgonParser::ExpressionStmtContext *ctx) {
+    lower_statement(ir::StmtKind::Expression, ctx->expression(), ctx);
+    return nullptr;
+}
+
+std::any IRBuilder::visitReturnStmt(ArgonParser::ReturnStmtContext *ctx) {
+    lower_statement(ir::StmtKind::Return, ctx->expression(), ctx);
+    return nullptr;
+}
+
+auto IRBuilder::lower_literal(ArgonParser::IntAtomContext *ctx) -> ir::NodeId {
+    if (!ctx || !ctx->INTEGER()) {
+        return module_.exprs.make_const(0);      // Left out by error recovery
+    }
+    const auto token = ctx->INTEGER()->getSymbol();
+    const std::string text{token->getText()};
+
+    int64_t value = 0;
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (ec != std::errc{} || value > std::numeric_limits<int32_t>::max()) {
+        // A literal can be megabytes long; the diagnostic only needs its start
+        constexpr size_t shown_digits = 24;
+        const std::string shown = text.size() <= shown_digits
+            ? text
+            : fmt::format("{}... ({} digits)", std::string_view(text).substr(0, shown_digits), text.size());
+        auto status = error_reporter_.report<ErrorCode::IntegerOutOfRange>(
+            CompileStage::CodeGeneration,
+            ErrorSeverity::Error,
+            SourceLocation(source_file_,
+                           static_cast<uint32_t>(token->getLine()),
+                           static_cast<uint32_t>(token->getCharPositionInLine() + 1)),
+            shown
+            );
+        if (status_) status_ = std::move(status);
+        value = 0;
+    }
+
+    return module_.exprs.make_const(value);
+}
+
+auto IRBuilder::lower_statement(const ir::StmtKind kind,
+                                ArgonParser::ExpressionContext *expr,
+                                antlr4::ParserRuleContext *stmt) -> void {
+    const auto first = static_cast<ir::NodeId>(module_.exprs.size());
+    std::vector<ir::NodeId> operands;
+    walk_expression(
+        expr,
+        [&](const char op, antlr4::ParserRuleContext *) {
+            const auto rhs = operands.back();
+            operands.pop_back();
+            const auto lhs = operands.back();
+            operands.pop_back();
+            const auto binary = op == '+' ? ir::Op::Add
+                              : op == '-' ? ir::Op::Sub
+                              : op == '*' ? ir::Op::Mul
+                              : ir::Op::Div;
+            operands.push_back(module_.exprs.make_binary(binary, lhs, rhs));
+        },
+        [&](ArgonParser::IntAtomContext *literal) {
+            operands.push_back(lower_literal(literal));
+        });
+    const auto root = operands.back();
+    module_.statements.push_back(ir::Statement{
+        kind, first, root, static_cast<uint32_t>(stmt->getStart()->getLine())
+    });
+}
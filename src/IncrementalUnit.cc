@@ -0,0 +1,61 @@
+#include "IncrementalUnit.hh"
+
+#include <algorithm>
+#include <cstring>
+
+namespace argc::incr {
+
+auto diff_text(const std::string_view before, const std::string_view after) -> TextEdit {
+  // Whole blocks are compared with memcmp first; buffers of generated code
+  // run to megabytes and the edit is usually a handful of bytes
+  constexpr size_t block = 4096;
+  const size_t limit = std::min(before.size(), after.size());
+
+  size_t prefix = 0;
+  while (prefix + block <= limit && std::memcmp(before.data() + prefix, after.data() + prefix, block) == 0) {
+    prefix += block;
+  }
+  while (prefix < limit && before[prefix] == after[prefix]) ++prefix;
+
+  // The suffix may not overlap the prefix in either buffer
+  const size_t suffix_limit = limit - prefix;
+  size_t suffix = 0;
+  while (suffix + block <= suffix_limit &&
+         std::memcmp(before.data() + before.size() - suffix - block, after.data() + after.size() - suffix - block, block) == 0) {
+    suffix += block;
+  }
+  while (suffix < suffix_limit && before[before.size() - suffix - 1] == after[after.size() - suffix - 1]) ++suffix;
+
+  return TextEdit{ prefix, before.size() - prefix - suffix, after.size() - prefix - suffix };
+}
+
+auto segment_lines(const std::string_view text, const size_t begin, const size_t end, uint32_t line,
+                   std::vector<Segment>& out) -> void {
+  size_t pos = begin;
+  while (pos < end) {
+    const size_t start = pos;
+    bool blank = true;
+    while (pos < end && !is_line_break(text[pos])) {
+      if (text[pos] != ' ' && text[pos] != '\t') blank = false;
+      ++pos;
+    }
+    if (!blank) out.push_back(Segment{ start, pos, line });
+
+    while (pos < end && is_line_break(text[pos])) {
+      if (text[pos] == '\n') ++line;
+      ++pos;
+    }
+  }
+}
+
+auto segment_lines(const std::string_view text) -> std::vector<Segment> {
+  std::vector<Segment> segments;
+  segment_lines(text, 0, text.size(), 1, segments);
+  return segments;
+}
+
+auto count_newlines(const std::string_view text) -> uint32_t {
+  return static_cast<uint32_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+}
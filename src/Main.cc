@@ -1,8 +1,17 @@
-#include "ArgonParser.h"
-#include "ArgonLexer.h"
 #include "ErrorReporter.hh"
 #include "ConfigHandler.hh"
-#include "SymbolCollector.hh"
+#include "BuildScheduler.hh"
+#include "Frontend.hh"
+#include "ModulePipeline.hh"
+#include "X86Emitter.hh"
+#include "CEmitter.hh"
+#include "WatchSession.hh"
+#include "ParserProfile.hh"
+#include "MemReport.hh"
+#include "ParserWarmup.hh"
+#include "TimeReport.hh"
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <fstream>
 #include <fmt/core.h>
@@ -10,6 +19,9 @@
 
 
 auto main(const int argc, char *argv[]) -> int {
+  argc::TimeReport time_report;
+  argc::ParserWarmup parser_warmup(time_report);
+
   argc::err::ErrorReporter error_reporter(true, 100, "compiler_errors.log");
   error_reporter.setVerbose(true);
 
@@ -20,13 +32,24 @@ auto main(const int argc, char *argv[]) -> int {
     fmt::print(stderr, "Failed to parse command line arguments\n");
     return 1;
   }
+  if (config.shouldReportTime()) {
+    time_report.enable();
+  }
+  time_report.mark("arguments parsed");
 
-  for (const auto &input_file_path: config.getInputFiles()) {
-    fmt::print("Processing file: {}\n", input_file_path);
+  if (config.shouldWatch()) {
+    argc::WatchSession session(config, error_reporter);
+    return session.run();
+  }
 
+  // === MODULE DISCOVERY ===
+  argc::build::BuildScheduler scheduler(error_reporter, config.getJobs());
+  std::vector<std::string> sources;
+
+  for (const auto &input_file_path: config.getInputFiles()) {
     std::ifstream input_file(input_file_path);
     if (!input_file.is_open()) {
-      error_reporter.reportQuick(
+      (void)error_reporter.reportQuick(
         argc::err::ErrorCode::InvalidToken,
         argc::err::CompileStage::Lexing,
         argc::err::ErrorSeverity::Fatal,
@@ -35,81 +58,241 @@ auto main(const int argc, char *argv[]) -> int {
       return 1;
     }
 
-    std::string input_text((std::istreambuf_iterator<char>(input_file)),
-                           std::istreambuf_iterator<char>());
-    input_file.close();
+    sources.emplace_back((std::istreambuf_iterator<char>(input_file)),
+                         std::istreambuf_iterator<char>());
+  }
 
-    try {
-      // === LEXICAL ANALYSIS ===
-      if (config.getVerbosity() >= 1) {
-        fmt::print("Stage: Lexical Analysis\n");
+  std::vector<argc::SourceBuffer> buffers;
+  for (size_t i = 0; i < sources.size(); ++i) {
+    buffers.push_back({ config.getInputFiles()[i], sources[i] });
+  }
+  if (!argc::discover_modules(error_reporter, scheduler, buffers)) {
+    return 1;
+  }
+  time_report.mark("modules discovered");
+
+  if (config.shouldReportMemory()) {
+    if (argc::mem::tracking_available()) {
+      std::vector<argc::mem::TrackedFile> tracked;
+      for (size_t i = 0; i < sources.size(); ++i) {
+        tracked.push_back({ scheduler.modules()[i].path, sources[i].size() });
       }
+      argc::mem::start_tracking(std::move(tracked));
+    } else {
+      fmt::print(stderr, "--mem-report is not available on this platform\n");
+    }
+  }
 
-      antlr4::ANTLRInputStream input(input_text);
-      ArgonLexer lexer(&input);
-      antlr4::CommonTokenStream tokens(&lexer);
+  // Each slot is written once by the worker compiling that module and only
+  // read by dependents the scheduler releases after it completes
+  std::vector<argc::SymbolTable> symbol_tables(sources.size());
 
-      // === PARSING ===
-      if (config.getVerbosity() >= 1) {
-        fmt::print("Stage: Parsing\n");
+  // A module's table (and the arena behind it) is released once every table
+  // importing it has been: an import leaves the importer's table pointing at
+  // the dependency's module scope and type. Tables nobody imports go as soon
+  // as their module is compiled, and the release cascades down the imports.
+  std::vector<std::atomic<size_t>> live_importers(sources.size());
+  for (size_t i = 0; i < sources.size(); ++i) {
+    live_importers[i] = scheduler.dependents(i).size();
+  }
+  auto release_symbols = [&](const size_t index) {
+    std::vector<size_t> released { index };
+    while (!released.empty()) {
+      const size_t next = released.back();
+      released.pop_back();
+      symbol_tables[next] = argc::SymbolTable{};
+      for (const size_t dep : scheduler.dependencies(next)) {
+        if (live_importers[dep].fetch_sub(1) == 1) released.push_back(dep);
       }
+    }
+  };
+  argc::ParserProfile parser_profile;
 
-      ArgonParser parser(&tokens);
-      ArgonParser::ModuleDeclarationContext *parse_tree = parser.moduleDeclaration();
+  if (config.getEmitKind() == argc::ConfigHandler::EmitKind::ASM &&
+      config.getTargetArch() != argc::ConfigHandler::TargetArch::X86_64) {
+    (void)error_reporter.reportQuick(
+      argc::err::ErrorCode::InvalidInstruction,
+      argc::err::CompileStage::CodeGeneration,
+      argc::err::ErrorSeverity::Fatal,
+      "Code generation is only available for x86_64"
+    );
+    return 1;
+  }
 
-      if (!parse_tree) {
-        error_reporter.reportQuick(
-          argc::err::ErrorCode::SyntaxError,
-          argc::err::CompileStage::Parsing,
-          argc::err::ErrorSeverity::Fatal,
-          "Failed to parse module declaration"
-        );
-        return 1;
+  // Progress and statistics; the stages themselves run in the pipeline
+  argc::PipelineHooks hooks;
+  hooks.stage = [&](const argc::build::ModuleUnit &, const argc::err::CompileStage stage) {
+    argc::mem::enter_stage(stage);
+    if (config.getVerbosity() < 1) return;
+    switch (stage) {
+      case argc::err::CompileStage::Lexing: fmt::print("Stage: Lexical Analysis\n"); break;
+      case argc::err::CompileStage::Parsing: fmt::print("Stage: Parsing\n"); break;
+      case argc::err::CompileStage::SymbolCollection: fmt::print("Stage: Symbol Collection\n"); break;
+      case argc::err::CompileStage::TypeChecking: fmt::print("Stage: Type Checking\n"); break;
+      case argc::err::CompileStage::CodeGeneration:
+        if (config.getEmitKind() == argc::ConfigHandler::EmitKind::ASM) fmt::print("Stage: Code Generation\n");
+        if (config.getEmitKind() == argc::ConfigHandler::EmitKind::C) fmt::print("Stage: Code Generation (C)\n");
+        break;
+      default: break;
+    }
+  };
+  hooks.parsing = [&](ArgonParser &parser) {
+    if (config.shouldProfileParser()) {
+      parser.setProfile(true);
+    }
+  };
+  hooks.parsed = [&](ArgonParser &parser) {
+    if (config.shouldProfileParser()) {
+      parser_profile.record(parser);
+    }
+    time_report.mark("first parse done");
+  };
+  hooks.collected = [&](const argc::build::ModuleUnit &unit, const argc::SymbolTable &symbol_table, const bool collected) {
+    if (config.getVerbosity() >= 2) {
+      fmt::print("=== Symbol Table Contents ===\n");
+      symbol_table.dump_current_scope(std::cout);
+      fmt::print("=============================\n");
+    }
+    if (!collected) {
+      fmt::print(stderr, fg(fmt::color::red), "Compilation of {} aborted during symbol collection\n", unit.path);
+    } else if (config.getVerbosity() >= 1) {
+      fmt::print("Symbol collection completed successfully for {}\n", unit.path);
+    }
+  };
+  hooks.lowered = [&](const argc::build::ModuleUnit &, const argc::ir::Module &module) {
+    if (config.getOptimisationLevel() >= argc::ConfigHandler::OptimisationLevel::TWO && config.getVerbosity() >= 1) {
+      const auto &pool = module.exprs;
+      fmt::print("Common subexpressions: {} of {} node(s) deduplicated, IR {} KiB instead of {} KiB\n",
+                 pool.stats().deduplicated, pool.stats().requested,
+                 pool.memory_bytes() / 1024, pool.stats().requested * sizeof(argc::ir::Node) / 1024);
+    }
+  };
+  hooks.checked = [&](const argc::build::ModuleUnit &, const argc::sema::TypeInfo &types) {
+    if (config.getVerbosity() >= 2) {
+      const auto& ts = types.stats;
+      fmt::print("Type checking: {} node(s), {} i8, {} i16, {} i32, {} wrapping\n",
+                 ts.nodes, ts.by_type[0], ts.by_type[1], ts.by_type[2], ts.overflows);
+    }
+  };
+
+  argc::ModulePipeline pipeline(
+    error_reporter,
+    scheduler,
+    symbol_tables,
+    argc::PipelineOptions{
+      .optimisation = config.getOptimisationLevel(),
+      .emit = config.getEmitKind(),
+      .lex_ahead = config.shouldReportMemory(),
+    },
+    std::move(hooks)
+  );
+
+  auto compile_module = [&](const size_t index, const argc::build::ModuleUnit &unit) -> bool {
+    fmt::print("Processing file: {}\n", unit.path);
+    argc::mem::FileScope memory_scope(index);
+
+    // A front end per module: workers compile modules in parallel. Built
+    // inside the lexing stage, where --mem-report charges the lexer.
+    argc::mem::enter_stage(argc::err::CompileStage::Lexing);
+    argc::Frontend frontend(error_reporter);
+    if (!pipeline.compile(frontend, index, sources[index])) {
+      return false;
+    }
+
+    if (scheduler.dependents(index).empty()) {
+      release_symbols(index);
+    }
+    return true;
+  };
+
+  const bool built = scheduler.run(compile_module);
+
+  if (config.getVerbosity() >= 1) {
+    scheduler.print_summary(stdout);
+  }
+
+  // Reported even when the build failed; a slow or broken parse is what it is for
+  if (config.shouldProfileParser()) {
+    parser_profile.write_text(stdout);
+    if (const auto &path = config.getParserProfileFile(); !path.empty()) {
+      if (std::FILE *json = std::fopen(path.c_str(), "w")) {
+        parser_profile.write_json(json);
+        std::fclose(json);
+      } else {
+        fmt::print(stderr, "Could not write parser profile to {}\n", path);
       }
+    }
+  }
 
-      // === SYMBOL COLLECTION ===
-      if (config.getVerbosity() >= 1) {
-        fmt::print("Stage: Symbol Collection\n");
+  if (config.shouldReportMemory() && argc::mem::tracking_available()) {
+    const auto memory = argc::mem::MemoryReport::collect();
+    memory.write_text(stdout);
+    if (const auto &path = config.getMemReportFile(); !path.empty()) {
+      if (std::FILE *json = std::fopen(path.c_str(), "w")) {
+        memory.write_json(json);
+        std::fclose(json);
+      } else {
+        fmt::print(stderr, "Could not write memory report to {}\n", path);
       }
+    }
+  }
 
-      argc::SymbolCollector symbol_collector(error_reporter);
-      symbol_collector.visitModuleDeclaration(parse_tree);
+  if (!built) {
+    for (size_t i = 0; i < scheduler.modules().size(); ++i) {
+      if (scheduler.status(i) == argc::build::ModuleStatus::Skipped) {
+        fmt::print(stderr, "Skipped {}: an imported module failed to compile\n", scheduler.modules()[i].path);
+      }
+    }
+    return 1;
+  }
 
-      // Get the populated symbol table
-      auto &symbol_table = symbol_collector.getSymbolTable();
+  if (config.getEmitKind() == argc::ConfigHandler::EmitKind::ASM) {
+    // Dependencies first, in the order the scheduler resolved them
+    std::ofstream output(config.getOutputFile());
+    output << argc::codegen::X86Emitter::file_header();
+    for (const size_t index : pipeline.build_order()) {
+      output << pipeline.output(index).code;
+    }
+    output << argc::codegen::X86Emitter::file_footer();
+    const auto totals = pipeline.asm_totals();
 
-      if (config.getVerbosity() >= 2) {
-        fmt::print("=== Symbol Table Contents ===\n");
-        symbol_table.dump_current_scope(std::cout);
-        fmt::print("=============================\n");
-      }
+    if (config.getVerbosity() >= 1) {
+      fmt::print("Code generation: {} instruction(s), {} multiply(ies) and {} division(s) strength-reduced, "
+                 "{} shared value(s)\n",
+                 totals.instructions, totals.multiplies_reduced, totals.divisions_reduced, totals.shared_values);
+      fmt::print("Register allocation: {} value(s) in registers, {} spilled, {} callee-saved register(s) preserved\n",
+                 totals.register_values, totals.spills, totals.callee_saved);
+    }
+  }
 
-      if (!error_reporter.shouldContinue()) {
-        fmt::print(stderr, fg(fmt::color::red),
-                   "Compilation aborted due to {} error(s) and {} warning(s)\n",
-                   error_reporter.errorCount() - error_reporter.warningCount(),
-                   error_reporter.warningCount());
-        return 1;
+  if (config.getEmitKind() == argc::ConfigHandler::EmitKind::C) {
+    // With --cc the C is kept next to the binary built from it
+    const auto &host_cc = config.getHostCompiler();
+    const std::string c_file = host_cc.empty() ? config.getOutputFile() : config.getOutputFile() + ".c";
+    {
+      std::ofstream output(c_file);
+      output << argc::codegen::CEmitter::file_header();
+      for (const size_t index : pipeline.build_order()) {
+        output << pipeline.output(index).code;
       }
+      const auto totals = pipeline.c_totals();
 
-      // === FUTURE STAGES ===
-      // Shall continue with:
-      // - Semantic Analysis
-      // - Type Checking
-      // - Code Generation
-      // - Optimisation (if enabled)
+      if (config.getVerbosity() >= 1) {
+        fmt::print("Code generation: {} operation(s), {} through wrapping helpers, {} temporary(ies), "
+                   "{} shared value(s)\n",
+                   totals.operations, totals.wrapping_operations, totals.temporaries, totals.shared_values);
+      }
+    }
 
+    if (!host_cc.empty()) {
       if (config.getVerbosity() >= 1) {
-        fmt::print("Symbol collection completed successfully for {}\n", input_file_path);
+        fmt::print("Stage: Host C Compiler ({} -O2)\n", host_cc);
+      }
+      if (const int status = argc::codegen::compile_c(host_cc, c_file, config.getOutputFile()); status != 0) {
+        fmt::print(stderr, fg(fmt::color::crimson), "Error: ");
+        fmt::print(stderr, "{} failed on {} (status {})\n", host_cc, c_file, status);
+        return 1;
       }
-    } catch (const std::runtime_error &e) {
-      fmt::print(stderr, fg(fmt::color::crimson), "Fatal Error: ");
-      fmt::print(stderr, "{}\n", e.what());
-      return 1;
-    } catch (const std::exception &e) {
-      fmt::print(stderr, fg(fmt::color::crimson), "Unexpected Error: ");
-      fmt::print(stderr, "{}\n", e.what());
-      return 1;
     }
   }
 
@@ -0,0 +1,349 @@
+#include "MemReport.hh"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include <fmt/core.h>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+namespace argc::mem {
+
+namespace {
+
+  struct Counters {
+    std::atomic<uint64_t> allocations { 0 };
+    std::atomic<uint64_t> bytes { 0 };
+    std::atomic<int64_t> live { 0 };
+    std::atomic<int64_t> peak { 0 };
+
+    auto allocated(const int64_t size) -> void {
+      allocations.fetch_add(1, std::memory_order_relaxed);
+      bytes.fetch_add(static_cast<uint64_t>(size), std::memory_order_relaxed);
+      const int64_t now = live.fetch_add(size, std::memory_order_relaxed) + size;
+      int64_t seen = peak.load(std::memory_order_relaxed);
+      while (now > seen && !peak.compare_exchange_weak(seen, now, std::memory_order_relaxed)) {}
+    }
+
+    auto freed(const int64_t size) -> void {
+      live.fetch_sub(size, std::memory_order_relaxed);
+    }
+
+    auto reset() -> void {
+      allocations = 0;
+      bytes = 0;
+      live = 0;
+      peak = 0;
+    }
+
+    [[nodiscard]] auto usage() const -> MemoryUsage {
+      return MemoryUsage{ allocations.load(), bytes.load(), peak.load() };
+    }
+  };
+
+  struct FileCounters {
+    std::array<Counters, stage_slots> stages;
+    Counters total;
+  };
+
+  constexpr uint32_t no_file = UINT32_MAX;
+  constexpr uint32_t other_stage = stage_slots - 1;
+
+  // Written in front of every block allocated while tracking, so a free is
+  // charged to the file and stage that made the block, whichever thread
+  // frees it. The tag sits where glibc keeps an untracked chunk's size
+  // field, which can never have the top bits set, so a tracked block is
+  // told apart from one allocated before tracking started.
+  struct BlockHeader {
+    uint32_t file;
+    uint16_t stage;
+    uint16_t offset_log2;       // From the start of the allocation to the block
+    uint64_t tag;
+  };
+  static_assert(sizeof(BlockHeader) == alignof(std::max_align_t));
+
+  constexpr uint64_t tracked_tag = 0xA7C0'11EC'7ED0'B10CULL;
+
+  std::atomic<bool> tracking { false };
+  std::atomic<bool> headers_issued { false };     // Never cleared: headed blocks can outlive tracking
+  FileCounters* file_counters = nullptr;
+  size_t file_count = 0;
+  std::vector<TrackedFile> tracked_files;
+  Counters driver_counters;
+  Counters process_counters;
+
+  // Trivial types, so reading them inside operator new needs no TLS initialisation
+  thread_local uint32_t current_file = no_file;
+  thread_local uint32_t current_stage = other_stage;
+
+  constexpr std::array<std::string_view, stage_slots> stage_keys {
+    "lexing", "parsing", "symbol_collection", "semantic_analysis",
+    "type_checking", "code_generation", "optimisation", "other"
+  };
+
+  [[maybe_unused]] auto header_of(void* block) -> BlockHeader* {
+    return static_cast<BlockHeader*>(block) - 1;
+  }
+
+  // Sizes are the allocator's usable size of the whole allocation, header
+  // included, so allocation and free see the same number
+  [[maybe_unused]] auto account(const uint32_t file, const uint32_t stage, const int64_t size, const bool allocated) -> void {
+    const auto count = [&](Counters& c) { allocated ? c.allocated(size) : c.freed(size); };
+    count(process_counters);
+    if (file < file_count) {
+      count(file_counters[file].stages[stage]);
+      count(file_counters[file].total);
+    } else {
+      count(driver_counters);
+    }
+  }
+
+  auto peak_rss_bytes() -> uint64_t {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;     // KiB on Linux
+#endif
+#else
+    return 0;
+#endif
+  }
+
+  auto kib(const uint64_t bytes) -> double { return static_cast<double>(bytes) / 1024.0; }
+  auto kib(const int64_t bytes) -> double { return static_cast<double>(bytes) / 1024.0; }
+
+  auto json_usage(const MemoryUsage& u) -> std::string {
+    return fmt::format("{{\"allocations\": {}, \"bytes\": {}, \"peak_live_bytes\": {}}}",
+                       u.allocations, u.bytes, u.peak_live);
+  }
+
+  auto json_stages(const std::array<MemoryUsage, stage_slots>& stages) -> std::string {
+    std::string out = "{";
+    for (size_t s = 0; s < stage_slots; ++s) {
+      out += fmt::format("{}\"{}\": {}", s ? ", " : "", stage_keys[s], json_usage(stages[s]));
+    }
+    return out + "}";
+  }
+
+  auto json_string(const std::string_view text) -> std::string {
+    std::string out = "\"";
+    for (const char c : text) {
+      switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n"; break;
+        case '\t': out += "\\t"; break;
+        default:
+          if (static_cast<unsigned char>(c) < 0x20) {
+            out += fmt::format("\\u{:04x}", static_cast<unsigned>(c));
+          } else {
+            out += c;
+          }
+      }
+    }
+    return out + "\"";
+  }
+
+}
+
+auto tracking_available() -> bool {
+#if defined(__GLIBC__)
+  return true;
+#else
+  return false;
+#endif
+}
+
+auto start_tracking(std::vector<TrackedFile> files) -> void {
+  headers_issued.store(true);
+  tracking.store(false);
+  delete[] file_counters;
+  file_counters = new FileCounters[files.size()];
+  file_count = files.size();
+  tracked_files = std::move(files);
+  driver_counters.reset();
+  process_counters.reset();
+  tracking.store(tracking_available());
+}
+
+FileScope::FileScope(const size_t file) {
+  current_file = static_cast<uint32_t>(file);
+  current_stage = other_stage;
+}
+
+FileScope::~FileScope() {
+  current_file = no_file;
+  current_stage = other_stage;
+}
+
+auto enter_stage(const err::CompileStage stage) -> void {
+  current_stage = static_cast<uint32_t>(stage);
+}
+
+auto MemoryReport::collect() -> MemoryReport {
+  MemoryReport report;
+  for (size_t f = 0; f < file_count; ++f) {
+    FileMemory file;
+    file.path = tracked_files[f].path;
+    file.input_bytes = tracked_files[f].input_bytes;
+    for (size_t s = 0; s < stage_slots; ++s) file.stages[s] = file_counters[f].stages[s].usage();
+    file.total = file_counters[f].total.usage();
+    report.files.push_back(std::move(file));
+  }
+  report.driver = driver_counters.usage();
+  report.peak_live = process_counters.peak.load();
+  report.peak_rss = peak_rss_bytes();
+  return report;
+}
+
+auto MemoryReport::stage_totals() const -> std::array<MemoryUsage, stage_slots> {
+  std::array<MemoryUsage, stage_slots> totals {};
+  for (const auto& file : files) {
+    for (size_t s = 0; s < stage_slots; ++s) {
+      totals[s].allocations += file.stages[s].allocations;
+      totals[s].bytes += file.stages[s].bytes;
+      totals[s].peak_live = std::max(totals[s].peak_live, file.stages[s].peak_live);
+    }
+  }
+  return totals;
+}
+
+auto MemoryReport::write_text(std::FILE* out) const -> void {
+  fmt::print(out, "Memory report: peak RSS {:.1f} KiB, peak live heap {:.1f} KiB since tracking started\n",
+             kib(peak_rss), kib(peak_live));
+
+  fmt::print(out, "  {:<20} {:>12} {:>14} {:>14}\n", "stage", "allocations", "KiB", "peak-live-KiB");
+  const auto totals = stage_totals();
+  for (size_t s = 0; s < stage_slots; ++s) {
+    if (totals[s].allocations == 0) continue;
+    fmt::print(out, "  {:<20} {:>12} {:>14.1f} {:>14.1f}\n",
+               stage_keys[s], totals[s].allocations, kib(totals[s].bytes), kib(totals[s].peak_live));
+  }
+  fmt::print(out, "  {:<20} {:>12} {:>14.1f} {:>14.1f}\n",
+             "(driver)", driver.allocations, kib(driver.bytes), kib(driver.peak_live));
+
+  fmt::print(out, "  {:<30} {:>10} {:>12} {:>14} {:>14} {:>12}\n",
+             "file", "input-KiB", "allocations", "KiB", "peak-live-KiB", "peak/input");
+  for (const auto& file : files) {
+    fmt::print(out, "  {:<30} {:>10.1f} {:>12} {:>14.1f} {:>14.1f} {:>12.1f}\n",
+               file.path, kib(file.input_bytes), file.total.allocations, kib(file.total.bytes),
+               kib(file.total.peak_live),
+               file.input_bytes ? static_cast<double>(file.total.peak_live) / static_cast<double>(file.input_bytes) : 0.0);
+  }
+}
+
+auto MemoryReport::write_json(std::FILE* out) const -> void {
+  fmt::print(out, "{{\n  \"peak_rss_bytes\": {},\n  \"peak_live_bytes\": {},\n", peak_rss, peak_live);
+  fmt::print(out, "  \"driver\": {},\n  \"stages\": {},\n  \"files\": [", json_usage(driver), json_stages(stage_totals()));
+  for (size_t i = 0; i < files.size(); ++i) {
+    const auto& file = files[i];
+    fmt::print(out, "{}\n    {{\"path\": {}, \"input_bytes\": {}, \"total\": {}, \"stages\": {}}}",
+               i ? "," : "", json_string(file.path), file.input_bytes,
+               json_usage(file.total), json_stages(file.stages));
+  }
+  fmt::print(out, "{}]\n}}\n", files.empty() ? "" : "\n  ");
+}
+
+}
+
+// The allocator hook. Without tracking it costs one relaxed load and a
+// predictable branch per call over the default operators; a free costs one
+// more load once tracking has ever started. The library's array and nothrow
+// forms forward to these.
+#if defined(__GLIBC__)
+
+namespace {
+
+  using argc::mem::BlockHeader;
+
+  auto allocate_tracked(const std::size_t bytes, const std::size_t align) -> void* {
+    // The header takes a whole alignment unit, so the block stays aligned
+    const std::size_t offset = std::max(align, sizeof(BlockHeader));
+    void* base = offset == sizeof(BlockHeader)
+      ? std::malloc(offset + bytes)
+      : std::aligned_alloc(offset, (offset + bytes + offset - 1) / offset * offset);
+    if (!base) return nullptr;
+
+    void* block = static_cast<char*>(base) + offset;
+    const auto file = argc::mem::current_file;
+    const auto stage = argc::mem::current_stage;
+    *argc::mem::header_of(block) = BlockHeader{
+      file, static_cast<uint16_t>(stage), static_cast<uint16_t>(std::countr_zero(offset)), argc::mem::tracked_tag
+    };
+    argc::mem::account(file, stage, static_cast<int64_t>(malloc_usable_size(base)), true);
+    return block;
+  }
+
+  auto allocate(const std::size_t size, const std::size_t align) -> void* {
+    for (;;) {
+      const std::size_t bytes = std::max<std::size_t>(size, 1);
+      void* block = nullptr;
+      if (argc::mem::tracking.load(std::memory_order_relaxed)) [[unlikely]] {
+        block = allocate_tracked(bytes, align);
+      } else {
+        block = align <= alignof(std::max_align_t)
+          ? std::malloc(bytes)
+          : std::aligned_alloc(align, (bytes + align - 1) / align * align);
+      }
+      if (block) return block;
+
+      const auto handler = std::get_new_handler();
+      if (!handler) throw std::bad_alloc();
+      handler();
+    }
+  }
+
+  auto release(void* block) noexcept -> void {
+    if (block && argc::mem::headers_issued.load(std::memory_order_relaxed)) [[unlikely]] {
+      auto* header = argc::mem::header_of(block);
+      if (header->tag == argc::mem::tracked_tag) {
+        void* base = static_cast<char*>(block) - (std::size_t{1} << header->offset_log2);
+        if (argc::mem::tracking.load(std::memory_order_relaxed)) {
+          argc::mem::account(header->file, header->stage, static_cast<int64_t>(malloc_usable_size(base)), false);
+        }
+        header->tag = 0;
+        std::free(base);
+        return;
+      }
+    }
+    std::free(block);
+  }
+
+}
+
+auto operator new(const std::size_t size) -> void* {
+  return allocate(size, alignof(std::max_align_t));
+}
+
+auto operator new(const std::size_t size, const std::align_val_t align) -> void* {
+  return allocate(size, static_cast<std::size_t>(align));
+}
+
+auto operator delete(void* block) noexcept -> void {
+  release(block);
+}
+
+auto operator delete(void* block, std::align_val_t) noexcept -> void {
+  release(block);
+}
+
+auto operator delete(void* block, std::size_t) noexcept -> void {
+  release(block);
+}
+
+auto operator delete(void* block, std::size_t, std::align_val_t) noexcept -> void {
+  release(block);
+}
+
+#endif
@@ -0,0 +1,173 @@
+#include "ModulePipeline.hh"
+
+#include "Frontend.hh"
+#include "IRBuilder.hh"
+#include "ModuleScanner.hh"
+#include "SymbolCollector.hh"
+
+#include <algorithm>
+
+namespace argc {
+
+using namespace err;
+
+auto discover_modules(ErrorReporter& reporter, build::BuildScheduler& scheduler,
+                      const std::span<const SourceBuffer> sources) -> bool {
+  for (const auto& source : sources) {
+    auto unit = build::scan_module_header(source.path, source.text);
+    if (!unit) {
+      (void)reporter.report<ErrorCode::SyntaxError>(
+        CompileStage::Parsing,
+        ErrorSeverity::Fatal,
+        SourceLocation(source.path, 1, 1),
+        "expected a module declaration"
+      );
+      return false;
+    }
+
+    if (const auto nesting = build::paren_nesting(source.text); nesting.depth > build::max_paren_nesting) {
+      (void)reporter.report<ErrorCode::ResourceLimit>(
+        CompileStage::Parsing,
+        ErrorSeverity::Error,
+        SourceLocation(source.path, nesting.line, nesting.column),
+        "parentheses", nesting.depth, build::max_paren_nesting
+      );
+      return false;
+    }
+
+    if (!scheduler.add_module(std::move(*unit))) {
+      return false;     // Duplicate module name, already reported
+    }
+  }
+  return scheduler.resolve();
+}
+
+ModulePipeline::ModulePipeline(ErrorReporter& reporter, const build::BuildScheduler& scheduler,
+                               const std::span<SymbolTable> tables, const PipelineOptions options, PipelineHooks hooks)
+  : reporter_(reporter),
+    scheduler_(scheduler),
+    tables_(tables),
+    options_(options),
+    hooks_(std::move(hooks)),
+    outputs_(scheduler.modules().size())
+{}
+
+auto ModulePipeline::compile(Frontend& frontend, const size_t index, const std::string_view text) -> bool {
+  const auto& unit = scheduler_.modules()[index];
+  const auto enter = [&](const CompileStage stage) {
+    if (hooks_.stage) hooks_.stage(unit, stage);
+  };
+
+  // === LEXICAL ANALYSIS ===
+  enter(CompileStage::Lexing);
+  frontend.load(text, unit.path);
+  if (options_.lex_ahead) {
+    frontend.lex_all();       // Tokens are otherwise lexed on demand, and counted as parsing
+  }
+
+  // === PARSING ===
+  enter(CompileStage::Parsing);
+  if (hooks_.parsing) hooks_.parsing(frontend.parser());
+  auto* parse_tree = frontend.parse();
+  if (hooks_.parsed) hooks_.parsed(frontend.parser());
+  if (!parse_tree) {
+    return false;
+  }
+
+  // === SYMBOL COLLECTION ===
+  enter(CompileStage::SymbolCollection);
+  const auto& imports = scheduler_.dependencies(index);
+  tables_[index].reset();
+  SymbolCollector symbol_collector(
+    reporter_,
+    std::move(tables_[index]),
+    [&](const std::string& module_name) -> const SymbolTable* {
+      const auto dep = scheduler_.index_of(module_name);
+      if (!dep || std::find(imports.begin(), imports.end(), *dep) == imports.end()) {
+        return nullptr;
+      }
+      return &tables_[*dep];
+    },
+    unit.path
+  );
+  const auto collected = symbol_collector.collect(parse_tree);
+  tables_[index] = std::move(symbol_collector.getSymbolTable());
+  if (hooks_.collected) hooks_.collected(unit, tables_[index], static_cast<bool>(collected));
+  if (!collected) {
+    return false;
+  }
+
+  // === TYPE CHECKING ===
+  enter(CompileStage::TypeChecking);
+
+  // Common subexpressions are shared from -O2
+  const bool share_subexpressions = options_.optimisation >= ConfigHandler::OptimisationLevel::TWO;
+  IRBuilder ir_builder(reporter_, unit.path, share_subexpressions);
+  if (!ir_builder.build(parse_tree)) {
+    return false;
+  }
+  const auto& module = ir_builder.getModule();
+  if (hooks_.lowered) hooks_.lowered(unit, module);
+
+  sema::TypeChecker type_checker(reporter_, unit.path);
+  const auto checked = type_checker.check(module);
+  if (!checked) {
+    return false;
+  }
+  if (hooks_.checked) hooks_.checked(unit, *checked);
+
+  // === CODE GENERATION ===
+  enter(CompileStage::CodeGeneration);
+  auto& output = outputs_[index];
+  if (options_.emit == ConfigHandler::EmitKind::ASM) {
+    // Strength reduction of constant multiplies and divides, and register
+    // allocation, from -O1
+    const bool optimise = options_.optimisation != ConfigHandler::OptimisationLevel::ZERO;
+    codegen::X86Emitter emitter(optimise, optimise ? codegen::Allocation::Registers : codegen::Allocation::Stack);
+    output.code = emitter.emit_module(module, &*checked);
+    output.asm_stats = emitter.stats();
+  } else if (options_.emit == ConfigHandler::EmitKind::C) {
+    codegen::CEmitter emitter;
+    output.code = emitter.emit_module(module, &*checked);
+    output.c_stats = emitter.stats();
+  }
+  return true;
+}
+
+auto ModulePipeline::build_order() const -> std::vector<size_t> {
+  std::vector<size_t> order;
+  order.reserve(outputs_.size());
+  for (const auto& wave : scheduler_.stats().waves) {
+    order.insert(order.end(), wave.begin(), wave.end());
+  }
+  return order;
+}
+
+auto ModulePipeline::asm_totals() const -> codegen::EmitStats {
+  codegen::EmitStats totals;
+  for (const auto& output : outputs_) {
+    const auto& stats = output.asm_stats;
+    totals.instructions += stats.instructions;
+    totals.multiplies_reduced += stats.multiplies_reduced;
+    totals.divisions_reduced += stats.divisions_reduced;
+    totals.shared_values += stats.shared_values;
+    totals.register_values += stats.register_values;
+    totals.spills += stats.spills;
+    totals.callee_saved += stats.callee_saved;
+  }
+  return totals;
+}
+
+auto ModulePipeline::c_totals() const -> codegen::CEmitStats {
+  codegen::CEmitStats totals;
+  for (const auto& output : outputs_) {
+    const auto& stats = output.c_stats;
+    totals.operations += stats.operations;
+    totals.wrapping_operations += stats.wrapping_operations;
+    totals.temporaries += stats.temporaries;
+    totals.shared_values += stats.shared_values;
+  }
+  return totals;
+}
+
+}
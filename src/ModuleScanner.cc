@@ -0,0 +1,58 @@
+#include "ModuleScanner.hh"
+#include "ArgonLexer.h"
+
+namespace argc::build {
+
+auto scan_module_header(const std::string& path, const std::string_view source) -> std::optional<ModuleUnit> {
+  antlr4::ANTLRInputStream input(source);
+  ArgonLexer lexer(&input);
+
+  auto expect = [&lexer](const size_t type) -> std::unique_ptr<antlr4::Token> {
+    auto token = lexer.nextToken();
+    return token->getType() == type ? std::move(token) : nullptr;
+  };
+
+  auto keyword = lexer.nextToken();
+  if (keyword->getText() != "module") return std::nullopt;
+  const auto name = expect(ArgonLexer::IDENTIFIER);
+  if (!name || !expect(ArgonLexer::NEWLINE)) return std::nullopt;
+
+  ModuleUnit unit { path, name->getText(), {} };
+
+  // Imports must directly follow the module line; stop at the first statement
+  for (auto token = lexer.nextToken(); token->getText() == "import"; token = lexer.nextToken()) {
+    const auto imported = expect(ArgonLexer::IDENTIFIER);
+    if (!imported) break;
+    unit.imports.push_back(ImportRef {
+      imported->getText(),
+      static_cast<uint32_t>(imported->getLine()),
+      static_cast<uint32_t>(imported->getCharPositionInLine() + 1)
+    });
+    if (!expect(ArgonLexer::NEWLINE)) break;
+  }
+
+  return unit;
+}
+
+auto paren_nesting(const std::string_view source) -> Nesting {
+  Nesting deepest;
+  size_t depth = 0;
+  uint32_t line = 1;
+  uint32_t column = 1;
+  for (const char c : source) {
+    if (c == '(') {
+      if (++depth > deepest.depth) deepest = Nesting{ depth, line, column };
+    } else if (c == ')') {
+      if (depth > 0) --depth;
+    }
+    if (c == '\n') {
+      ++line;
+      column = 1;
+    } else {
+      ++column;
+    }
+  }
+  return deepest;
+}
+
+}
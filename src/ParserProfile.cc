@@ -0,0 +1,98 @@
+#include "ParserProfile.hh"
+
+#include <algorithm>
+#include <fmt/core.h>
+
+namespace argc {
+
+auto DecisionProfile::merge(const DecisionProfile& other) -> void {
+  invocations += other.invocations;
+  sll_lookahead += other.sll_lookahead;
+  sll_max_lookahead = std::max(sll_max_lookahead, other.sll_max_lookahead);
+  ll_fallbacks += other.ll_fallbacks;
+  ll_lookahead += other.ll_lookahead;
+  ll_max_lookahead = std::max(ll_max_lookahead, other.ll_max_lookahead);
+  ambiguities += other.ambiguities;
+  context_sensitivities += other.context_sensitivities;
+  errors += other.errors;
+  atn_transitions += other.atn_transitions;
+  time_ns += other.time_ns;
+}
+
+auto ParserProfile::record(const std::vector<DecisionProfile>& decisions) -> void {
+  std::lock_guard lock(mutex_);
+  for (const auto& d : decisions) {
+    if (decisions_.size() <= d.decision) decisions_.resize(d.decision + 1);
+    auto& slot = decisions_[d.decision];
+    if (slot.rule.empty()) {
+      slot.decision = d.decision;
+      slot.rule = d.rule;
+    }
+    slot.merge(d);
+  }
+  ++parses_;
+}
+
+auto ParserProfile::ranked() const -> std::vector<DecisionProfile> {
+  std::vector<DecisionProfile> result;
+  {
+    std::lock_guard lock(mutex_);
+    std::copy_if(decisions_.begin(), decisions_.end(), std::back_inserter(result),
+                 [](const DecisionProfile& d) { return d.invocations > 0; });
+  }
+  // Time first; fallbacks and lookahead break ties between decisions too
+  // cheap to separate on the clock
+  std::sort(result.begin(), result.end(), [](const DecisionProfile& a, const DecisionProfile& b) {
+    if (a.time_ns != b.time_ns) return a.time_ns > b.time_ns;
+    if (a.ll_fallbacks != b.ll_fallbacks) return a.ll_fallbacks > b.ll_fallbacks;
+    if (a.sll_lookahead + a.ll_lookahead != b.sll_lookahead + b.ll_lookahead) {
+      return a.sll_lookahead + a.ll_lookahead > b.sll_lookahead + b.ll_lookahead;
+    }
+    return a.decision < b.decision;
+  });
+  return result;
+}
+
+auto ParserProfile::parses() const -> size_t {
+  std::lock_guard lock(mutex_);
+  return parses_;
+}
+
+auto ParserProfile::write_text(std::FILE* out) const -> void {
+  const auto decisions = ranked();
+  uint64_t total_ns = 0;
+  for (const auto& d : decisions) total_ns += d.time_ns;
+
+  fmt::print(out, "Parser profile: {} parse(s), {} decision(s) predicted, {:.3f} ms in prediction\n",
+             parses(), decisions.size(), static_cast<double>(total_ns) / 1e6);
+  fmt::print(out, "  {:>8}  {:<20} {:>11} {:>9} {:>9} {:>9} {:>7} {:>7} {:>10} {:>7}\n",
+             "decision", "rule", "invocations", "fallback", "mean-look", "max-look", "ambig", "errors", "time-ms", "share");
+  for (const auto& d : decisions) {
+    fmt::print(out, "  {:>8}  {:<20} {:>11} {:>9} {:>9.2f} {:>9} {:>7} {:>7} {:>10.3f} {:>6.1f}%\n",
+               d.decision, d.rule, d.invocations, d.ll_fallbacks, d.mean_lookahead(),
+               std::max(d.sll_max_lookahead, d.ll_max_lookahead), d.ambiguities, d.errors,
+               static_cast<double>(d.time_ns) / 1e6,
+               total_ns ? 100.0 * static_cast<double>(d.time_ns) / static_cast<double>(total_ns) : 0.0);
+  }
+}
+
+// Rule names are grammar identifiers, so nothing in the output needs escaping
+auto ParserProfile::write_json(std::FILE* out) const -> void {
+  const auto decisions = ranked();
+  fmt::print(out, "{{\n  \"parses\": {},\n  \"decisions\": [", parses());
+  for (size_t i = 0; i < decisions.size(); ++i) {
+    const auto& d = decisions[i];
+    fmt::print(out,
+      "{}\n    {{\"decision\": {}, \"rule\": \"{}\", \"invocations\": {}, "
+      "\"sll_lookahead\": {}, \"sll_max_lookahead\": {}, \"ll_fallbacks\": {}, "
+      "\"ll_lookahead\": {}, \"ll_max_lookahead\": {}, \"ambiguities\": {}, "
+      "\"context_sensitivities\": {}, \"errors\": {}, \"atn_transitions\": {}, \"time_ns\": {}}}",
+      i ? "," : "", d.decision, d.rule, d.invocations,
+      d.sll_lookahead, d.sll_max_lookahead, d.ll_fallbacks,
+      d.ll_lookahead, d.ll_max_lookahead, d.ambiguities,
+      d.context_sensitivities, d.errors, d.atn_transitions, d.time_ns);
+  }
+  fmt::print(out, "{}]\n}}\n", decisions.empty() ? "" : "\n  ");
+}
+
+}
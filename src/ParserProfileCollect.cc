@@ -0,0 +1,38 @@
+#include "ParserProfile.hh"
+
+#include "antlr4-runtime.h"
+
+namespace argc {
+
+// Kept apart from the aggregation so that part builds without the runtime
+auto ParserProfile::record(const antlr4::Parser& parser) -> void {
+  const auto* simulator = parser.getInterpreter<antlr4::atn::ProfilingATNSimulator>();
+  if (!simulator) return;
+
+  const auto& atn = parser.getATN();
+  const auto& rule_names = parser.getRuleNames();
+
+  std::vector<DecisionProfile> decisions;
+  for (const auto& info : simulator->getDecisionInfo()) {
+    if (info.invocations == 0) continue;
+
+    DecisionProfile d;
+    d.decision = info.decision;
+    d.rule = rule_names[atn.decisionToState[info.decision]->ruleIndex];
+    d.invocations = static_cast<uint64_t>(info.invocations);
+    d.sll_lookahead = static_cast<uint64_t>(info.SLL_TotalLook);
+    d.sll_max_lookahead = static_cast<uint64_t>(info.SLL_MaxLook);
+    d.ll_fallbacks = static_cast<uint64_t>(info.LL_Fallback);
+    d.ll_lookahead = static_cast<uint64_t>(info.LL_TotalLook);
+    d.ll_max_lookahead = static_cast<uint64_t>(info.LL_MaxLook);
+    d.ambiguities = info.ambiguities.size();
+    d.context_sensitivities = info.contextSensitivities.size();
+    d.errors = info.errors.size();
+    d.atn_transitions = static_cast<uint64_t>(info.SLL_ATNTransitions + info.LL_ATNTransitions);
+    d.time_ns = static_cast<uint64_t>(info.timeInPrediction);
+    decisions.push_back(std::move(d));
+  }
+  record(decisions);
+}
+
+}
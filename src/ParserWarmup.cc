@@ -0,0 +1,17 @@
+#include "ParserWarmup.hh"
+
+#include "ArgonLexer.h"
+#include "ArgonParser.h"
+
+namespace argc {
+
+ParserWarmup::ParserWarmup(TimeReport& report)
+  : thread_([&report] {
+      ArgonLexer::initialize();
+      ArgonParser::initialize();
+      report.mark("parser tables ready");
+    })
+{
+}
+
+}
@@ -0,0 +1,215 @@
+#include "StrengthReduction.hh"
+
+#include <array>
+#include <bit>
+#include <deque>
+#include <unordered_map>
+
+namespace argc::codegen {
+
+namespace {
+
+  // Candidate steps and their effect on the multiplier, all mod 2^32
+  struct Candidate {
+    MulStep step;
+    auto apply(const uint32_t m) const -> uint32_t {
+      switch (step.op) {
+        case MulStep::Op::Zero:      return 0;
+        case MulStep::Op::Shl:       return m << step.amount;
+        case MulStep::Op::LeaSelf:   return m * step.amount;
+        case MulStep::Op::LeaSrc:    return 1u + m * step.amount;
+        case MulStep::Op::LeaAddSrc: return m + step.amount;
+        case MulStep::Op::AddSrc:    return m + 1u;
+        case MulStep::Op::SubSrc:    return m - 1u;
+        case MulStep::Op::Neg:       return 0u - m;
+      }
+      return m;
+    }
+  };
+
+  auto candidates() -> const std::vector<Candidate>& {
+    static const std::vector<Candidate> all = [] {
+      std::vector<Candidate> c;
+      for (uint8_t k = 1; k < 32; ++k) c.push_back({{MulStep::Op::Shl, k}});
+      for (const uint8_t s : {3, 5, 9}) c.push_back({{MulStep::Op::LeaSelf, s}});
+      for (const uint8_t s : {2, 4, 8}) c.push_back({{MulStep::Op::LeaSrc, s}});
+      for (const uint8_t s : {2, 4, 8}) c.push_back({{MulStep::Op::LeaAddSrc, s}});
+      c.push_back({{MulStep::Op::AddSrc, 0}});
+      c.push_back({{MulStep::Op::SubSrc, 0}});
+      c.push_back({{MulStep::Op::Neg, 0}});
+      return c;
+    }();
+    return all;
+  }
+
+  auto reads_src(const MulStep::Op op) -> bool {
+    return op == MulStep::Op::LeaSrc || op == MulStep::Op::LeaAddSrc ||
+           op == MulStep::Op::AddSrc || op == MulStep::Op::SubSrc;
+  }
+
+}
+
+auto signed_magic(const int32_t d) -> SignedMagic {
+  constexpr uint32_t two31 = 0x80000000u;
+
+  const uint32_t ad = d < 0 ? 0u - static_cast<uint32_t>(d) : static_cast<uint32_t>(d);
+  const uint32_t t = two31 + (static_cast<uint32_t>(d) >> 31);
+  const uint32_t anc = t - 1 - t % ad;    // |nc|
+  int p = 31;
+  uint32_t q1 = two31 / anc;              // 2^p / |nc|
+  uint32_t r1 = two31 - q1 * anc;         // rem(2^p, |nc|)
+  uint32_t q2 = two31 / ad;               // 2^p / |d|
+  uint32_t r2 = two31 - q2 * ad;          // rem(2^p, |d|)
+  uint32_t delta = 0;
+
+  do {
+    ++p;
+    q1 *= 2;
+    r1 *= 2;
+    if (r1 >= anc) {
+      ++q1;
+      r1 -= anc;
+    }
+    q2 *= 2;
+    r2 *= 2;
+    if (r2 >= ad) {
+      ++q2;
+      r2 -= ad;
+    }
+    delta = ad - r2;
+  } while (q1 < delta || (q1 == delta && r1 == 0));
+
+  uint32_t m = q2 + 1;
+  if (d < 0) m = 0u - m;
+  return { static_cast<int32_t>(m), static_cast<uint8_t>(p - 32) };
+}
+
+auto plan_multiplication(const int32_t c, const size_t max_steps) -> MulRecipe {
+  MulRecipe recipe;
+  recipe.multiplier = c;
+  const auto target = static_cast<uint32_t>(c);
+
+  if (target == 1) return recipe;
+  if (target == 0) {
+    recipe.steps.push_back({MulStep::Op::Zero, 0});
+    return recipe;
+  }
+
+  // Breadth-first over reachable multipliers; the first hit is the shortest sequence
+  struct Visit { uint32_t parent; MulStep step; };
+  std::unordered_map<uint32_t, Visit> seen { {1u, {1u, {MulStep::Op::Zero, 0}}} };
+  std::deque<std::pair<uint32_t, size_t>> queue { {1u, 0} };
+
+  while (!queue.empty()) {
+    const auto [m, depth] = queue.front();
+    queue.pop_front();
+    if (depth == max_steps) continue;
+
+    for (const auto& candidate : candidates()) {
+      const uint32_t next = candidate.apply(m);
+      if (seen.contains(next)) continue;
+      seen.emplace(next, Visit{m, candidate.step});
+
+      if (next == target) {
+        for (uint32_t at = next; at != 1u; at = seen.at(at).parent) {
+          recipe.steps.insert(recipe.steps.begin(), seen.at(at).step);
+        }
+        for (const auto& step : recipe.steps) recipe.needs_src |= reads_src(step.op);
+        return recipe;
+      }
+      queue.emplace_back(next, depth + 1);
+    }
+  }
+
+  recipe.use_imul = true;
+  return recipe;
+}
+
+auto plan_signed_division(const int32_t d, const bool nonnegative_dividend) -> DivisionPlan {
+  DivisionPlan plan;
+  plan.divisor = d;
+  plan.nonnegative_dividend = nonnegative_dividend;
+
+  if (d == 0) return plan;
+  if (d == 1) {
+    plan.kind = DivisionPlan::Kind::Identity;
+    return plan;
+  }
+  if (d == -1) {
+    plan.kind = DivisionPlan::Kind::Negate;
+    return plan;
+  }
+
+  const uint32_t ad = d < 0 ? 0u - static_cast<uint32_t>(d) : static_cast<uint32_t>(d);
+  if (std::has_single_bit(ad)) {
+    plan.kind = DivisionPlan::Kind::PowerOfTwo;
+    plan.shift = static_cast<uint8_t>(std::countr_zero(ad));
+    plan.negate = d < 0;
+    return plan;
+  }
+
+  const auto [multiplier, shift] = signed_magic(d);
+  plan.kind = DivisionPlan::Kind::Magic;
+  plan.multiplier = multiplier;
+  plan.shift = shift;
+  plan.add_dividend = d > 0 && multiplier < 0;
+  plan.sub_dividend = d < 0 && multiplier > 0;
+  return plan;
+}
+
+auto evaluate(const MulRecipe& recipe, const int32_t x) -> int32_t {
+  const auto src = static_cast<uint32_t>(x);
+  if (recipe.use_imul) return static_cast<int32_t>(src * static_cast<uint32_t>(recipe.multiplier));
+
+  uint32_t acc = src;
+  for (const auto& step : recipe.steps) {
+    switch (step.op) {
+      case MulStep::Op::Zero:      acc = 0; break;
+      case MulStep::Op::Shl:       acc <<= step.amount; break;
+      case MulStep::Op::LeaSelf:   acc = acc + acc * (step.amount - 1u); break;
+      case MulStep::Op::LeaSrc:    acc = src + acc * step.amount; break;
+      case MulStep::Op::LeaAddSrc: acc = acc + src * step.amount; break;
+      case MulStep::Op::AddSrc:    acc += src; break;
+      case MulStep::Op::SubSrc:    acc -= src; break;
+      case MulStep::Op::Neg:       acc = 0u - acc; break;
+    }
+  }
+  return static_cast<int32_t>(acc);
+}
+
+auto evaluate(const DivisionPlan& plan, const int32_t n) -> int32_t {
+  const auto un = static_cast<uint32_t>(n);
+
+  switch (plan.kind) {
+    case DivisionPlan::Kind::Hardware:
+      // Mirrors idiv for the cases that do not trap
+      return static_cast<int32_t>(static_cast<uint32_t>(static_cast<int64_t>(n) / plan.divisor));
+
+    case DivisionPlan::Kind::Identity:
+      return n;
+
+    case DivisionPlan::Kind::Negate:
+      return static_cast<int32_t>(0u - un);
+
+    case DivisionPlan::Kind::PowerOfTwo: {
+      // bias = (n >> 31) >>> (32 - k): 2^k - 1 for negative n, else 0
+      const uint32_t sign = plan.nonnegative_dividend ? 0u : static_cast<uint32_t>(n >> 31);
+      const uint32_t bias = sign >> (32 - plan.shift);
+      const int32_t q = static_cast<int32_t>(un + bias) >> plan.shift;
+      return plan.negate ? static_cast<int32_t>(0u - static_cast<uint32_t>(q)) : q;
+    }
+
+    case DivisionPlan::Kind::Magic: {
+      const int64_t product = static_cast<int64_t>(n) * plan.multiplier;
+      uint32_t q = static_cast<uint32_t>(product >> 32);
+      if (plan.add_dividend) q += un;
+      if (plan.sub_dividend) q -= un;
+      const int32_t shifted = static_cast<int32_t>(q) >> plan.shift;
+      if (plan.nonnegative_dividend && plan.divisor > 0) return shifted;     // Quotient cannot be negative
+      return static_cast<int32_t>(static_cast<uint32_t>(shifted) + (static_cast<uint32_t>(shifted) >> 31));
+    }
+  }
+  return 0;
+}
+
+}
@@ -1,5 +1,6 @@
 #include "SymbolCollector.hh"
 #include "SourceLocation.hh"
+#include "ExpressionWalk.hh"
 #include <fmt/core.h>
 #include <string>
 #include <any>
@@ -8,87 +9,100 @@ using namespace argc;
 using namespace err;
 
 
+auto SymbolCollector::collect(ArgonParser::ModuleDeclarationContext *ctx) -> Status {
+    status_ = {};
+    visitModuleDeclaration(ctx);
+    return status_;
+}
+
 std::any SymbolCollector::visitModuleDeclaration(ArgonParser::ModuleDeclarationContext *ctx) {
     std::string module_name{ctx->IDENTIFIER()->getText()};
 
-    auto module_type = std::make_shared<ModuleType>("module");
+    const auto* module_type = symbol_table_.make_type<ModuleType>("module");
+
+    auto* module_entry = symbol_table_.make_symbol(
+        module_name,
+        SymbolKind::MODULE,
+        module_type,
+        loc::SourceLocation(0, 0, "") // TODO: Extract location from context
+        );
+
+    if (!symbol_table_.insert(module_entry)) {
+        // Module already declared
+        fmt::print("Module '{}' already declared", module_name);
+    } else {
+        // Mark as defined since we have the declaration
+        module_entry->set_defined(true);
+    }
 
-    try {
-        auto module_entry = std::make_shared<SymbolEntry>(
-            module_name,
-            SymbolKind::MODULE,
-            module_type,
-            0,
-            loc::SourceLocation(0, 0, "") // TODO: Extract location from context
-            );
+    symbol_table_.enter_scope(module_name);
 
-        if (!symbol_table_.insert(module_entry)) {
-            // Module already declared
-            loc::SourceLocation loc(0, 0, "");
-            //error_reporter_.reportQuick(
-            //    ErrorCode::InvalidOperation,
-            //    CompileStage::SymbolCollection,
-            //    ErrorSeverity::Error,
-            //    loc,
-            //    "Module '" + module_name + "' already declared"
-            //    );
-            fmt::print("Module '{}' already declared", module_name);
-        } else {
-            // Mark as defined since we have the declaration
-            module_entry->set_defined(true);
-        }
-
-        symbol_table_.enter_scope(module_name);
-
-        visitChildren(ctx);
-
-        symbol_table_.exit_scope();
-
-    } catch (const std::runtime_error& e) {
-        //loc::SourceLocation loc(0, 0, "");
-        //error_reporter_.reportQuick(
-        //    ErrorCode::InvalidOperation,
-        //    CompileStage::SymbolCollection,
-        //    ErrorSeverity::Fatal,
-        //    loc,
-        //    ""
-        //    );
-        fmt::print("Error: {}", e.what());
+    // A failure ends the traversal at the next declaration or statement
+    for (auto *import : ctx->importDeclaration()) {
+        if (!status_) break;
+        visit(import);
+    }
+    for (auto *stmt : ctx->statement()) {
+        if (!status_) break;
+        visit(stmt);
     }
 
+    symbol_table_.exit_scope();
+
     return nullptr;
 }
 
-std::any SymbolCollector::visitExpressionStmt(ArgonParser::ExpressionStmtContext *ctx){
-    return visit(ctx->expression());
-}
+std::any SymbolCollector::visitImportDeclaration(ArgonParser::ImportDeclarationContext *ctx) {
+    const auto token = ctx->IDENTIFIER()->getSymbol();
+    const std::string module_name{token->getText()};
+    const SourceLocation loc(source_file_,
+                             static_cast<uint32_t>(token->getLine()),
+                             static_cast<uint32_t>(token->getCharPositionInLine() + 1));
+
+    const SymbolTable* imported = import_resolver_ ? import_resolver_(module_name) : nullptr;
+    if (!imported) {
+        status_ = error_reporter_.report<ErrorCode::UnresolvedImport>(
+            CompileStage::SymbolCollection,
+            ErrorSeverity::Error,
+            loc,
+            module_name
+            );
+        return nullptr;
+    }
 
-std::any SymbolCollector::visitReturnStmt(ArgonParser::ReturnStmtContext *ctx){
-    return visit(ctx->expression());
-}
+    if (!symbol_table_.import_module(module_name, *imported)) {
+        status_ = error_reporter_.report<ErrorCode::DuplicateImport>(
+            CompileStage::SymbolCollection,
+            ErrorSeverity::Warning,
+            loc,
+            module_name
+            );
+    }
 
-std::any SymbolCollector::visitAddSubExpr(ArgonParser::AddSubExprContext *ctx){
-    visit(ctx->expression(0));
-    visit(ctx->expression(1));
     return nullptr;
 }
 
-std::any SymbolCollector::visitMulDivExpr(ArgonParser::MulDivExprContext *ctx) {
-    visit(ctx->expression(0));
-    visit(ctx->expression(1));
+std::any SymbolCollector::visitExpressionStmt(ArgonParser::ExpressionStmtContext *ctx){
+    collect_expression(ctx->expression());
     return nullptr;
 }
 
-std::any SymbolCollector::visitAtomExpr(ArgonParser::AtomExprContext *ctx) {
-    return visit(ctx->atom());
+std::any SymbolCollector::visitReturnStmt(ArgonParser::ReturnStmtContext *ctx){
+    collect_expression(ctx->expression());
+    return nullptr;
 }
 
 std::any SymbolCollector::visitIntAtom(ArgonParser::IntAtomContext *ctx) {
     return nullptr;
 }
 
-std::any SymbolCollector::visitParenExpr(ArgonParser::ParenExprContext *ctx){
-    return visit(ctx->expression());
+auto SymbolCollector::collect_expression(ArgonParser::ExpressionContext *expr) -> void {
+    walk_expression(
+        expr,
+        [](char, antlr4::ParserRuleContext *) {},
+        [this](ArgonParser::IntAtomContext *literal) {
+            if (literal) visitIntAtom(literal);
+        });
 }
 
 std::any SymbolCollector::visitIdentifier(ArgonParser::AtomContext *ctx) {
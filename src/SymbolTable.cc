@@ -1,16 +1,43 @@
 #include "SymbolTable.hh"
 
-#include "SymbolTable.hh"
-
 namespace argc {
 
-auto StructType::add_field(const std::string& name, std::shared_ptr<Type> type) -> void {
-  fields_.emplace(name, std::move(type));
+auto StructType::add_field(const std::string& name, const Type* type, const bool hot) -> bool {
+  if (field_index(name)) return false;
+  fields_.push_back(StructField{ name, type, hot });
+  if (fields_.size() * 2 > index_.size()) {
+    rehash();
+  } else {
+    const size_t mask = index_.size() - 1;
+    size_t i = std::hash<std::string_view>{}(name) & mask;
+    while (index_[i] != empty_slot) i = (i + 1) & mask;
+    index_[i] = static_cast<uint32_t>(fields_.size() - 1);
+  }
+  return true;
+}
+
+auto StructType::get_field(const std::string_view name) const -> const Type* {
+  const auto index = field_index(name);
+  return index ? fields_[*index].type : nullptr;
+}
+
+auto StructType::field_index(const std::string_view name) const -> std::optional<size_t> {
+  if (index_.empty()) return std::nullopt;
+  const size_t mask = index_.size() - 1;
+  for (size_t i = std::hash<std::string_view>{}(name) & mask; index_[i] != empty_slot; i = (i + 1) & mask) {
+    if (fields_[index_[i]].name == name) return index_[i];
+  }
+  return std::nullopt;
 }
 
-auto StructType::get_field(const std::string& name) const -> std::shared_ptr<Type> {
-  const auto it = fields_.find(name);
-  return it != fields_.end() ? it->second : nullptr;
+auto StructType::rehash() -> void {
+  index_.assign(index_.empty() ? 8 : index_.size() * 2, empty_slot);
+  const size_t mask = index_.size() - 1;
+  for (uint32_t f = 0; f < fields_.size(); ++f) {
+    size_t i = std::hash<std::string_view>{}(fields_[f].name) & mask;
+    while (index_[i] != empty_slot) i = (i + 1) & mask;
+    index_[i] = f;
+  }
 }
 
 }  // namespace argc
\ No newline at end of file
@@ -0,0 +1,47 @@
+#include "TimeReport.hh"
+
+#include <algorithm>
+#include <fmt/core.h>
+
+namespace argc {
+
+namespace {
+
+  const auto process_start = std::chrono::steady_clock::now();
+
+}
+
+TimeReport::~TimeReport() {
+  if (enabled_) print(stderr);
+}
+
+auto TimeReport::since_start() -> Clock::duration {
+  return Clock::now() - process_start;
+}
+
+auto TimeReport::mark(const std::string_view label) -> void {
+  const auto at = since_start();
+  std::lock_guard lock(mutex_);
+  if (std::none_of(marks_.begin(), marks_.end(), [&](const Mark& m) { return m.label == label; })) {
+    marks_.push_back(Mark{ label, at });
+  }
+}
+
+auto TimeReport::print(std::FILE* out) const -> void {
+  const auto to_ms = [](const Clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+  const auto total = since_start();
+
+  std::lock_guard lock(mutex_);
+  auto marks = marks_;
+  std::sort(marks.begin(), marks.end(), [](const Mark& a, const Mark& b) { return a.at < b.at; });
+
+  fmt::print(out, "Time report (ms since process start):\n");
+  for (const auto& [label, at] : marks) {
+    fmt::print(out, "  {:<22} {:>9.3f}\n", label, to_ms(at));
+  }
+  fmt::print(out, "  {:<22} {:>9.3f}\n", "total", to_ms(total));
+}
+
+}
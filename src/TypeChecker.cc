@@ -0,0 +1,137 @@
+#include "TypeChecker.hh"
+
+#include <algorithm>
+#include <limits>
+
+namespace argc::sema {
+
+using namespace err;
+
+namespace {
+
+  constexpr int64_t i8_min = std::numeric_limits<int8_t>::min();
+  constexpr int64_t i8_max = std::numeric_limits<int8_t>::max();
+  constexpr int64_t i16_min = std::numeric_limits<int16_t>::min();
+  constexpr int64_t i16_max = std::numeric_limits<int16_t>::max();
+  constexpr int64_t i32_min = std::numeric_limits<int32_t>::min();
+  constexpr int64_t i32_max = std::numeric_limits<int32_t>::max();
+
+  constexpr ValueRange full_i32 { i32_min, i32_max };
+
+  // Operands are within i32, so every corner product fits in int64
+  auto exact_range(const ir::Op op, const ValueRange& a, const ValueRange& b) -> ValueRange {
+    switch (op) {
+      case ir::Op::Add: return { a.lo + b.lo, a.hi + b.hi };
+      case ir::Op::Sub: return { a.lo - b.hi, a.hi - b.lo };
+      case ir::Op::Mul: {
+        const std::array corners { a.lo * b.lo, a.lo * b.hi, a.hi * b.lo, a.hi * b.hi };
+        return { *std::min_element(corners.begin(), corners.end()), *std::max_element(corners.begin(), corners.end()) };
+      }
+      case ir::Op::Div: {
+        // Caller guarantees 0 is not in b. Truncating division is monotonic
+        // in each argument on either side of zero, so corners bound it.
+        const std::array corners { a.lo / b.lo, a.lo / b.hi, a.hi / b.lo, a.hi / b.hi };
+        return { *std::min_element(corners.begin(), corners.end()), *std::max_element(corners.begin(), corners.end()) };
+      }
+      case ir::Op::Const: break;
+    }
+    return full_i32;
+  }
+
+  auto wrap_i32(const int64_t v) -> int64_t {
+    return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint64_t>(v)));
+  }
+
+  constexpr auto op_symbol(const ir::Op op) -> std::string_view {
+    switch (op) {
+      case ir::Op::Add: return "+";
+      case ir::Op::Sub: return "-";
+      case ir::Op::Mul: return "*";
+      case ir::Op::Div: return "/";
+      case ir::Op::Const: break;
+    }
+    return "?";
+  }
+
+}
+
+auto narrowest_type(const ValueRange range) -> IntType {
+  if (range.lo >= i8_min && range.hi <= i8_max) return IntType::I8;
+  if (range.lo >= i16_min && range.hi <= i16_max) return IntType::I16;
+  return IntType::I32;
+}
+
+auto TypeChecker::check(const ir::Module& module) -> Expected<TypeInfo> {
+  TypeInfo info;
+  const size_t n = module.exprs.size();
+  info.types.resize(n, IntType::I32);
+  info.ranges.resize(n, full_i32);
+  info.wrapping.resize(n, false);
+
+  for (const auto& stmt : module.statements) {
+    if (auto status = check_statement(module.exprs, stmt, info); !status) {
+      return std::unexpected(status.error());
+    }
+  }
+
+  info.stats.nodes = n;
+  for (const auto type : info.types) {
+    ++info.stats.by_type[static_cast<size_t>(type)];
+  }
+  return info;
+}
+
+// Nodes [first, root] are in post-order, so operands are always done first
+auto TypeChecker::check_statement(const ir::ExprPool& exprs, const ir::Statement& stmt, TypeInfo& info) -> Status {
+  const auto& nodes = exprs.nodes();
+  const SourceLocation loc(source_file_, stmt.line, 1);
+
+  for (ir::NodeId id = stmt.first; id <= stmt.root; ++id) {
+    const auto& node = nodes[id];
+    ValueRange range;
+
+    if (node.op == ir::Op::Const) {
+      range = { node.value, node.value };
+    } else {
+      const auto& lhs = info.ranges[node.lhs];
+      const auto& rhs = info.ranges[node.rhs];
+
+      if (node.op == ir::Op::Div && rhs.lo <= 0 && rhs.hi >= 0) {
+        if (rhs.is_constant()) {
+          if (auto status = error_reporter_.report<ErrorCode::InvalidOperation>(
+                CompileStage::TypeChecking,
+                ErrorSeverity::Error,
+                loc,
+                "division by zero"
+              ); !status) {
+            return status;
+          }
+        }
+        range = full_i32;
+      } else {
+        range = exact_range(node.op, lhs, rhs);
+        if (range.lo < i32_min || range.hi > i32_max) {
+          ++info.stats.overflows;
+          info.wrapping[id] = true;
+          if (auto status = error_reporter_.report<ErrorCode::IntegerOverflow>(
+                CompileStage::TypeChecking,
+                ErrorSeverity::Warning,
+                loc,
+                op_symbol(node.op),
+                type_name(IntType::I32)
+              ); !status) {
+            return status;
+          }
+          // A single wrapped value is still known exactly; a wrapped interval is not
+          range = range.is_constant() ? ValueRange{ wrap_i32(range.lo), wrap_i32(range.lo) } : full_i32;
+        }
+      }
+    }
+
+    info.ranges[id] = range;
+    info.types[id] = narrowest_type(range);
+  }
+  return {};
+}
+
+}
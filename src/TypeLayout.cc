@@ -0,0 +1,167 @@
+#include "TypeLayout.hh"
+
+#include <algorithm>
+#include <string_view>
+
+namespace argc::layout {
+
+namespace {
+
+  auto align_up(const uint64_t value, const uint64_t align) -> uint64_t {
+    return (value + align - 1) / align * align;
+  }
+
+  auto scalar(const uint64_t size, const uint32_t align) -> Layout {
+    Layout layout;
+    layout.size = size;
+    layout.align = align;
+    return layout;
+  }
+
+  // End of the last hot field, 0 if there are none
+  auto hot_end(const StructType& type, const Layout& layout) -> uint64_t {
+    uint64_t end = 0;
+    for (const auto& f : layout.fields) {
+      if (type.fields()[f.field].hot) end = std::max(end, f.offset + f.size);
+    }
+    return end;
+  }
+
+}
+
+auto TargetLayout::for_arch(const ConfigHandler::TargetArch arch) -> TargetLayout {
+  switch (arch) {
+    case ConfigHandler::TargetArch::ARM: return TargetLayout{ 4, 8, 32 };
+    default:                             return TargetLayout{ 8, 8, 64 };
+  }
+}
+
+auto LayoutEngine::for_config(const ConfigHandler& config) -> LayoutEngine {
+  return LayoutEngine(TargetLayout::for_arch(config.getTargetArch()),
+                      config.getOptimisationLevel() >= ConfigHandler::OptimisationLevel::TWO);
+}
+
+auto LayoutEngine::layout(const Type& type) -> const Layout* {
+  if (const auto it = cache_.find(&type); it != cache_.end()) {
+    return it->second ? &*it->second : nullptr;
+  }
+  cache_.emplace(&type, std::nullopt);      // Marks a struct being laid out, to catch it containing itself
+  auto computed = compute(type);
+  auto& slot = cache_[&type];
+  slot = std::move(computed);
+  return slot ? &*slot : nullptr;
+}
+
+auto LayoutEngine::compute(const Type& type) -> std::optional<Layout> {
+  switch (type.kind()) {
+    case TypeKind::PRIMITIVE:
+      return primitive(type);
+    case TypeKind::FUNCTION:
+      return scalar(target_.pointer_size, target_.pointer_size);
+    case TypeKind::ARRAY: {
+      const auto& array = static_cast<const ArrayType&>(type);
+      const auto* element = layout(*array.element_type());
+      if (!element || array.size() < 0) return std::nullopt;
+      const auto count = static_cast<uint64_t>(array.size());
+      Layout result = scalar(element->size * count, element->align);
+      result.stride = element->size;
+      result.padding = element->padding * count;
+      return result;
+    }
+    case TypeKind::STRUCT:
+      return structure(static_cast<const StructType&>(type));
+    case TypeKind::MODULE:
+      break;
+  }
+  return std::nullopt;
+}
+
+auto LayoutEngine::primitive(const Type& type) const -> std::optional<Layout> {
+  const std::string_view name = type.name();
+  if (name == "bool" || name == "i8" || name == "u8") return scalar(1, 1);
+  if (name == "i16" || name == "u16") return scalar(2, 2);
+  if (name == "i32" || name == "u32" || name == "f32" || name == "int") return scalar(4, 4);
+  if (name == "i64" || name == "u64" || name == "f64") return scalar(8, target_.i64_align);
+  if (name == "ptr" || name == "usize" || name == "isize") return scalar(target_.pointer_size, target_.pointer_size);
+  return std::nullopt;
+}
+
+auto LayoutEngine::structure(const StructType& type) -> std::optional<Layout> {
+  const auto& fields = type.fields();
+  std::vector<const Layout*> field_layouts;
+  field_layouts.reserve(fields.size());
+  uint64_t occupied = 0;
+  for (const auto& field : fields) {
+    const auto* l = layout(*field.type);
+    if (!l) return std::nullopt;
+    field_layouts.push_back(l);
+    occupied += l->size;
+  }
+
+  const auto place = [&](const std::vector<uint32_t>& order) {
+    Layout result;
+    uint64_t offset = 0;
+    for (const auto f : order) {
+      const auto& l = *field_layouts[f];
+      offset = align_up(offset, l.align);
+      result.fields.push_back(FieldLayout{ f, offset, l.size });
+      offset += l.size;
+      result.align = std::max(result.align, l.align);
+    }
+    result.size = align_up(offset, result.align);
+    result.padding = result.size - occupied;
+    return result;
+  };
+
+  std::vector<uint32_t> declared(fields.size());
+  for (uint32_t f = 0; f < fields.size(); ++f) declared[f] = f;
+  auto result = place(declared);
+  ++stats_.structs;
+
+  if (!reorder_fields_ || type.layout_policy() != LayoutPolicy::Reorder || fields.size() < 2) {
+    return result;
+  }
+
+  // Within each group, take the field with the largest alignment that fits
+  // the current offset without padding; if none fits, the largest alignment
+  // overall. Hot fields go first, so they start at offset 0.
+  std::vector<uint32_t> order;
+  uint64_t offset = 0;
+  for (const bool hot : { true, false }) {
+    std::vector<uint32_t> group;
+    for (uint32_t f = 0; f < fields.size(); ++f) {
+      if (fields[f].hot == hot) group.push_back(f);
+    }
+    std::stable_sort(group.begin(), group.end(), [&](const uint32_t a, const uint32_t b) {
+      const auto& la = *field_layouts[a];
+      const auto& lb = *field_layouts[b];
+      return la.align != lb.align ? la.align > lb.align : la.size > lb.size;
+    });
+    while (!group.empty()) {
+      auto pick = std::find_if(group.begin(), group.end(),
+                               [&](const uint32_t f) { return offset % field_layouts[f]->align == 0; });
+      if (pick == group.end()) pick = group.begin();
+      const auto& l = *field_layouts[*pick];
+      offset = align_up(offset, l.align) + l.size;
+      order.push_back(*pick);
+      group.erase(pick);
+    }
+  }
+
+  auto reordered = place(order);
+  reordered.reordered = order != declared;
+  if (!reordered.reordered) return result;
+
+  // Worth it if the struct shrinks, or if the hot fields now fit in the
+  // first cache line and did not before
+  const bool smaller = reordered.size < result.size;
+  const bool hot_fits = hot_end(type, reordered) <= target_.cache_line &&
+                        hot_end(type, result) > target_.cache_line;
+  if (!smaller && !hot_fits) return result;
+
+  ++stats_.structs_reordered;
+  if (smaller) stats_.padding_saved += result.size - reordered.size;
+  return reordered;
+}
+
+}
@@ -0,0 +1,446 @@
+#include "WatchSession.hh"
+
+#include "ArgonLexer.h"
+#include "ArgonParser.h"
+#include "BuildScheduler.hh"
+#include "FileWatcher.hh"
+#include "IRBuilder.hh"
+#include "ModuleScanner.hh"
+#include "TypeChecker.hh"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <fstream>
+#include <fmt/core.h>
+#include <fmt/color.h>
+
+namespace argc {
+
+using namespace err;
+
+namespace {
+
+  auto read_file(const std::string& path, std::string& text) -> bool {
+    std::ifstream input(path, std::ios::binary);
+    if (!input.is_open()) return false;
+    text.assign(std::istreambuf_iterator<char>(input), std::istreambuf_iterator<char>());
+    return true;
+  }
+
+  // Gathers diagnostics without printing them, to be replayed later
+  struct Capture : ErrorReporter {
+    Capture() : ErrorReporter(false, 100) { setEcho(false); }
+  };
+
+  // The leading keyword decides which rule a line is parsed with; 'modulex'
+  // lexes as an identifier, so the whole word has to match
+  auto classify(const std::string_view line) -> LineResult::Kind {
+    size_t begin = 0;
+    while (begin < line.size() && (line[begin] == ' ' || line[begin] == '\t')) ++begin;
+    size_t end = begin;
+    while (end < line.size() && std::isalpha(static_cast<unsigned char>(line[end]))) ++end;
+
+    const auto word = line.substr(begin, end - begin);
+    if (word == "module") return LineResult::Kind::Header;
+    if (word == "import") return LineResult::Kind::Import;
+    return LineResult::Kind::Statement;
+  }
+
+}
+
+// Lexer, token stream and parser are built once and re-pointed at each line,
+// so compiling a line costs no more than lexing and parsing its tokens
+class LineCompiler {
+  class SyntaxErrorSink final : public antlr4::BaseErrorListener {
+    ErrorReporter* reporter_ { nullptr };
+  public:
+    auto bind(ErrorReporter* reporter) -> void { reporter_ = reporter; }
+
+    void syntaxError(antlr4::Recognizer*, antlr4::Token*, const size_t line, const size_t column,
+                     const std::string& msg, std::exception_ptr) override {
+      // ANTLR recovers regardless; the line fails on the parser's error count
+      (void)reporter_->report<ErrorCode::SyntaxError>(
+        CompileStage::Parsing,
+        ErrorSeverity::Error,
+        SourceLocation("", static_cast<uint32_t>(line), static_cast<uint32_t>(column + 1)),
+        msg
+      );
+    }
+  };
+
+  std::string buffer_;
+  std::unique_ptr<antlr4::ANTLRInputStream> input_;
+  ArgonLexer lexer_;
+  antlr4::CommonTokenStream tokens_;
+  ArgonParser parser_;
+  SyntaxErrorSink errors_;
+
+public:
+  LineCompiler()
+    : input_(std::make_unique<antlr4::ANTLRInputStream>(std::string_view{})),
+      lexer_(input_.get()),
+      tokens_(&lexer_),
+      parser_(&tokens_)
+  {
+    lexer_.removeErrorListeners();
+    lexer_.addErrorListener(&errors_);
+    parser_.removeErrorListeners();
+    parser_.addErrorListener(&errors_);
+  }
+
+  auto compile(const std::string_view line) -> LineResult {
+    LineResult result;
+    result.kind = classify(line);
+
+    Capture sink;
+    errors_.bind(&sink);
+
+    // Every rule used here expects the line's terminating NEWLINE
+    buffer_.assign(line);
+    buffer_ += '\n';
+    auto input = std::make_unique<antlr4::ANTLRInputStream>(buffer_);
+    lexer_.setInputStream(input.get());     // Rewinds the previous input, so it must still be alive here
+    input_ = std::move(input);
+    tokens_.setTokenSource(&lexer_);
+    parser_.setTokenStream(&tokens_);
+
+    switch (result.kind) {
+      case LineResult::Kind::Header:
+        if (auto* ctx = parser_.moduleDeclaration(); ctx->IDENTIFIER()) {
+          result.name = ctx->IDENTIFIER()->getText();
+        }
+        break;
+      case LineResult::Kind::Import:
+        if (auto* ctx = parser_.importDeclaration(); ctx->IDENTIFIER()) {
+          result.name = ctx->IDENTIFIER()->getText();
+        }
+        break;
+      case LineResult::Kind::Statement:
+        if (const auto nesting = build::paren_nesting(line); nesting.depth > build::max_paren_nesting) {
+          (void)sink.report<ErrorCode::ResourceLimit>(
+            CompileStage::Parsing,
+            ErrorSeverity::Error,
+            SourceLocation("", 1, nesting.column),
+            "parentheses", nesting.depth, build::max_paren_nesting
+          );
+        } else if (auto* ctx = parser_.statement(); parser_.getNumberOfSyntaxErrors() == 0) {
+          IRBuilder ir_builder(sink);
+          ir_builder.visit(ctx);
+          sema::TypeChecker(sink).check(ir_builder.getModule());
+        }
+        break;
+    }
+
+    errors_.bind(nullptr);
+    result.diagnostics = sink.errors();
+    return result;
+  }
+};
+
+WatchSession::WatchSession(const ConfigHandler& config, ErrorReporter& reporter)
+  : config_(config), reporter_(reporter), compiler_(std::make_unique<LineCompiler>())
+{
+}
+
+WatchSession::~WatchSession() = default;
+
+auto WatchSession::run() -> int {
+  for (const auto& path : config_.getInputFiles()) {
+    if (!load(path)) {
+      (void)reporter_.reportQuick(
+        ErrorCode::InvalidToken,
+        CompileStage::Lexing,
+        ErrorSeverity::Fatal,
+        "Could not open input file provided"
+      );
+      return 1;
+    }
+  }
+  rebuild_symbols();
+  check_graph();
+  for (const auto& file : files_) {
+    emit(*file, nullptr, 0.0);
+  }
+
+  FileWatcher watcher;
+  for (const auto& file : files_) {
+    if (!watcher.add(file->path)) {
+      (void)reporter_.reportQuick(
+        ErrorCode::InvalidOperation,
+        CompileStage::Lexing,
+        ErrorSeverity::Fatal,
+        "Cannot watch {} for changes (inotify is required)",
+        file->path
+      );
+      return 1;
+    }
+  }
+
+  fmt::print("Watching {} file(s) for changes\n", files_.size());
+  std::fflush(stdout);
+
+  while (true) {
+    for (const auto& path : watcher.wait()) {
+      const auto file = std::find_if(files_.begin(), files_.end(), [&](const auto& f) { return f->path == path; });
+      std::string text;
+      if (file == files_.end() || !read_file(path, text) || text == (*file)->unit.text()) continue;
+
+      const auto start = std::chrono::steady_clock::now();
+      const auto stats = recheck(**file, std::move(text));
+      const auto affected = check_graph();
+      const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      emit(**file, &stats, elapsed.count());
+
+      // A cycle closed or broken here is reported in the file that starts it
+      for (const auto* other : affected) {
+        if (other == file->get()) continue;
+        const incr::UpdateStats untouched{ .reused = other->unit.entries().size() };
+        emit(*other, &untouched, 0.0);
+      }
+    }
+    std::fflush(stdout);
+  }
+}
+
+auto WatchSession::update(const std::string& path, std::string text) -> incr::UpdateStats {
+  const auto file = std::find_if(files_.begin(), files_.end(), [&](const auto& f) { return f->path == path; });
+  if (file != files_.end()) {
+    const auto stats = recheck(**file, std::move(text));
+    check_graph();
+    return stats;
+  }
+
+  auto& added = add(path, std::move(text));
+  rebuild_symbols();
+  check_graph();
+  return incr::UpdateStats{ .compiled = added.unit.entries().size() };
+}
+
+auto WatchSession::load(const std::string& path) -> bool {
+  std::string text;
+  if (!read_file(path, text)) return false;
+  add(path, std::move(text));
+  return true;
+}
+
+auto WatchSession::add(const std::string& path, std::string text) -> WatchedFile& {
+  auto file = std::make_unique<WatchedFile>(
+    path,
+    incr::IncrementalUnit<LineResult>([this](const std::string_view line) { return compiler_->compile(line); })
+  );
+  file->unit.reset(std::move(text));
+  scan_structure(*file);
+  files_.push_back(std::move(file));
+  return *files_.back();
+}
+
+auto WatchSession::recheck(WatchedFile& file, std::string text) -> incr::UpdateStats {
+  const auto stats = file.unit.update(std::move(text));
+
+  const std::string previous_name = file.module_name;
+  scan_structure(file);
+  if (file.module_name != previous_name) {
+    rebuild_symbols();      // Other modules may import the old or the new name
+  } else {
+    sync_imports(file);
+  }
+  return stats;
+}
+
+// Header first, then imports, then statements. Linear in the number of
+// lines but only compares cached kinds; nothing is re-lexed.
+auto WatchSession::scan_structure(WatchedFile& file) -> void {
+  Capture sink;
+  const auto& entries = file.unit.entries();
+  const auto at = [&](const incr::Segment& segment) {
+    return SourceLocation(file.path, segment.line, 1, std::string(file.unit.slice(segment)));
+  };
+
+  file.module_name.clear();
+  file.imports.clear();
+
+  if (entries.empty() || entries.front().result.kind != LineResult::Kind::Header) {
+    (void)sink.report<ErrorCode::SyntaxError>(
+      CompileStage::Parsing,
+      ErrorSeverity::Error,
+      entries.empty() ? SourceLocation(file.path, 1, 1) : at(entries.front().segment),
+      "expected a module declaration"
+    );
+  }
+
+  bool in_body = false;
+  for (size_t i = 0; i < entries.size(); ++i) {
+    const auto& [segment, result] = entries[i];
+    switch (result.kind) {
+      case LineResult::Kind::Header:
+        if (i == 0) {
+          file.module_name = result.name;
+        } else {
+          (void)sink.report<ErrorCode::SyntaxError>(CompileStage::Parsing, ErrorSeverity::Error, at(segment),
+                                                    "the module declaration must be the first line");
+        }
+        break;
+      case LineResult::Kind::Import:
+        if (in_body) {
+          (void)sink.report<ErrorCode::SyntaxError>(CompileStage::Parsing, ErrorSeverity::Error, at(segment),
+                                                    "imports must precede statements");
+        } else if (!result.name.empty()) {
+          const auto text = file.unit.slice(segment);
+          const auto column = text.find(result.name, text.find("import") + 6);
+          file.imports.push_back(ImportLine{ result.name, segment.line, static_cast<uint32_t>(column + 1) });
+        }
+        break;
+      case LineResult::Kind::Statement:
+        in_body = true;
+        break;
+    }
+  }
+
+  file.structure_diagnostics = sink.errors();
+}
+
+// Fresh tables for every module: module symbols first so that imports can
+// bind in any order. Cycles bind too; check_graph() reports them.
+auto WatchSession::rebuild_symbols() -> void {
+  for (const auto& file : files_) {
+    file->symbols = SymbolTable{};
+    file->bound_imports.clear();
+    if (file->module_name.empty()) continue;
+
+    auto* module = file->symbols.make_symbol(file->module_name, SymbolKind::MODULE,
+                                             file->symbols.make_type<ModuleType>("module"),
+                                             loc::SourceLocation(0, 0, ""));
+    module->set_defined(true);
+    file->symbols.insert(module);
+    file->symbols.enter_scope(file->module_name);
+  }
+  for (const auto& file : files_) {
+    sync_imports(*file);
+  }
+}
+
+// Brings the imports bound in the file's table in line with its import
+// lines. The module scope itself is kept, so tables importing this one
+// stay valid.
+auto WatchSession::sync_imports(WatchedFile& file) -> void {
+  if (file.module_name.empty()) return;
+
+  std::vector<std::string> wanted;
+  for (const auto& import : file.imports) {
+    if (std::find(wanted.begin(), wanted.end(), import.name) == wanted.end()) wanted.push_back(import.name);
+  }
+
+  std::erase_if(file.bound_imports, [&](const std::string& name) {
+    if (std::find(wanted.begin(), wanted.end(), name) != wanted.end()) return false;
+    file.symbols.remove_import(name);
+    return true;
+  });
+
+  for (const auto& name : wanted) {
+    if (std::find(file.bound_imports.begin(), file.bound_imports.end(), name) != file.bound_imports.end()) continue;
+    const auto source = std::find_if(files_.begin(), files_.end(), [&](const auto& other) {
+      return other.get() != &file && other->module_name == name;
+    });
+    if (source != files_.end() && file.symbols.import_module(name, (*source)->symbols)) {
+      file.bound_imports.push_back(name);
+    }
+  }
+}
+
+// The scheduler a full build would use, fed the imports that bound. It
+// reports duplicate module names and the first import cycle exactly as
+// the build does; each diagnostic goes to the file it points into.
+// Returns the files whose diagnostics from here changed.
+auto WatchSession::check_graph() -> std::vector<const WatchedFile*> {
+  Capture sink;
+  build::BuildScheduler scheduler(sink, 1);
+  for (const auto& file : files_) {
+    if (file->module_name.empty()) continue;
+
+    build::ModuleUnit unit { file->path, file->module_name, {} };
+    for (const auto& import : file->imports) {
+      if (std::find(file->bound_imports.begin(), file->bound_imports.end(), import.name) == file->bound_imports.end()) {
+        continue;     // Reported as unresolved by diagnostics()
+      }
+      unit.imports.push_back(build::ImportRef{ import.name, import.line, import.column });
+    }
+    scheduler.add_module(std::move(unit));
+  }
+  scheduler.resolve();
+
+  const auto same = [](const std::vector<ErrorReporter::Error>& a, const std::vector<ErrorReporter::Error>& b) {
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto& x, const auto& y) {
+      return x.code == y.code && x.location.line == y.location.line && x.message == y.message;
+    });
+  };
+
+  std::vector<const WatchedFile*> changed;
+  for (const auto& file : files_) {
+    std::vector<ErrorReporter::Error> found;
+    for (const auto& diagnostic : sink.errors()) {
+      if (diagnostic.location.file == file->path) found.push_back(diagnostic);
+    }
+    if (!same(found, file->graph_diagnostics)) changed.push_back(file.get());
+    file->graph_diagnostics = std::move(found);
+  }
+  return changed;
+}
+
+auto WatchSession::diagnostics(const std::string& path) const -> std::vector<ErrorReporter::Error> {
+  const auto found = std::find_if(files_.begin(), files_.end(), [&](const auto& f) { return f->path == path; });
+  if (found == files_.end()) return {};
+  const auto& file = **found;
+
+  std::vector<ErrorReporter::Error> diagnostics;
+
+  for (const auto& [segment, result] : file.unit.entries()) {
+    for (auto diagnostic : result.diagnostics) {
+      diagnostic.location.file = file.path;
+      diagnostic.location.line = segment.line + std::max(diagnostic.location.line, 1u) - 1;
+      diagnostic.location.line_content = std::string(file.unit.slice(segment));
+      diagnostics.push_back(std::move(diagnostic));
+    }
+  }
+  diagnostics.insert(diagnostics.end(), file.structure_diagnostics.begin(), file.structure_diagnostics.end());
+  diagnostics.insert(diagnostics.end(), file.graph_diagnostics.begin(), file.graph_diagnostics.end());
+
+  Capture sink;
+  std::vector<std::string> seen;
+  for (const auto& import : file.imports) {
+    const SourceLocation loc(file.path, import.line, import.column);
+    if (std::find(seen.begin(), seen.end(), import.name) != seen.end()) {
+      (void)sink.report<ErrorCode::DuplicateImport>(CompileStage::SymbolCollection, ErrorSeverity::Warning, loc, import.name);
+      continue;
+    }
+    seen.push_back(import.name);
+    if (std::find(file.bound_imports.begin(), file.bound_imports.end(), import.name) == file.bound_imports.end()) {
+      (void)sink.report<ErrorCode::UnresolvedImport>(CompileStage::SymbolCollection, ErrorSeverity::Error, loc, import.name);
+    }
+  }
+  diagnostics.insert(diagnostics.end(), sink.errors().begin(), sink.errors().end());
+
+  std::stable_sort(diagnostics.begin(), diagnostics.end(), [](const auto& a, const auto& b) {
+    return a.location.line < b.location.line;
+  });
+  return diagnostics;
+}
+
+auto WatchSession::emit(const WatchedFile& file, const incr::UpdateStats* stats, const double elapsed_ms) -> void {
+  reporter_.clear();
+  for (auto& diagnostic : diagnostics(file.path)) {
+    reporter_.replay(std::move(diagnostic));
+  }
+
+  const size_t warnings = reporter_.warningCount();
+  const size_t errors = reporter_.errorCount() - warnings;
+  const auto colour = errors > 0 ? fg(fmt::color::crimson) : fg(fmt::color::green);
+  fmt::print(colour, "{}: {} error(s), {} warning(s)", file.path, errors, warnings);
+  if (stats) {
+    fmt::print(" [{} line(s) recompiled, {} reused, {:.2f} ms]\n", stats->compiled, stats->reused, elapsed_ms);
+  } else {
+    fmt::print(" [{} line(s) compiled]\n", file.unit.entries().size());
+  }
+}
+
+}
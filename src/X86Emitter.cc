@@ -0,0 +1,599 @@
+#include "X86Emitter.hh"
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <deque>
+#include <functional>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <fmt/core.h>
+
+namespace argc::codegen {
+
+namespace {
+
+  // Where an operand of the expression being lowered currently lives
+  enum class Loc : uint8_t { Imm, Acc, Stack, Slot, Reg };
+
+  struct Operand {
+    Loc loc;
+    int32_t imm { 0 };        // Imm: the value; Slot: the frame slot; Reg: the register
+  };
+
+  constexpr uint32_t no_slot = UINT32_MAX;
+  constexpr uint8_t no_register = UINT8_MAX;
+  constexpr uint32_t unscheduled = UINT32_MAX;
+  constexpr ir::NodeId no_value = UINT32_MAX;
+
+  // In allocation order: caller-saved first, so that only expressions
+  // needing more than six waiting values pay for saving registers
+  constexpr std::array<std::string_view, X86Emitter::allocatable_registers> register32 {
+    "esi", "edi", "r8d", "r9d", "r10d", "r11d", "ebx", "r12d", "r13d", "r14d", "r15d"
+  };
+  constexpr std::array<std::string_view, X86Emitter::allocatable_registers> register64 {
+    "rsi", "rdi", "r8", "r9", "r10", "r11", "rbx", "r12", "r13", "r14", "r15"
+  };
+  constexpr size_t first_callee_saved = 6;
+
+  auto slot_address(const uint32_t slot) -> std::string {
+    return fmt::format("DWORD PTR [rbp-{}]", 4 * (slot + 1));
+  }
+
+  auto operand_text(const Operand& operand) -> std::string {
+    switch (operand.loc) {
+      case Loc::Imm: return fmt::format("{}", operand.imm);
+      case Loc::Acc: return "eax";
+      case Loc::Slot: return slot_address(static_cast<uint32_t>(operand.imm));
+      case Loc::Reg: return std::string(register32[static_cast<size_t>(operand.imm)]);
+      case Loc::Stack: break;
+    }
+    return {};
+  }
+
+  auto commutes(const ir::Op op) -> bool {
+    return op == ir::Op::Add || op == ir::Op::Mul;
+  }
+
+}
+
+// Evaluation order of the reachable statements, with where each value is
+// last needed. Positions index 'order'; a 'ret' reads its value at the
+// position just past its statement.
+struct X86Emitter::Schedule {
+  std::vector<ir::NodeId> order;          // Binary nodes, operands first
+  std::vector<size_t> statement_end;      // One past each statement's last position
+  std::vector<uint32_t> position;         // Per node, or unscheduled
+  std::vector<uint32_t> reads;            // Per node: operand references, and a 'ret'
+  std::vector<uint32_t> last_use;         // Per node: position of the last read
+};
+
+auto X86Emitter::file_header() -> std::string {
+  return "\t.intel_syntax noprefix\n\t.text\n";
+}
+
+auto X86Emitter::file_footer() -> std::string {
+  return "\t.section .note.GNU-stack,\"\",@progbits\n";
+}
+
+auto X86Emitter::inst(const std::string_view text) -> void {
+  out_ += '\t';
+  out_ += text;
+  out_ += '\n';
+  ++stats_.instructions;
+}
+
+auto X86Emitter::emit_module(const ir::Module& module, const sema::TypeInfo* types) -> std::string {
+  types_ = types;
+  const std::string symbol = "argon_" + module.name;
+  out_ += fmt::format("\t.globl {0}\n\t.type {0}, @function\n", symbol);
+  if (module.name == "main") {
+    out_ += "\t.globl main\nmain:\n";
+  }
+  out_ += symbol + ":\n";
+
+  Frame frame;
+  Schedule order;
+  slots_.clear();
+  registers_.clear();
+  if (allocation_ == Allocation::Registers) {
+    order = schedule(module);
+    frame = allocate(module, order);
+  } else if (module.exprs.shares()) {
+    // Values needed more than once are computed once and kept in a frame slot
+    const auto uses = ir::count_uses(module);
+    slots_.assign(module.exprs.size(), no_slot);
+    for (ir::NodeId id = 0; id < module.exprs.size(); ++id) {
+      if (uses[id] > 1 && ir::is_binary(module.exprs.node(id).op)) slots_[id] = frame.slots++;
+    }
+    stats_.shared_values += frame.slots;
+    stats_.spills += frame.slots;
+  }
+
+  for (size_t r = 0; r < allocatable_registers; ++r) {
+    if (frame.saved_registers & (1u << r)) inst(fmt::format("push {}", register64[r]));
+  }
+  if (frame.slots > 0) {
+    inst("push rbp");
+    inst("mov rbp, rsp");
+    inst(fmt::format("sub rsp, {}", (4 * frame.slots + 15) / 16 * 16));
+  }
+  const auto emit_return = [&] {
+    if (frame.slots > 0) inst("leave");
+    for (size_t r = allocatable_registers; r-- > 0;) {
+      if (frame.saved_registers & (1u << r)) inst(fmt::format("pop {}", register64[r]));
+    }
+    inst("ret");
+  };
+
+  bool returned = false;
+  ir::NodeId in_eax = no_value;
+  size_t position = 0;
+  for (size_t s = 0; s < module.statements.size(); ++s) {
+    const auto& stmt = module.statements[s];
+    if (allocation_ == Allocation::Registers) {
+      for (; position < order.statement_end[s]; ++position) {
+        emit_scheduled(module.exprs, order, position, in_eax);
+      }
+      if (stmt.kind == ir::StmtKind::Return) load_result(module.exprs, stmt.root, in_eax);
+    } else {
+      emit_statement(module.exprs, stmt);
+    }
+    if (stmt.kind == ir::StmtKind::Return) {
+      emit_return();
+      returned = true;
+      break;            // Anything after 'ret' is unreachable
+    }
+  }
+  if (!returned) {
+    inst("xor eax, eax");
+    emit_return();
+  }
+
+  out_ += fmt::format("\t.size {0}, .-{0}\n", symbol);
+  types_ = nullptr;
+  return take();
+}
+
+auto X86Emitter::emit_statement(const ir::ExprPool& exprs, const ir::Statement& stmt) -> void {
+  // At most one operand lives in eax; it is only pushed once eax is needed
+  // for something else. Constants and slotted values are never on this
+  // stack: they are referenced where they are consumed.
+  std::vector<Operand> operands;
+
+  const auto slot_of = [&](const ir::NodeId id) {
+    return slots_.empty() ? no_slot : slots_[id];
+  };
+  const auto take_operand = [&](const ir::NodeId id) -> Operand {
+    if (const auto& n = exprs.node(id); n.op == ir::Op::Const) {
+      return Operand{ Loc::Imm, static_cast<int32_t>(n.value) };
+    }
+    if (const auto slot = slot_of(id); slot != no_slot) {
+      return Operand{ Loc::Slot, static_cast<int32_t>(slot) };
+    }
+    const Operand top = operands.back();
+    operands.pop_back();
+    return top;
+  };
+
+  for (ir::NodeId id = stmt.first; id <= stmt.root; ++id) {
+    const auto& node = exprs.node(id);
+    if (node.op == ir::Op::Const) continue;
+
+    const Operand rhs = take_operand(node.rhs);
+    const Operand lhs = take_operand(node.lhs);
+
+    // A value computed earlier is still parked in eax; every Stack operand
+    // is older than it, so pushing keeps the machine stack in operand order
+    for (auto& pending : operands) {
+      if (pending.loc == Loc::Acc) {
+        inst("push rax");
+        pending.loc = Loc::Stack;
+        ++stats_.spills;
+      }
+    }
+
+    const bool lhs_nonnegative = types_ && types_->range(node.lhs).is_nonnegative();
+
+    if (rhs.loc == Loc::Acc) {
+      if (lhs.loc == Loc::Imm) {
+        emit_op_imm_lhs(node.op, lhs.imm);
+      } else {
+        inst("mov ecx, eax");
+        inst(lhs.loc == Loc::Stack ? std::string("pop rax") : "mov eax, " + slot_address(lhs.imm));
+        emit_op_reg(node.op);
+      }
+    } else {
+      switch (lhs.loc) {
+        case Loc::Acc: break;
+        case Loc::Stack: inst("pop rax"); break;
+        case Loc::Imm: inst(fmt::format("mov eax, {}", lhs.imm)); break;
+        case Loc::Slot: inst("mov eax, " + slot_address(lhs.imm)); break;
+        case Loc::Reg: break;     // Registers are only allocated with Allocation::Registers
+      }
+      if (rhs.loc == Loc::Imm) {
+        emit_op_imm(node.op, rhs.imm, lhs_nonnegative);
+      } else {
+        assert(rhs.loc == Loc::Slot);
+        inst("mov ecx, " + slot_address(rhs.imm));
+        emit_op_reg(node.op);
+      }
+    }
+
+    if (const auto slot = slot_of(id); slot != no_slot) {
+      inst(fmt::format("mov {}, eax", slot_address(slot)));
+    } else {
+      operands.push_back(Operand{ Loc::Acc });
+    }
+  }
+
+  if (stmt.kind != ir::StmtKind::Return) return;
+
+  // A root computed just now is still in eax, slotted or not
+  if (const auto& root = exprs.node(stmt.root); root.op == ir::Op::Const) {
+    inst(fmt::format("mov eax, {}", static_cast<int32_t>(root.value)));
+  } else if (const auto slot = slot_of(stmt.root); slot != no_slot && stmt.root < stmt.first) {
+    inst("mov eax, " + slot_address(slot));
+  }
+}
+
+auto X86Emitter::schedule(const ir::Module& module) const -> Schedule {
+  const auto& exprs = module.exprs;
+  Schedule order;
+  order.position.assign(exprs.size(), unscheduled);
+
+  struct Pending {
+    ir::NodeId id;
+    bool operands_done;
+  };
+  std::vector<Pending> stack;
+  std::vector<uint32_t> need(exprs.size(), 0);
+
+  for (const auto& stmt : module.statements) {
+    // Sethi-Ullman number: the values held at once, eax included, while the
+    // node is evaluated. Constants and values of earlier statements are
+    // operands as they stand.
+    const auto operand_need = [&](const ir::NodeId id) -> uint32_t {
+      return id < stmt.first || !ir::is_binary(exprs.node(id).op) ? 0 : need[id];
+    };
+    for (ir::NodeId id = stmt.first; id <= stmt.root; ++id) {
+      const auto& node = exprs.node(id);
+      if (!ir::is_binary(node.op)) continue;
+      const uint32_t lhs = operand_need(node.lhs);
+      const uint32_t rhs = operand_need(node.rhs);
+      need[id] = lhs == rhs ? lhs + 1 : std::max(lhs, rhs);
+    }
+
+    // Post-order, needier operand first. A node shared within the statement
+    // is evaluated where it is first reached.
+    const auto pending = [&](const ir::NodeId id) {
+      return id >= stmt.first && ir::is_binary(exprs.node(id).op) && order.position[id] == unscheduled;
+    };
+    if (pending(stmt.root)) stack.push_back({ stmt.root, false });
+    while (!stack.empty()) {
+      const auto [id, operands_done] = stack.back();
+      stack.pop_back();
+      if (order.position[id] != unscheduled) continue;
+      if (operands_done) {
+        order.position[id] = static_cast<uint32_t>(order.order.size());
+        order.order.push_back(id);
+        continue;
+      }
+      const auto& node = exprs.node(id);
+      const bool rhs_first = operand_need(node.rhs) > operand_need(node.lhs);
+      stack.push_back({ id, true });
+      for (const auto operand : { rhs_first ? node.lhs : node.rhs, rhs_first ? node.rhs : node.lhs }) {
+        if (pending(operand)) stack.push_back({ operand, false });
+      }
+    }
+
+    order.statement_end.push_back(order.order.size());
+    if (stmt.kind == ir::StmtKind::Return) break;     // Anything after 'ret' is unreachable
+  }
+
+  order.reads.assign(exprs.size(), 0);
+  order.last_use.assign(exprs.size(), 0);
+  const auto read = [&](const ir::NodeId id, const size_t position) {
+    if (!ir::is_binary(exprs.node(id).op)) return;
+    ++order.reads[id];
+    order.last_use[id] = static_cast<uint32_t>(position);
+  };
+  for (size_t position = 0; position < order.order.size(); ++position) {
+    const auto& node = exprs.node(order.order[position]);
+    read(node.lhs, position);
+    read(node.rhs, position);
+  }
+  for (size_t s = 0; s < order.statement_end.size(); ++s) {
+    if (module.statements[s].kind == ir::StmtKind::Return) read(module.statements[s].root, order.statement_end[s]);
+  }
+  return order;
+}
+
+auto X86Emitter::allocate(const ir::Module& module, const Schedule& order) -> Frame {
+  const auto& exprs = module.exprs;
+  registers_.assign(exprs.size(), no_register);
+  slots_.assign(exprs.size(), no_slot);
+  const auto uses = exprs.shares() ? ir::count_uses(module) : std::vector<uint32_t>{};
+
+  Frame frame;
+  std::array<ir::NodeId, allocatable_registers> holder;
+  std::array<uint32_t, allocatable_registers> held_since {};   // Position the holder was written at
+  holder.fill(no_value);
+
+  // Slots whose value is dead, as (slot, position of its last read). They
+  // fall free in position order, so the front has been free longest.
+  std::deque<std::pair<uint32_t, uint32_t>> free_slots;
+
+  // A slot can take a value written no earlier than its previous value's
+  // last read. The value written now fits any free slot; a holder spilled
+  // after the fact was written earlier and may fit none.
+  const auto take_slot = [&](const uint32_t written) -> uint32_t {
+    if (!free_slots.empty() && free_slots.back().second <= written) {
+      const auto slot = free_slots.back().first;
+      free_slots.pop_back();
+      return slot;
+    }
+    if (!free_slots.empty() && free_slots.front().second <= written) {
+      const auto slot = free_slots.front().first;
+      free_slots.pop_front();
+      return slot;
+    }
+    return frame.slots++;
+  };
+
+  // Live ranges start in position order, so one pass is the linear scan;
+  // 'active' yields the range ending first
+  using Range = std::pair<uint32_t, ir::NodeId>;      // (last use, value)
+  std::priority_queue<Range, std::vector<Range>, std::greater<>> active;
+
+  for (uint32_t position = 0; position < order.order.size(); ++position) {
+    const auto id = order.order[position];
+    if (exprs.shares() && uses[id] > 1) ++stats_.shared_values;
+
+    // Used once, by the very next operation: it never leaves eax
+    if (order.reads[id] == 0 || (order.reads[id] == 1 && order.last_use[id] == position + 1)) continue;
+
+    // A range ending here is read before this value is written, so its
+    // register can be reused at once
+    while (!active.empty() && active.top().first <= position) {
+      const auto ended = active.top().second;
+      active.pop();
+      if (registers_[ended] != no_register) {
+        holder[registers_[ended]] = no_value;
+      } else {
+        free_slots.emplace_back(slots_[ended], order.last_use[ended]);
+      }
+    }
+
+    size_t reg = 0;
+    while (reg < register_limit_ && holder[reg] != no_value) ++reg;
+    if (reg < register_limit_) {
+      ++stats_.register_values;
+    } else {
+      // Out of registers: whichever of this value and the holders is needed
+      // furthest ahead lives in a frame slot
+      reg = no_register;
+      uint32_t furthest = order.last_use[id];
+      for (size_t r = 0; r < register_limit_; ++r) {
+        if (order.last_use[holder[r]] > furthest) {
+          furthest = order.last_use[holder[r]];
+          reg = r;
+        }
+      }
+      const auto spilled = reg == no_register ? id : holder[reg];
+      registers_[spilled] = no_register;
+      slots_[spilled] = take_slot(reg == no_register ? position : held_since[reg]);
+      ++stats_.spills;
+    }
+    if (reg != no_register) {
+      registers_[id] = static_cast<uint8_t>(reg);
+      holder[reg] = id;
+      held_since[reg] = position;
+      if (reg >= first_callee_saved) frame.saved_registers |= 1u << reg;
+    }
+    active.push({ order.last_use[id], id });
+  }
+
+  stats_.callee_saved += static_cast<size_t>(std::popcount(frame.saved_registers));
+  return frame;
+}
+
+auto X86Emitter::emit_scheduled(const ir::ExprPool& exprs, const Schedule& order, const size_t position,
+                                ir::NodeId& in_eax) -> void {
+  const auto id = order.order[position];
+  const auto& node = exprs.node(id);
+
+  const auto operand = [&](const ir::NodeId operand_id) -> Operand {
+    if (const auto& n = exprs.node(operand_id); n.op == ir::Op::Const) {
+      return Operand{ Loc::Imm, static_cast<int32_t>(n.value) };
+    }
+    if (operand_id == in_eax) return Operand{ Loc::Acc };
+    if (registers_[operand_id] != no_register) return Operand{ Loc::Reg, registers_[operand_id] };
+    assert(slots_[operand_id] != no_slot);
+    return Operand{ Loc::Slot, static_cast<int32_t>(slots_[operand_id]) };
+  };
+  const Operand lhs = operand(node.lhs);
+  const Operand rhs = operand(node.rhs);
+  const bool lhs_nonnegative = types_ && types_->range(node.lhs).is_nonnegative();
+
+  // eax = eax op rhs
+  const auto apply = [&](const Operand& source) {
+    if (source.loc == Loc::Imm) {
+      emit_op_imm(node.op, source.imm, lhs_nonnegative);
+    } else {
+      emit_op_reg(node.op, operand_text(source));
+    }
+  };
+
+  if (lhs.loc == Loc::Acc) {
+    apply(rhs);
+  } else if (rhs.loc == Loc::Acc) {
+    if (lhs.loc == Loc::Imm) {
+      emit_op_imm_lhs(node.op, lhs.imm);
+    } else if (commutes(node.op)) {
+      emit_op_reg(node.op, operand_text(lhs));
+    } else if (node.op == ir::Op::Sub) {
+      inst("neg eax");
+      inst("add eax, " + operand_text(lhs));
+    } else {
+      inst("mov ecx, eax");
+      inst("mov eax, " + operand_text(lhs));
+      emit_op_reg(node.op);
+    }
+  } else if (lhs.loc == Loc::Imm && rhs.loc != Loc::Imm && commutes(node.op)) {
+    // The constant goes last, where a multiply by it can be reduced
+    inst("mov eax, " + operand_text(rhs));
+    emit_op_imm(node.op, lhs.imm);
+  } else {
+    inst("mov eax, " + operand_text(lhs));
+    apply(rhs);
+  }
+
+  in_eax = id;
+  if (registers_[id] != no_register) {
+    inst(fmt::format("mov {}, eax", register32[registers_[id]]));
+  } else if (slots_[id] != no_slot) {
+    inst(fmt::format("mov {}, eax", slot_address(slots_[id])));
+  }
+}
+
+auto X86Emitter::load_result(const ir::ExprPool& exprs, const ir::NodeId root, const ir::NodeId in_eax) -> void {
+  if (const auto& node = exprs.node(root); node.op == ir::Op::Const) {
+    inst(fmt::format("mov eax, {}", static_cast<int32_t>(node.value)));
+  } else if (root != in_eax) {
+    inst("mov eax, " + (registers_[root] != no_register ? std::string(register32[registers_[root]])
+                                                       : slot_address(slots_[root])));
+  }
+}
+
+// eax = eax op source
+auto X86Emitter::emit_op_reg(const ir::Op op, const std::string_view source) -> void {
+  switch (op) {
+    case ir::Op::Add: inst(fmt::format("add eax, {}", source)); break;
+    case ir::Op::Sub: inst(fmt::format("sub eax, {}", source)); break;
+    case ir::Op::Mul: inst(fmt::format("imul eax, {}", source)); break;
+    case ir::Op::Div:
+      inst("cdq");
+      inst(fmt::format("idiv {}", source));
+      break;
+    case ir::Op::Const: break;
+  }
+}
+
+// eax = eax op imm
+auto X86Emitter::emit_op_imm(const ir::Op op, const int32_t imm, const bool lhs_nonnegative) -> void {
+  switch (op) {
+    case ir::Op::Add: inst(fmt::format("add eax, {}", imm)); break;
+    case ir::Op::Sub: inst(fmt::format("sub eax, {}", imm)); break;
+    case ir::Op::Mul:
+      if (strength_reduction_) {
+        emit_multiply(plan_multiplication(imm));
+      } else {
+        inst(fmt::format("imul eax, eax, {}", imm));
+      }
+      break;
+    case ir::Op::Div:
+      emit_divide(strength_reduction_ ? plan_signed_division(imm, lhs_nonnegative)
+                                      : DivisionPlan{ DivisionPlan::Kind::Hardware, imm });
+      break;
+    case ir::Op::Const: break;
+  }
+}
+
+// eax = imm op eax
+auto X86Emitter::emit_op_imm_lhs(const ir::Op op, const int32_t imm) -> void {
+  switch (op) {
+    case ir::Op::Add:
+    case ir::Op::Mul:
+      emit_op_imm(op, imm);
+      break;
+    case ir::Op::Sub:
+      inst("neg eax");
+      inst(fmt::format("add eax, {}", imm));
+      break;
+    case ir::Op::Div:
+      inst("mov ecx, eax");
+      inst(fmt::format("mov eax, {}", imm));
+      inst("cdq");
+      inst("idiv ecx");
+      break;
+    case ir::Op::Const: break;
+  }
+}
+
+auto X86Emitter::emit_multiply(const MulRecipe& recipe) -> void {
+  if (recipe.use_imul) {
+    inst(fmt::format("imul eax, eax, {}", recipe.multiplier));
+    return;
+  }
+
+  ++stats_.multiplies_reduced;
+  if (recipe.needs_src) inst("mov ecx, eax");
+
+  for (const auto& step : recipe.steps) {
+    switch (step.op) {
+      case MulStep::Op::Zero:      inst("xor eax, eax"); break;
+      case MulStep::Op::Shl:       inst(fmt::format("shl eax, {}", step.amount)); break;
+      case MulStep::Op::LeaSelf:   inst(fmt::format("lea eax, [rax+rax*{}]", step.amount - 1)); break;
+      case MulStep::Op::LeaSrc:    inst(fmt::format("lea eax, [rcx+rax*{}]", step.amount)); break;
+      case MulStep::Op::LeaAddSrc: inst(fmt::format("lea eax, [rax+rcx*{}]", step.amount)); break;
+      case MulStep::Op::AddSrc:    inst("add eax, ecx"); break;
+      case MulStep::Op::SubSrc:    inst("sub eax, ecx"); break;
+      case MulStep::Op::Neg:       inst("neg eax"); break;
+    }
+  }
+}
+
+auto X86Emitter::emit_divide(const DivisionPlan& plan) -> void {
+  switch (plan.kind) {
+    case DivisionPlan::Kind::Hardware:
+      inst(fmt::format("mov ecx, {}", plan.divisor));
+      inst("cdq");
+      inst("idiv ecx");
+      return;
+
+    case DivisionPlan::Kind::Identity:
+      break;
+
+    case DivisionPlan::Kind::Negate:
+      inst("neg eax");
+      break;
+
+    case DivisionPlan::Kind::PowerOfTwo:
+      // Bias negative dividends by 2^k - 1 so the arithmetic shift truncates toward zero
+      if (!plan.nonnegative_dividend) {
+        inst("mov ecx, eax");
+        if (plan.shift > 1) inst("sar ecx, 31");
+        inst(fmt::format("shr ecx, {}", 32 - plan.shift));
+        inst("add eax, ecx");
+      }
+      inst(fmt::format("sar eax, {}", plan.shift));
+      if (plan.negate) inst("neg eax");
+      break;
+
+    case DivisionPlan::Kind::Magic: {
+      const bool correct = plan.add_dividend || plan.sub_dividend;
+      if (correct) inst("mov ecx, eax");
+      inst("movsxd rax, eax");
+      inst(fmt::format("imul rax, rax, {}", plan.multiplier));
+      if (correct) {
+        inst("sar rax, 32");
+        inst(plan.add_dividend ? "add eax, ecx" : "sub eax, ecx");
+        if (plan.shift > 0) inst(fmt::format("sar eax, {}", plan.shift));
+      } else {
+        inst(fmt::format("sar rax, {}", 32 + plan.shift));
+      }
+      // Negative quotients are one too small; add the sign bit
+      if (!plan.nonnegative_dividend || plan.divisor < 0) {
+        inst("mov edx, eax");
+        inst("shr edx, 31");
+        inst("add eax, edx");
+      }
+      break;
+    }
+  }
+  ++stats_.divisions_reduced;
+}
+
+}
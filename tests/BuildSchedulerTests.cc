@@ -0,0 +1,125 @@
+#include "BuildScheduler.hh"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+using namespace argc;
+using namespace argc::build;
+
+class BuildSchedulerTest : public ::testing::Test {
+protected:
+  err::ErrorReporter reporter{false, 100};
+
+  static auto unit(const std::string& name, std::initializer_list<std::string> imports) -> ModuleUnit {
+    ModuleUnit u { name + ".ar", name, {} };
+    uint32_t line = 2;
+    for (const auto& i : imports) u.imports.push_back(ImportRef{ i, line++, 8 });
+    return u;
+  }
+};
+
+TEST_F(BuildSchedulerTest, ResolvesChainIntoWaves) {
+  BuildScheduler scheduler(reporter, 4);
+  ASSERT_TRUE(scheduler.add_module(unit("app", {"net", "util"})));
+  ASSERT_TRUE(scheduler.add_module(unit("net", {"util"})));
+  ASSERT_TRUE(scheduler.add_module(unit("util", {})));
+
+  ASSERT_TRUE(scheduler.resolve());
+  const auto& waves = scheduler.stats().waves;
+  ASSERT_EQ(waves.size(), 3u);
+  EXPECT_EQ(waves[0], std::vector<size_t>{2});
+  EXPECT_EQ(waves[1], std::vector<size_t>{1});
+  EXPECT_EQ(waves[2], std::vector<size_t>{0});
+}
+
+TEST_F(BuildSchedulerTest, RejectsDuplicateModuleNames) {
+  BuildScheduler scheduler(reporter);
+  EXPECT_TRUE(scheduler.add_module(unit("util", {})));
+  EXPECT_FALSE(scheduler.add_module(unit("util", {})));
+  EXPECT_EQ(reporter.errorCount(), 1u);
+}
+
+TEST_F(BuildSchedulerTest, ReportsUnresolvedImport) {
+  BuildScheduler scheduler(reporter);
+  scheduler.add_module(unit("app", {"missing"}));
+  EXPECT_FALSE(scheduler.resolve());
+  EXPECT_EQ(reporter.errorCount(), 1u);
+}
+
+TEST_F(BuildSchedulerTest, ReportsImportCycle) {
+  BuildScheduler scheduler(reporter);
+  scheduler.add_module(unit("a", {"b"}));
+  scheduler.add_module(unit("b", {"c"}));
+  scheduler.add_module(unit("c", {"a"}));
+  scheduler.add_module(unit("d", {}));
+
+  EXPECT_FALSE(scheduler.resolve());
+  EXPECT_EQ(reporter.errorCount(), 1u);
+  EXPECT_FALSE(scheduler.run([](size_t, const ModuleUnit&) { return true; }));
+}
+
+TEST_F(BuildSchedulerTest, DependenciesFinishBeforeDependentsStart) {
+  BuildScheduler scheduler(reporter, 4);
+  scheduler.add_module(unit("app", {"a", "b"}));
+  scheduler.add_module(unit("a", {"base"}));
+  scheduler.add_module(unit("b", {"base"}));
+  scheduler.add_module(unit("base", {}));
+  scheduler.add_module(unit("tool", {}));
+  ASSERT_TRUE(scheduler.resolve());
+
+  std::mutex mutex;
+  std::vector<bool> done(5, false);
+  std::atomic<bool> ordered { true };
+
+  const bool ok = scheduler.run([&](const size_t index, const ModuleUnit&) {
+    {
+      std::lock_guard lock(mutex);
+      for (const size_t dep : scheduler.dependencies(index)) {
+        if (!done[dep]) ordered = false;
+      }
+    }
+    std::lock_guard lock(mutex);
+    done[index] = true;
+    return true;
+  });
+
+  EXPECT_TRUE(ok);
+  EXPECT_TRUE(ordered);
+  for (size_t i = 0; i < 5; ++i) EXPECT_EQ(scheduler.status(i), ModuleStatus::Succeeded);
+}
+
+TEST_F(BuildSchedulerTest, FailureSkipsTransitiveDependents) {
+  BuildScheduler scheduler(reporter, 2);
+  scheduler.add_module(unit("app", {"mid"}));
+  scheduler.add_module(unit("mid", {"base"}));
+  scheduler.add_module(unit("base", {}));
+  scheduler.add_module(unit("tool", {}));
+  ASSERT_TRUE(scheduler.resolve());
+
+  const bool ok = scheduler.run([](size_t, const ModuleUnit& u) { return u.name != "base"; });
+
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(scheduler.status(2), ModuleStatus::Failed);
+  EXPECT_EQ(scheduler.status(1), ModuleStatus::Skipped);
+  EXPECT_EQ(scheduler.status(0), ModuleStatus::Skipped);
+  EXPECT_EQ(scheduler.status(3), ModuleStatus::Succeeded);
+}
+
+TEST_F(BuildSchedulerTest, CriticalPathFollowsLongestChain) {
+  BuildScheduler scheduler(reporter, 1);
+  scheduler.add_module(unit("app", {"mid", "leaf"}));
+  scheduler.add_module(unit("mid", {"base"}));
+  scheduler.add_module(unit("base", {}));
+  scheduler.add_module(unit("leaf", {}));
+  ASSERT_TRUE(scheduler.resolve());
+  ASSERT_TRUE(scheduler.run([](size_t, const ModuleUnit&) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    return true;
+  }));
+
+  const auto& path = scheduler.stats().critical_path;
+  ASSERT_EQ(path.size(), 3u);
+  EXPECT_EQ(path.front(), 2u);
+  EXPECT_EQ(path.back(), 0u);
+}
@@ -0,0 +1,111 @@
+#include "CEmitter.hh"
+#include "HostCompile.hh"
+#include <gtest/gtest.h>
+
+using namespace argc;
+using namespace argc::codegen;
+using namespace argc::test;
+
+class CEmitterTest : public ::testing::Test {
+protected:
+  err::ErrorReporter reporter{false, 100};
+  ir::Module module{ "main", {}, {} };
+
+  void SetUp() override { reporter.setEcho(false); }
+
+  // Appends 'ret lhs op rhs'
+  auto ret(const ir::Op op, const int64_t lhs, const int64_t rhs) -> void {
+    auto& exprs = module.exprs;
+    const auto first = static_cast<ir::NodeId>(exprs.size());
+    const auto a = exprs.make_const(lhs);
+    const auto b = exprs.make_const(rhs);
+    module.statements.push_back(ir::Statement{ ir::StmtKind::Return, first, exprs.make_binary(op, a, b), 1 });
+  }
+
+  auto emit(const bool typed) -> std::string {
+    const auto types = sema::TypeChecker(reporter).check(module).value();
+    CEmitter emitter;
+    return CEmitter::file_header() + emitter.emit_module(module, typed ? &types : nullptr);
+  }
+
+  // Builds with the host compiler and returns the program's exit status,
+  // or no_host_compiler when no C compiler is available here
+  static auto run(const std::string& c_source) -> int {
+    return compile_and_run({ { "main.c", c_source } }, "-O2");
+  }
+};
+
+TEST_F(CEmitterTest, ReturnBecomesMainsExitStatus) {
+  ret(ir::Op::Add, 20, 3);
+  const auto c = emit(true);
+  EXPECT_NE(c.find("int32_t argon_main(void)"), std::string::npos);
+  EXPECT_NE(c.find("return 20 + 3;"), std::string::npos);
+  EXPECT_NE(c.find("return (int)argon_main();"), std::string::npos);
+
+  const int status = run(c);
+  if (status == no_host_compiler) GTEST_SKIP() << "no host C compiler";
+  EXPECT_EQ(status, 23);
+}
+
+TEST_F(CEmitterTest, KeepsPrecedenceAndAssociativity) {
+  // 100 - (10 - 4) * 2
+  auto& exprs = module.exprs;
+  const auto hundred = exprs.make_const(100);
+  const auto ten = exprs.make_const(10);
+  const auto four = exprs.make_const(4);
+  const auto diff = exprs.make_binary(ir::Op::Sub, ten, four);
+  const auto two = exprs.make_const(2);
+  const auto prod = exprs.make_binary(ir::Op::Mul, diff, two);
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Return, hundred,
+                                             exprs.make_binary(ir::Op::Sub, hundred, prod), 1 });
+
+  const auto c = emit(true);
+  EXPECT_NE(c.find("return 100 - (10 - 4) * 2;"), std::string::npos);
+
+  const int status = run(c);
+  if (status == no_host_compiler) GTEST_SKIP() << "no host C compiler";
+  EXPECT_EQ(status, 88);
+}
+
+TEST_F(CEmitterTest, WrappingOperationsUseHelpers) {
+  // 2147483647 + 2147483647 wraps to -2, and -2 / 2 is -1: exit status 255
+  auto& exprs = module.exprs;
+  const auto a = exprs.make_const(2147483647);
+  const auto b = exprs.make_const(2147483647);
+  const auto sum = exprs.make_binary(ir::Op::Add, a, b);
+  const auto two = exprs.make_const(2);
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Return, a, exprs.make_binary(ir::Op::Div, sum, two), 1 });
+
+  const auto c = emit(true);
+  EXPECT_NE(c.find("argon_add(2147483647, 2147483647) / 2"), std::string::npos);
+
+  const int status = run(c);
+  if (status == no_host_compiler) GTEST_SKIP() << "no host C compiler";
+  EXPECT_EQ(status, 255);
+}
+
+TEST_F(CEmitterTest, UntypedModulesWrapEverything) {
+  ret(ir::Op::Mul, 6, 7);
+  const auto c = emit(false);
+  EXPECT_NE(c.find("return argon_mul(6, 7);"), std::string::npos);
+}
+
+TEST_F(CEmitterTest, DeepExpressionsSpillToTemporaries) {
+  // 1 - (1 - (1 - ...)), nested far beyond what should be left inline
+  auto& exprs = module.exprs;
+  std::vector<ir::NodeId> ones;
+  for (int i = 0; i < 1001; ++i) ones.push_back(exprs.make_const(1));
+  auto acc = ones.back();
+  for (int i = 999; i >= 0; --i) acc = exprs.make_binary(ir::Op::Sub, ones[i], acc);
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Return, 0, acc, 1 });
+
+  CEmitter emitter;
+  const auto types = sema::TypeChecker(reporter).check(module).value();
+  const auto c = CEmitter::file_header() + emitter.emit_module(module, &types);
+  EXPECT_GT(emitter.stats().temporaries, 0u);
+  EXPECT_EQ(emitter.stats().operations, 1000u);
+
+  const int status = run(c);
+  if (status == no_host_compiler) GTEST_SKIP() << "no host C compiler";
+  EXPECT_EQ(status, 1);
+}
@@ -0,0 +1,131 @@
+#include "CompilerInstance.hh"
+#include <gtest/gtest.h>
+#include <array>
+
+using namespace argc;
+using Kind = ConfigHandler::EmitKind;
+
+TEST(CompilerInstanceTest, CompilesABufferToAssembly) {
+  CompilerInstance instance;
+  const auto result = instance.compile("module m\n2 * 3\nret 2 + 3\n");
+
+  ASSERT_TRUE(result.succeeded);
+  EXPECT_TRUE(result.diagnostics.empty());
+  ASSERT_EQ(result.artifacts.size(), 1u);
+  EXPECT_EQ(result.artifacts[0].module, "m");
+  EXPECT_EQ(result.artifacts[0].path, "<input>");
+  EXPECT_NE(result.artifacts[0].code.find("argon_m:"), std::string::npos);
+  EXPECT_GT(result.asm_stats.instructions, 0u);
+
+  const auto unit = result.unit(Kind::ASM);
+  EXPECT_TRUE(unit.starts_with(codegen::X86Emitter::file_header()));
+  EXPECT_TRUE(unit.ends_with(codegen::X86Emitter::file_footer()));
+}
+
+TEST(CompilerInstanceTest, EmitsC) {
+  CompilerInstance instance({ .emit = Kind::C });
+  const auto result = instance.compile("module main\nret 7 * 6\n");
+
+  ASSERT_TRUE(result.succeeded);
+  EXPECT_NE(result.artifacts[0].code.find("int32_t argon_main(void)"), std::string::npos);
+  EXPECT_TRUE(result.unit(Kind::C).starts_with(codegen::CEmitter::file_header()));
+}
+
+TEST(CompilerInstanceTest, SyntaxErrorsComeBackAsDiagnostics) {
+  CompilerInstance instance;
+  const auto result = instance.compile("module m\nret 1\nret 2 +\n", "snippet.ar");
+
+  EXPECT_FALSE(result.succeeded);
+  EXPECT_TRUE(result.artifacts.empty());
+  ASSERT_FALSE(result.diagnostics.empty());
+  const auto& first = result.diagnostics.front();
+  EXPECT_EQ(first.code, err::ErrorCode::SyntaxError);
+  EXPECT_EQ(first.location.file, "snippet.ar");
+  EXPECT_EQ(first.location.line, 3u);
+}
+
+TEST(CompilerInstanceTest, RejectsInputsTheDriverRejects) {
+  CompilerInstance instance;
+
+  const auto headless = instance.compile("ret 1\n");
+  EXPECT_FALSE(headless.succeeded);
+  ASSERT_EQ(headless.diagnostics.size(), 1u);
+  EXPECT_EQ(headless.diagnostics[0].severity, err::ErrorSeverity::Fatal);
+
+  const auto nested = instance.compile("module m\nret " + std::string(300, '(') + "1" + std::string(300, ')') + "\n");
+  EXPECT_FALSE(nested.succeeded);
+  ASSERT_EQ(nested.diagnostics.size(), 1u);
+  EXPECT_EQ(nested.diagnostics[0].code, err::ErrorCode::ResourceLimit);
+  EXPECT_NE(nested.diagnostics[0].message.find("nested 300 deep"), std::string::npos);
+
+  const auto divides = instance.compile("module m\nret 1 / 0\n");
+  EXPECT_FALSE(divides.succeeded);
+  ASSERT_FALSE(divides.diagnostics.empty());
+  EXPECT_EQ(divides.diagnostics[0].code, err::ErrorCode::InvalidOperation);
+}
+
+TEST(CompilerInstanceTest, WarningsDoNotFailTheCompilation) {
+  CompilerInstance instance;
+  const auto result = instance.compile("module m\nret 65536 * 65536\n");
+
+  EXPECT_TRUE(result.succeeded);
+  ASSERT_EQ(result.diagnostics.size(), 1u);
+  EXPECT_EQ(result.diagnostics[0].severity, err::ErrorSeverity::Warning);
+  EXPECT_EQ(result.artifacts.size(), 1u);
+}
+
+TEST(CompilerInstanceTest, ImportsResolveBetweenBuffers) {
+  CompilerInstance instance;
+  const std::array sources {
+    SourceBuffer{ "main.ar", "module main\nimport util\nret 1\n" },
+    SourceBuffer{ "util.ar", "module util\nret 2\n" },
+  };
+  const auto result = instance.compile(sources);
+
+  ASSERT_TRUE(result.succeeded);
+  ASSERT_EQ(result.artifacts.size(), 2u);
+  EXPECT_EQ(result.artifacts[0].module, "util");        // Dependencies first
+  EXPECT_EQ(result.artifacts[1].module, "main");
+  EXPECT_EQ(result.artifacts[1].path, "main.ar");
+
+  const std::array missing { SourceBuffer{ "main.ar", "module main\nimport util\nret 1\n" } };
+  const auto unresolved = instance.compile(missing);
+  EXPECT_FALSE(unresolved.succeeded);
+  ASSERT_EQ(unresolved.diagnostics.size(), 1u);
+  EXPECT_EQ(unresolved.diagnostics[0].code, err::ErrorCode::UnresolvedImport);
+}
+
+// Nothing from one call leaks into the next, and the state behind it is recycled
+TEST(CompilerInstanceTest, CallsAreIndependent) {
+  CompilerInstance instance;
+  for (int i = 0; i < 50; ++i) {
+    const auto failed = instance.compile("module m\nret (1 +\n");
+    EXPECT_FALSE(failed.succeeded);
+
+    // The frontend is re-pointed at each buffer; nothing of the failed one
+    // may reach the code compiled after it
+    const auto source = "module m\nret " + std::to_string(i) + " * 2\n";
+    const auto passed = instance.compile(source);
+    ASSERT_TRUE(passed.succeeded) << i;
+    EXPECT_TRUE(passed.diagnostics.empty()) << i;
+    EXPECT_EQ(passed.unit(Kind::ASM),
+              CompilerInstance().compile(source).unit(Kind::ASM)) << i;
+  }
+
+  const std::array pair {
+    SourceBuffer{ "a.ar", "module a\nret 1\n" },
+    SourceBuffer{ "b.ar", "module b\nimport a\nret 2\n" },
+  };
+  const std::array broken_pair {
+    SourceBuffer{ "a.ar", "module a\nret 1\n" },
+    SourceBuffer{ "b.ar", "module b\nimport a\nret (2 *\n" },
+  };
+  EXPECT_TRUE(instance.compile(pair).succeeded);
+  EXPECT_FALSE(instance.compile(broken_pair).succeeded);
+  const auto again = instance.compile(pair);
+  EXPECT_TRUE(again.succeeded);
+  EXPECT_TRUE(again.diagnostics.empty());
+
+  EXPECT_EQ(instance.stats().compilations, 103u);
+  EXPECT_EQ(instance.stats().symbol_tables, 2u);
+}
@@ -0,0 +1,174 @@
+#include "ConcurrentSymbolTable.hh"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace argc;
+
+class ConcurrentSymbolTableTest : public ::testing::Test {
+protected:
+  ConcurrentSymbolTable table;
+  const Type* intType = table.make_type<PrimitiveType>("int");
+  loc::SourceLocation dummyLoc{0, 0, ""};
+
+  static constexpr int threads = 8;
+  static constexpr int per_thread = 2000;
+
+  static auto name(const int thread, const int i) -> std::string {
+    return "s" + std::to_string(thread) + "_" + std::to_string(i);
+  }
+};
+
+TEST_F(ConcurrentSymbolTableTest, ModulesAreDeclaredGlobally) {
+  auto* util = table.add_module("util", dummyLoc);
+  ASSERT_NE(util, nullptr);
+  EXPECT_EQ(table.add_module("util", dummyLoc), nullptr);
+  EXPECT_EQ(table.module("util"), util);
+  EXPECT_EQ(util->level(), 1);
+
+  auto* global = table.global().lookup_current("util");
+  ASSERT_NE(global, nullptr);
+  EXPECT_EQ(global->kind(), SymbolKind::MODULE);
+  EXPECT_EQ(util->lookup("util"), global);
+}
+
+TEST_F(ConcurrentSymbolTableTest, FrozenScopeRejectsDeclarations) {
+  auto* scope = table.add_module("m", dummyLoc);
+  ASSERT_NE(scope->declare("x", SymbolKind::VARIABLE, intType, dummyLoc), nullptr);
+  table.freeze();
+
+  EXPECT_TRUE(scope->frozen());
+  EXPECT_EQ(scope->declare("y", SymbolKind::VARIABLE, intType, dummyLoc), nullptr);
+  ASSERT_NE(scope->lookup("x"), nullptr);
+  EXPECT_EQ(scope->lookup("y"), nullptr);
+  EXPECT_NE(scope->lookup("m"), nullptr);     // Through the frozen global scope
+}
+
+TEST_F(ConcurrentSymbolTableTest, CursorScopesShadowSharedScopes) {
+  auto* scope = table.add_module("m", dummyLoc);
+  auto* shared = scope->declare("x", SymbolKind::VARIABLE, intType, dummyLoc);
+  scope->freeze();
+
+  ScopeCursor cursor(*scope);
+  EXPECT_EQ(cursor.insert("x", SymbolKind::VARIABLE, intType, dummyLoc), nullptr);   // No nested scope yet
+  EXPECT_EQ(cursor.lookup("x"), shared);
+
+  cursor.enter_scope("f");
+  auto* local = cursor.insert("x", SymbolKind::PARAMETER, intType, dummyLoc);
+  ASSERT_NE(local, nullptr);
+  EXPECT_EQ(local->scope_level(), 2);
+  EXPECT_EQ(cursor.lookup("x"), local);
+  EXPECT_EQ(cursor.insert("x", SymbolKind::VARIABLE, intType, dummyLoc), nullptr);
+
+  cursor.enter_scope();
+  EXPECT_EQ(cursor.lookup("x"), local);
+  EXPECT_EQ(cursor.lookup_current("x"), nullptr);
+  cursor.exit_scope();
+  cursor.exit_scope();
+  EXPECT_EQ(cursor.lookup("x"), shared);
+}
+
+// Every thread declares its own names and races on a common set; each
+// common name must be won exactly once, and readers running alongside must
+// never see a half-inserted entry
+TEST_F(ConcurrentSymbolTableTest, StressConcurrentDeclareAndLookup) {
+  auto* scope = table.add_module("m", dummyLoc);
+  std::atomic<int> common_wins { 0 };
+  std::atomic<bool> bad_read { false };
+
+  {
+    std::vector<std::jthread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t] {
+        for (int i = 0; i < per_thread; ++i) {
+          const auto own = name(t, i);
+          if (!scope->declare(own, SymbolKind::VARIABLE, intType, dummyLoc)) bad_read = true;
+          if (scope->declare("common" + std::to_string(i), SymbolKind::VARIABLE, intType, dummyLoc)) ++common_wins;
+
+          const auto* entry = scope->lookup(own);
+          if (!entry || entry->name() != own) bad_read = true;
+          if (const auto* other = scope->lookup(name((t + 1) % threads, i)); other && other->kind() != SymbolKind::VARIABLE) {
+            bad_read = true;
+          }
+        }
+      });
+    }
+  }
+
+  EXPECT_FALSE(bad_read);
+  EXPECT_EQ(common_wins, per_thread);
+  EXPECT_EQ(scope->size(), static_cast<size_t>(threads * per_thread + per_thread));
+}
+
+// Readers hammer the scope while it is frozen under them; every lookup must
+// succeed before, during and after the switch to the flat index
+TEST_F(ConcurrentSymbolTableTest, StressFreezeUnderReaders) {
+  auto* scope = table.add_module("m", dummyLoc);
+  for (int i = 0; i < per_thread; ++i) {
+    scope->declare(name(0, i), SymbolKind::VARIABLE, intType, dummyLoc);
+  }
+
+  std::atomic<bool> start { false };
+  std::atomic<bool> missing { false };
+  {
+    std::vector<std::jthread> readers;
+    for (int t = 0; t < threads; ++t) {
+      readers.emplace_back([&, t] {
+        while (!start) std::this_thread::yield();
+        ScopeCursor cursor(*scope);
+        cursor.enter_scope("body");
+        cursor.insert("local", SymbolKind::VARIABLE, intType, dummyLoc);
+        for (int round = 0; round < 20; ++round) {
+          for (int i = t; i < per_thread; i += threads) {
+            if (!cursor.lookup(name(0, i)) || !cursor.lookup("local")) missing = true;
+            if (cursor.lookup(name(1, i))) missing = true;
+          }
+        }
+      });
+    }
+    start = true;
+    table.freeze();
+  }
+
+  EXPECT_FALSE(missing);
+  EXPECT_TRUE(scope->frozen());
+  EXPECT_EQ(scope->size(), static_cast<size_t>(per_thread));
+}
+
+// Writers race the freeze: a declaration either lands before the index is
+// built and can be looked up afterwards, or it is refused. None may be
+// accepted into a shard that has already been folded into the index.
+TEST_F(ConcurrentSymbolTableTest, StressDeclareDuringFreeze) {
+  for (int round = 0; round < 20; ++round) {
+    ConcurrentSymbolTable fresh;
+    auto* scope = fresh.add_module("m", dummyLoc);
+    std::atomic<int> running { 0 };
+    std::atomic<bool> frozen { false };
+    std::vector<std::vector<int>> accepted(threads);
+    {
+      std::vector<std::jthread> writers;
+      for (int t = 0; t < threads; ++t) {
+        writers.emplace_back([&, t] {
+          ++running;
+          for (int i = 0; !frozen; ++i) {
+            if (scope->declare(name(t, i), SymbolKind::VARIABLE, intType, dummyLoc)) accepted[t].push_back(i);
+          }
+        });
+      }
+      while (running < threads) std::this_thread::yield();
+      fresh.freeze();
+      frozen = true;
+    }
+
+    size_t count = 0;
+    for (int t = 0; t < threads; ++t) {
+      for (const int i : accepted[t]) {
+        ASSERT_NE(scope->lookup_current(name(t, i)), nullptr) << "round " << round << ": " << name(t, i);
+      }
+      count += accepted[t].size();
+    }
+    EXPECT_EQ(scope->size(), count);
+  }
+}
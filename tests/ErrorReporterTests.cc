@@ -0,0 +1,70 @@
+#include "ErrorReporter.hh"
+#include <gtest/gtest.h>
+
+using namespace argc::err;
+
+// Template arity and argument kinds are enforced at compile time
+static_assert(ErrorTemplateDatabase::accepts<ErrorCode::TypeMismatch, const char (&)[3], std::string>());
+static_assert(!ErrorTemplateDatabase::accepts<ErrorCode::TypeMismatch, const char (&)[3]>());
+static_assert(!ErrorTemplateDatabase::accepts<ErrorCode::UndefinedSymbol, int>());
+static_assert(ErrorTemplateDatabase::accepts<ErrorCode::UnterminatedString>());
+static_assert(ErrorTemplateDatabase::accepts<ErrorCode::ResourceLimit, const char (&)[12], size_t, const size_t&>());
+static_assert(!ErrorTemplateDatabase::accepts<ErrorCode::ResourceLimit, const char (&)[12], std::string, size_t>());
+static_assert(!ErrorTemplateDatabase::accepts<ErrorCode::ResourceLimit, const char (&)[12], bool, size_t>());
+static_assert(detail::count_placeholders("{{literal}} {} and {}") == 2);
+
+TEST(ErrorReporterTest, TemplatesAreIndexedByCode) {
+  EXPECT_EQ(ErrorTemplateDatabase::getTemplate(ErrorCode::TypeMismatch), "Type mismatch: expected {}, got {}");
+  EXPECT_EQ(ErrorTemplateDatabase::get(ErrorCode::CyclicImport).arity, 1u);
+  EXPECT_EQ(ErrorTemplateDatabase::get(ErrorCode::UnterminatedString).arity, 0u);
+}
+
+TEST(ErrorReporterTest, ReportFormatsTemplate) {
+  ErrorReporter reporter(false, 10);
+  EXPECT_TRUE(reporter.report<ErrorCode::TypeMismatch>(
+    CompileStage::TypeChecking, ErrorSeverity::Error, SourceLocation("main.ar", 3, 5), "i8", std::string("f32")));
+  EXPECT_TRUE(reporter.report<ErrorCode::UnterminatedString>(CompileStage::Lexing, ErrorSeverity::Warning, SourceLocation{}));
+
+  ASSERT_EQ(reporter.errorCount(), 2u);
+  EXPECT_EQ(reporter.warningCount(), 1u);
+}
+
+TEST(ErrorReporterTest, DiagnosticsPastLimitAreDropped) {
+  ErrorReporter reporter(false, 2);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_TRUE(reporter.reportQuick(ErrorCode::InvalidOperation, CompileStage::SemanticAnalysis, ErrorSeverity::Warning,
+                                     "operation {} ignored", i));
+  }
+  EXPECT_EQ(reporter.errorCount(), 2u);
+  EXPECT_FALSE(reporter.shouldContinue());
+}
+
+TEST(ErrorReporterTest, FatalDiagnosticsFailTheStage) {
+  ErrorReporter reporter(false, 10);
+  reporter.setEcho(false);
+  const auto status = reporter.report<ErrorCode::SyntaxError>(CompileStage::Parsing, ErrorSeverity::Fatal,
+                                                              SourceLocation{}, "unexpected end of input");
+  ASSERT_FALSE(status);
+  EXPECT_EQ(status.error().code, ErrorCode::SyntaxError);
+  EXPECT_EQ(status.error().stage, CompileStage::Parsing);
+  EXPECT_EQ(reporter.fatalCount(), 1u);
+
+  // Plain errors only stop a reporter configured to stop on them
+  EXPECT_TRUE(reporter.reportQuick(ErrorCode::InvalidOperation, CompileStage::SemanticAnalysis,
+                                   ErrorSeverity::Error, "not stopping"));
+  reporter.setStopOnError(true);
+  EXPECT_FALSE(reporter.reportQuick(ErrorCode::InvalidOperation, CompileStage::SemanticAnalysis,
+                                    ErrorSeverity::Error, "stopping"));
+  EXPECT_TRUE(reporter.reportQuick(ErrorCode::InvalidOperation, CompileStage::SemanticAnalysis,
+                                   ErrorSeverity::Warning, "never stopping"));
+}
+
+TEST(ErrorReporterTest, DroppedFatalDiagnosticsStillFail) {
+  ErrorReporter reporter(false, 1);
+  reporter.setEcho(false);
+  EXPECT_TRUE(reporter.reportQuick(ErrorCode::InvalidOperation, CompileStage::SemanticAnalysis,
+                                   ErrorSeverity::Warning, "fills the limit"));
+  EXPECT_FALSE(reporter.reportQuick(ErrorCode::ResourceLimit, CompileStage::CodeGeneration,
+                                    ErrorSeverity::Fatal, "dropped"));
+  EXPECT_EQ(reporter.errorCount(), 1u);
+}
@@ -0,0 +1,117 @@
+#include "CEmitter.hh"
+#include "X86Emitter.hh"
+#include "HostCompile.hh"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace argc;
+using namespace argc::test;
+
+namespace {
+
+// A tiny alphabet of leaves and operators makes repeats likely
+auto random_expression(ModuleBuilder& b, std::mt19937& rng, const int depth) -> ir::NodeId {
+  if (depth == 0 || rng() % 4 == 0) return b.constant(static_cast<int32_t>(rng() % 5) + 1);
+  const auto op = static_cast<ir::Op>(1 + rng() % 4);
+  const auto lhs = random_expression(b, rng, depth - 1);
+  const auto rhs = random_expression(b, rng, depth - 1);
+  return b.binary(op, lhs, rhs);
+}
+
+}
+
+TEST(ExprPoolTest, SharingPoolReturnsExistingNodes) {
+  ir::ExprPool pool(true);
+  const auto a = pool.make_const(6);
+  const auto b = pool.make_const(7);
+  const auto ab = pool.make_binary(ir::Op::Mul, a, b);
+
+  EXPECT_EQ(pool.make_const(6), a);
+  EXPECT_EQ(pool.make_binary(ir::Op::Mul, a, b), ab);
+  EXPECT_NE(pool.make_binary(ir::Op::Mul, b, a), ab);      // Operand order is significant
+  EXPECT_NE(pool.make_binary(ir::Op::Div, a, b), ab);
+  EXPECT_EQ(pool.size(), 5u);
+  EXPECT_EQ(pool.stats().requested, 7u);
+  EXPECT_EQ(pool.stats().deduplicated, 2u);
+}
+
+TEST(ExprPoolTest, PlainPoolKeepsEveryNode) {
+  ir::ExprPool pool;
+  pool.make_const(1);
+  pool.make_const(1);
+  EXPECT_EQ(pool.size(), 2u);
+  EXPECT_EQ(pool.stats().deduplicated, 0u);
+}
+
+TEST(ExprPoolTest, SharingSurvivesRehashing) {
+  ir::ExprPool pool(true);
+  for (int round = 0; round < 2; ++round) {
+    for (int64_t v = 0; v < 10'000; ++v) {
+      EXPECT_EQ(pool.make_const(v), static_cast<ir::NodeId>(v));
+    }
+  }
+  EXPECT_EQ(pool.size(), 10'000u);
+  EXPECT_EQ(pool.stats().deduplicated, 10'000u);
+}
+
+TEST(ExprPoolTest, CountsUsesAcrossStatements) {
+  ir::Module module{ "m", ir::ExprPool(true), {} };
+  auto& exprs = module.exprs;
+  const auto a = exprs.make_const(2);
+  const auto b = exprs.make_const(3);
+  const auto ab = exprs.make_binary(ir::Op::Mul, a, b);
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Expression, a, ab, 1 });
+  const auto first = static_cast<ir::NodeId>(exprs.size());
+  const auto again = exprs.make_binary(ir::Op::Mul, exprs.make_const(2), exprs.make_const(3));
+  const auto sum = exprs.make_binary(ir::Op::Add, again, again);
+  module.statements.push_back(ir::Statement{ ir::StmtKind::Return, first, sum, 2 });
+
+  const auto uses = ir::count_uses(module);
+  EXPECT_EQ(again, ab);
+  EXPECT_EQ(uses[ab], 3u);
+  EXPECT_EQ(uses[sum], 1u);
+}
+
+// Both backends must compute the same values from a shared DAG as from the tree
+TEST(ExprPoolTest, BackendsAgreeOnSharedExpressions) {
+  if (!have_cc()) GTEST_SKIP() << "no host C compiler";
+
+  err::ErrorReporter reporter(false, 1000);
+  reporter.setEcho(false);
+  std::string c_unit = codegen::CEmitter::file_header();
+  std::string asm_unit = codegen::X86Emitter::file_header();
+  std::vector<int32_t> expected;
+  size_t tree_instructions = 0, dag_instructions = 0;
+
+  for (unsigned seed = 0; expected.size() < 60; ++seed) {
+    const auto name = "f" + std::to_string(expected.size());
+    // Same seed on both sides: the same requests, shared or not
+    ModuleBuilder tree(name, false), dag(name, true);
+    std::mt19937 tree_rng(seed), dag_rng(seed);
+    int32_t result = 0;
+    for (int s = 0; s < 4; ++s) {
+      const auto kind = s == 3 ? ir::StmtKind::Return : ir::StmtKind::Expression;
+      result = tree.end_statement(kind, random_expression(tree, tree_rng, 5));
+      ASSERT_EQ(dag.end_statement(kind, random_expression(dag, dag_rng, 5)), result);
+    }
+    if (tree.divides_by_zero()) continue;
+    expected.push_back(result);
+
+    const auto types = sema::TypeChecker(reporter).check(dag.module).value();
+    codegen::CEmitter c_emitter;
+    c_unit += c_emitter.emit_module(dag.module, &types);
+
+    codegen::X86Emitter tree_emitter, dag_emitter;
+    tree_emitter.emit_module(tree.module);
+    asm_unit += dag_emitter.emit_module(dag.module, &types);
+    tree_instructions += tree_emitter.stats().instructions;
+    dag_instructions += dag_emitter.stats().instructions;
+  }
+  asm_unit += codegen::X86Emitter::file_footer();
+
+  EXPECT_LT(dag_instructions, tree_instructions);
+  EXPECT_EQ(run_mismatches(c_unit, "c", expected, "-O0"), 0);
+#if defined(__x86_64__)
+  EXPECT_EQ(run_mismatches(asm_unit, "s", expected, "-O0"), 0);
+#endif
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+// Test support shared by the backend suites: a module builder that keeps
+// the reference value of every node, and a harness that builds generated
+// code with the host C compiler and runs it.
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "ExprIR.hh"
+
+extern char** environ;
+
+namespace argc::test {
+
+  inline auto wrap(const int64_t v) -> int32_t {
+    return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint64_t>(v)));
+  }
+
+  // Builds modules node by node, operands first as IRBuilder would, keeping
+  // the value of every node for reference
+  struct ModuleBuilder {
+    ir::Module module;
+    std::vector<int32_t> values;
+    ir::NodeId first { 0 };
+
+    ModuleBuilder(const std::string& name, const bool share) : module{ name, ir::ExprPool(share), {} } {}
+
+    auto constant(const int32_t value) -> ir::NodeId {
+      const auto id = module.exprs.make_const(value);
+      record(id, value);
+      return id;
+    }
+
+    auto binary(const ir::Op op, const ir::NodeId lhs, const ir::NodeId rhs) -> ir::NodeId {
+      const int64_t a = values[lhs], b = values[rhs];
+      int32_t result = 0;
+      switch (op) {
+        case ir::Op::Add: result = wrap(a + b); break;
+        case ir::Op::Sub: result = wrap(a - b); break;
+        case ir::Op::Mul: result = wrap(a * b); break;
+        case ir::Op::Div: result = b == 0 ? 0 : wrap(a / b); break;
+        case ir::Op::Const: break;
+      }
+      const auto id = module.exprs.make_binary(op, lhs, rhs);
+      record(id, result);
+      return id;
+    }
+
+    auto end_statement(const ir::StmtKind kind, const ir::NodeId root) -> int32_t {
+      module.statements.push_back(ir::Statement{ kind, first, root, static_cast<uint32_t>(module.statements.size() + 1) });
+      first = static_cast<ir::NodeId>(module.exprs.size());
+      return values[root];
+    }
+
+    auto record(const ir::NodeId id, const int32_t value) -> void {
+      if (values.size() <= id) values.resize(id + 1);
+      values[id] = value;
+    }
+
+    // True when some division in the module has a zero divisor
+    [[nodiscard]] auto divides_by_zero() const -> bool {
+      for (const auto& n : module.exprs.nodes()) {
+        if (n.op == ir::Op::Div && values[n.rhs] == 0) return true;
+      }
+      return false;
+    }
+  };
+
+  // A directory of its own under the temp dir, so concurrent test runs on
+  // one host never share files; removed with its contents on every path
+  class ScratchDir {
+    std::filesystem::path path_;
+
+  public:
+    explicit ScratchDir(const std::string& prefix) {
+      auto pattern = (std::filesystem::temp_directory_path() / (prefix + "_XXXXXX")).string();
+      if (!mkdtemp(pattern.data())) {
+        throw std::filesystem::filesystem_error("mkdtemp", pattern, std::error_code(errno, std::generic_category()));
+      }
+      path_ = pattern;
+    }
+
+    ~ScratchDir() {
+      std::error_code ignored;
+      std::filesystem::remove_all(path_, ignored);
+    }
+
+    ScratchDir(const ScratchDir&) = delete;
+    auto operator=(const ScratchDir&) -> ScratchDir& = delete;
+
+    [[nodiscard]] auto path() const -> const std::filesystem::path& { return path_; }
+  };
+
+  inline auto have_cc() -> bool {
+    return std::system("cc --version > /dev/null 2>&1") == 0;
+  }
+
+  // Runs a program without a shell; its exit status, or -1 if it could not
+  // be started or was killed by a signal
+  inline auto spawn(std::vector<std::string> args) -> int {
+    std::vector<char*> argv;
+    for (auto& a : args) argv.push_back(a.data());
+    argv.push_back(nullptr);
+
+    pid_t pid = 0;
+    if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0) return -1;
+    int status = 0;
+    if (waitpid(pid, &status, 0) < 0) return -1;
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+  }
+
+  // What compile_and_run() returns when there is no exit status to report
+  inline constexpr int no_host_compiler = -1;
+  inline constexpr int build_failed = -2;
+  inline constexpr int no_exit_status = -3;       // Killed by a signal
+
+  struct HostFile {
+    std::string name;       // Extension picks the language: .c or .s
+    std::string text;
+  };
+
+  // Builds the files into one program with the host cc and runs it
+  inline auto compile_and_run(const std::vector<HostFile>& files, const std::string& optimisation) -> int {
+    if (!have_cc()) return no_host_compiler;
+
+    const ScratchDir dir("argc_host_test");
+    const auto binary = (dir.path() / "program").string();
+    std::vector<std::string> command { "cc", optimisation, "-o", binary };
+    for (const auto& file : files) {
+      const auto path = dir.path() / file.name;
+      std::ofstream(path, std::ios::binary) << file.text;
+      command.push_back(path.string());
+    }
+    if (spawn(std::move(command)) != 0) return build_failed;
+
+    const int status = spawn({ binary });
+    return status < 0 ? no_exit_status : status;
+  }
+
+  // Builds the unit (C or assembly, by extension) with a driver calling
+  // argon_f<i>() and returns how many functions disagreed with the expected
+  // values, or the negative status from compile_and_run()
+  inline auto run_mismatches(const std::string& unit, const std::string& extension,
+                             const std::vector<int32_t>& expected, const std::string& optimisation) -> int {
+    std::string driver = "#include <stdint.h>\n";
+    for (size_t i = 0; i < expected.size(); ++i) driver += "int32_t argon_f" + std::to_string(i) + "(void);\n";
+    driver += "int main(void) {\n  int bad = 0;\n";
+    for (size_t i = 0; i < expected.size(); ++i) {
+      driver += "  bad += argon_f" + std::to_string(i) + "() != (int32_t)" + std::to_string(static_cast<int64_t>(expected[i])) + ";\n";
+    }
+    driver += "  return bad;\n}\n";
+
+    return compile_and_run({ { "unit." + extension, unit }, { "driver.c", driver } }, optimisation);
+  }
+
+}
@@ -0,0 +1,114 @@
+#include "IncrementalUnit.hh"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace argc::incr;
+
+namespace {
+
+// The "compiler" echoes its line, so a result can be checked against the text it was built from
+struct Echo {
+  std::string text;
+  auto operator==(const Echo&) const -> bool = default;
+};
+
+class IncrementalUnitTest : public ::testing::Test {
+protected:
+  size_t compiles = 0;
+  IncrementalUnit<Echo> unit{ [this](const std::string_view line) { ++compiles; return Echo{ std::string(line) }; } };
+
+  // Incremental state must match compiling the same text from scratch
+  auto expect_matches_full_compile() const -> void {
+    IncrementalUnit<Echo> full{ [](const std::string_view line) { return Echo{ std::string(line) }; } };
+    full.reset(unit.text());
+    ASSERT_EQ(unit.entries().size(), full.entries().size());
+    for (size_t i = 0; i < full.entries().size(); ++i) {
+      EXPECT_EQ(unit.entries()[i].segment, full.entries()[i].segment) << "entry " << i;
+      EXPECT_EQ(unit.entries()[i].result, full.entries()[i].result) << "entry " << i;
+    }
+  }
+};
+
+}
+
+TEST(IncrementalTextTest, DiffTrimsCommonPrefixAndSuffix) {
+  const auto edit = diff_text("ret 1 + 2\n", "ret 1 + 20\n");
+  EXPECT_EQ(edit.offset, 9u);
+  EXPECT_EQ(edit.removed, 0u);
+  EXPECT_EQ(edit.inserted, 1u);
+
+  // Repeated characters must not let prefix and suffix overlap
+  const auto repeat = diff_text("aaaa", "aa");
+  EXPECT_EQ(repeat.offset, 2u);
+  EXPECT_EQ(repeat.removed, 2u);
+  EXPECT_EQ(repeat.inserted, 0u);
+
+  EXPECT_TRUE(diff_text("same", "same").empty());
+}
+
+TEST(IncrementalTextTest, SegmentsSkipBlankLinesAndCountLines) {
+  const auto segments = segment_lines("module m\n\n  \n1 + 2\r\nret 3");
+  ASSERT_EQ(segments.size(), 3u);
+  EXPECT_EQ(segments[0], (Segment{ 0, 8, 1 }));
+  EXPECT_EQ(segments[1], (Segment{ 13, 18, 4 }));
+  EXPECT_EQ(segments[2], (Segment{ 20, 25, 5 }));
+}
+
+TEST_F(IncrementalUnitTest, SingleLineEditRecompilesOneSegment) {
+  std::string text = "module m\n";
+  for (int i = 0; i < 1000; ++i) text += std::to_string(i) + " * 3\n";
+  unit.reset(text);
+  compiles = 0;
+
+  const auto at = text.find("500 * 3");
+  text.replace(at, 7, "500 / 7");
+  const auto stats = unit.update(text);
+
+  EXPECT_EQ(compiles, 1u);
+  EXPECT_EQ(stats.removed, 1u);
+  EXPECT_EQ(stats.compiled, 1u);
+  EXPECT_EQ(stats.reused, 1000u);
+  expect_matches_full_compile();
+}
+
+TEST_F(IncrementalUnitTest, InsertedLinesShiftLaterSegments) {
+  unit.reset("module m\n1\n2\nret 3\n");
+  compiles = 0;
+
+  unit.update("module m\n1\n\n\n10\n20\n2\nret 3\n");
+  EXPECT_EQ(compiles, 2u);
+  expect_matches_full_compile();
+  EXPECT_EQ(unit.entries().back().segment.line, 8u);
+}
+
+TEST_F(IncrementalUnitTest, JoiningAndSplittingLines) {
+  unit.reset("module m\n1 +\n2\nret 3\n");
+  unit.update("module m\n1 +2\nret 3\n");
+  expect_matches_full_compile();
+  unit.update("module m\n1\n+\n2\nret 3\n");
+  expect_matches_full_compile();
+  unit.update("");
+  expect_matches_full_compile();
+  unit.update("ret 1");
+  expect_matches_full_compile();
+}
+
+TEST_F(IncrementalUnitTest, RandomEditsMatchFullCompile) {
+  std::mt19937 rng(1234);
+  const std::string alphabet = "12 +*\n\n\r\t";
+  std::string text = "module m\nimport a\n";
+  for (int i = 0; i < 50; ++i) text += "ret " + std::to_string(i) + "\n";
+  unit.reset(text);
+
+  for (int round = 0; round < 2000; ++round) {
+    const size_t at = std::uniform_int_distribution<size_t>(0, text.size())(rng);
+    const size_t erase = std::min(text.size() - at, std::uniform_int_distribution<size_t>(0, 6)(rng));
+    std::string insert;
+    for (size_t n = std::uniform_int_distribution<size_t>(0, 6)(rng); n > 0; --n) {
+      insert += alphabet[std::uniform_int_distribution<size_t>(0, alphabet.size() - 1)(rng)];
+    }
+    text.replace(at, erase, insert);
+    unit.update(text);
+    ASSERT_NO_FATAL_FAILURE(expect_matches_full_compile()) << "round " << round;
+  }
+}
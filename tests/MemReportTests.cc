@@ -0,0 +1,129 @@
+#include "MemReport.hh"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+using namespace argc;
+using namespace argc::mem;
+
+namespace {
+
+  constexpr size_t parsing = static_cast<size_t>(err::CompileStage::Parsing);
+  constexpr size_t symbols = static_cast<size_t>(err::CompileStage::SymbolCollection);
+
+  // Not optimised away: the hook has to see the allocation
+  [[gnu::noinline]] auto allocate(const size_t bytes) -> std::unique_ptr<char[]> {
+    auto block = std::make_unique<char[]>(bytes);
+    block[bytes - 1] = 1;
+    return block;
+  }
+
+}
+
+TEST(MemReportTest, AllocationsAreCountedPerFileAndStage) {
+  if (!tracking_available()) GTEST_SKIP() << "needs glibc";
+  start_tracking({ { "a.ar", 100 }, { "b.ar", 200 } });
+
+  {
+    FileScope file(0);
+    enter_stage(err::CompileStage::Parsing);
+    auto tree = allocate(1 << 20);
+    enter_stage(err::CompileStage::SymbolCollection);
+    auto table = allocate(1 << 16);
+    table.reset();
+    tree.reset();       // Freed under symbol collection but charged to parsing, which keeps its peak
+  }
+  std::thread([] {
+    FileScope file(1);
+    enter_stage(err::CompileStage::Parsing);
+    allocate(1 << 18);
+  }).join();
+
+  const auto report = MemoryReport::collect();
+  ASSERT_EQ(report.files.size(), 2u);
+  const auto& a = report.files[0];
+  EXPECT_EQ(a.path, "a.ar");
+  EXPECT_EQ(a.input_bytes, 100u);
+  EXPECT_GE(a.stages[parsing].allocations, 1u);
+  EXPECT_GE(a.stages[parsing].bytes, 1u << 20);
+  EXPECT_GE(a.stages[parsing].peak_live, 1 << 20);
+  EXPECT_GE(a.stages[symbols].peak_live, 1 << 16);
+  EXPECT_LT(a.stages[symbols].peak_live, 1 << 20);
+  EXPECT_GE(a.total.peak_live, (1 << 20) + (1 << 16));
+
+  const auto& b = report.files[1];
+  EXPECT_GE(b.stages[parsing].bytes, 1u << 18);
+  EXPECT_LT(b.total.bytes, 1u << 20);
+
+  const auto totals = report.stage_totals();
+  EXPECT_EQ(totals[parsing].allocations, a.stages[parsing].allocations + b.stages[parsing].allocations);
+  EXPECT_EQ(totals[parsing].peak_live, a.stages[parsing].peak_live);
+  EXPECT_GE(report.peak_live, a.total.peak_live);
+  EXPECT_GT(report.peak_rss, 0u);
+}
+
+// The build frees a dependency's symbols on whichever worker finishes its
+// last importer. The free belongs to the file that built them.
+TEST(MemReportTest, FreesAreChargedToTheAllocatingFileAndStage) {
+  if (!tracking_available()) GTEST_SKIP() << "needs glibc";
+  start_tracking({ { "a.ar", 100 }, { "b.ar", 200 } });
+
+  std::unique_ptr<char[]> table;
+  {
+    FileScope file(0);
+    enter_stage(err::CompileStage::SymbolCollection);
+    table = allocate(1 << 20);
+  }
+  std::thread([&table] {
+    FileScope file(1);
+    enter_stage(err::CompileStage::Parsing);
+    table.reset();
+    auto tree = allocate(1 << 16);
+  }).join();
+  {
+    FileScope file(0);
+    enter_stage(err::CompileStage::SymbolCollection);
+    auto again = allocate(1 << 20);
+  }
+
+  const auto report = MemoryReport::collect();
+  const auto& a = report.files[0];
+  const auto& b = report.files[1];
+  EXPECT_GE(a.stages[symbols].peak_live, 1 << 20);
+  EXPECT_LT(a.stages[symbols].peak_live, 2 << 20);      // The first table was gone before the second
+  EXPECT_GE(b.stages[parsing].peak_live, 1 << 16);
+  EXPECT_LT(b.total.peak_live, 1 << 20);
+}
+
+TEST(MemReportTest, AllocationsOutsideAFileGoToTheDriver) {
+  if (!tracking_available()) GTEST_SKIP() << "needs glibc";
+  start_tracking({ { "a.ar", 1 } });
+  allocate(4096);
+  const auto report = MemoryReport::collect();
+  EXPECT_GE(report.driver.bytes, 4096u);
+  EXPECT_EQ(report.files[0].total.allocations, 0u);
+}
+
+TEST(MemReportTest, JsonListsEveryStageAndEscapesPaths) {
+  if (!tracking_available()) GTEST_SKIP() << "needs glibc";
+  start_tracking({ { "dir\\\"odd\".ar", 10 } });
+  {
+    FileScope file(0);
+    enter_stage(err::CompileStage::Lexing);
+    allocate(64);
+  }
+
+  char* text = nullptr;
+  size_t length = 0;
+  std::FILE* out = open_memstream(&text, &length);
+  MemoryReport::collect().write_json(out);
+  std::fclose(out);
+  const std::string json(text, length);
+  std::free(text);
+
+  EXPECT_NE(json.find(R"("path": "dir\\\"odd\".ar")"), std::string::npos);
+  for (const char* key : { "\"lexing\"", "\"code_generation\"", "\"other\"", "\"peak_rss_bytes\"", "\"driver\"" }) {
+    EXPECT_NE(json.find(key), std::string::npos) << key;
+  }
+}
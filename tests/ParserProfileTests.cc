@@ -0,0 +1,95 @@
+#include "ParserProfile.hh"
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace argc;
+
+namespace {
+
+auto decision(const size_t number, const std::string& rule, const uint64_t invocations,
+              const uint64_t time_ns, const uint64_t fallbacks = 0) -> DecisionProfile {
+  DecisionProfile d;
+  d.decision = number;
+  d.rule = rule;
+  d.invocations = invocations;
+  d.sll_lookahead = invocations * 2;
+  d.sll_max_lookahead = 3;
+  d.ll_fallbacks = fallbacks;
+  d.time_ns = time_ns;
+  return d;
+}
+
+auto capture(const ParserProfile& profile, const bool json) -> std::string {
+  std::FILE* file = std::tmpfile();
+  json ? profile.write_json(file) : profile.write_text(file);
+  std::rewind(file);
+  std::string text;
+  for (int c; (c = std::fgetc(file)) != EOF;) text += static_cast<char>(c);
+  std::fclose(file);
+  return text;
+}
+
+}
+
+TEST(ParserProfileTest, MergesParsesPerDecision) {
+  ParserProfile profile;
+  profile.record({ decision(2, "expression", 10, 500, 1), decision(0, "moduleDeclaration", 1, 50) });
+  auto second = decision(2, "expression", 5, 300, 2);
+  second.sll_max_lookahead = 7;
+  profile.record({ second });
+
+  const auto ranked = profile.ranked();
+  ASSERT_EQ(ranked.size(), 2u);
+  EXPECT_EQ(profile.parses(), 2u);
+  EXPECT_EQ(ranked[0].rule, "expression");
+  EXPECT_EQ(ranked[0].invocations, 15u);
+  EXPECT_EQ(ranked[0].ll_fallbacks, 3u);
+  EXPECT_EQ(ranked[0].sll_max_lookahead, 7u);
+  EXPECT_EQ(ranked[0].time_ns, 800u);
+  EXPECT_DOUBLE_EQ(ranked[0].mean_lookahead(), 2.0);
+}
+
+TEST(ParserProfileTest, RanksByTimeThenFallbacks) {
+  ParserProfile profile;
+  profile.record({ decision(0, "a", 1, 100), decision(1, "b", 1, 900), decision(2, "c", 1, 100, 4),
+                   decision(3, "unused", 0, 0) });
+
+  const auto ranked = profile.ranked();
+  ASSERT_EQ(ranked.size(), 3u);
+  EXPECT_EQ(ranked[0].rule, "b");
+  EXPECT_EQ(ranked[1].rule, "c");
+  EXPECT_EQ(ranked[2].rule, "a");
+}
+
+TEST(ParserProfileTest, RecordsFromSeveralThreads) {
+  ParserProfile profile;
+  std::vector<std::jthread> workers;
+  for (int t = 0; t < 4; ++t) {
+    workers.emplace_back([&] {
+      for (int i = 0; i < 100; ++i) profile.record({ decision(1, "statement", 1, 10) });
+    });
+  }
+  workers.clear();
+
+  EXPECT_EQ(profile.parses(), 400u);
+  EXPECT_EQ(profile.ranked().front().invocations, 400u);
+}
+
+TEST(ParserProfileTest, WritesTextAndJson) {
+  ParserProfile profile;
+  EXPECT_EQ(capture(profile, true), "{\n  \"parses\": 0,\n  \"decisions\": []\n}\n");
+
+  profile.record({ decision(4, "expression", 3, 2'000'000, 1), decision(1, "statement", 2, 1'000'000) });
+
+  const auto text = capture(profile, false);
+  EXPECT_NE(text.find("1 parse(s), 2 decision(s) predicted, 3.000 ms"), std::string::npos);
+  EXPECT_LT(text.find("expression"), text.find("statement"));
+
+  const auto json = capture(profile, true);
+  EXPECT_NE(json.find("\"decision\": 4, \"rule\": \"expression\", \"invocations\": 3"), std::string::npos);
+  EXPECT_NE(json.find("\"ll_fallbacks\": 1"), std::string::npos);
+  EXPECT_EQ(json.back(), '\n');
+}
@@ -0,0 +1,195 @@
+#include "ModuleScanner.hh"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Runs the real compiler over generated worst-case inputs: each shape at
+// sizes n and 8n must cost roughly 8x, not 64x, and must finish under a
+// stack far smaller than the default, so no pass may recurse once per node.
+
+namespace fs = std::filesystem;
+
+namespace {
+
+  constexpr rlim_t stack_limit = 2 << 20;
+
+  struct Outcome {
+    bool exited { false };        // False if killed by a signal
+    int status { -1 };
+    double seconds { 0.0 };
+  };
+
+  class PathologicalInputTest : public ::testing::Test {
+  protected:
+    fs::path dir = fs::temp_directory_path() / ("argc_pathological_" + std::to_string(getpid()));
+
+    void SetUp() override { fs::create_directories(dir); }
+    void TearDown() override { fs::remove_all(dir); }
+
+    auto compile_once(const fs::path& input) const -> Outcome {
+      const auto start = std::chrono::steady_clock::now();
+      const pid_t child = fork();
+      if (child == 0) {
+        const rlimit stack { stack_limit, stack_limit };
+        setrlimit(RLIMIT_STACK, &stack);      // Applies to the exec'd image and its threads
+        if (chdir(dir.c_str()) != 0) _exit(127);   // compiler_errors.log lands here
+        const int null = open("/dev/null", O_WRONLY);
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+        execl(ARGC_BINARY, "argc", input.c_str(), "--emit=asm", "-o", "out.s", static_cast<char*>(nullptr));
+        _exit(127);
+      }
+      int status = 0;
+      waitpid(child, &status, 0);
+      const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+      return Outcome{ WIFEXITED(status), WIFEXITED(status) ? WEXITSTATUS(status) : WTERMSIG(status), elapsed.count() };
+    }
+
+    // Best of three, to keep scheduler noise out of the ratios
+    auto compile(const std::string& name, const std::string& source) const -> Outcome {
+      const auto input = dir / (name + ".ar");
+      std::ofstream(input, std::ios::binary) << source;
+      Outcome best = compile_once(input);
+      for (int i = 0; i < 2 && best.exited; ++i) {
+        const auto again = compile_once(input);
+        if (!again.exited) return again;
+        best.seconds = std::min(best.seconds, again.seconds);
+      }
+      return best;
+    }
+
+    // Compiles the shape at n and 8n, expecting exit_status from both
+    auto expect_linear(const std::string& name, const std::function<std::string(size_t)>& generate,
+                       const size_t n, const int exit_status) const -> void {
+      const auto baseline = compile("baseline", "module m\n1\n");
+      ASSERT_TRUE(baseline.exited && baseline.status == 0) << "argc does not run: " << ARGC_BINARY;
+
+      const auto small = compile(name + "_small", generate(n));
+      const auto large = compile(name + "_large", generate(8 * n));
+      ASSERT_TRUE(small.exited) << name << " killed by signal " << small.status;
+      ASSERT_TRUE(large.exited) << name << " killed by signal " << large.status;
+      EXPECT_EQ(small.status, exit_status) << name;
+      EXPECT_EQ(large.status, exit_status) << name;
+
+      // Linear is 8x; quadratic would be 64x. The floor keeps a fast small
+      // run from turning timer noise into a ratio.
+      const double small_cost = std::max(small.seconds - baseline.seconds, 0.02);
+      const double large_cost = large.seconds - baseline.seconds;
+      EXPECT_LT(large_cost, 16.0 * small_cost)
+        << name << ": " << small.seconds << "s at n=" << n << ", " << large.seconds << "s at 8n";
+    }
+  };
+
+  auto module_of(const std::string& body) -> std::string {
+    return "module m\n" + body;
+  }
+
+  // 1 + 1 + ... + 1, a left-deep tree one level per operator
+  auto addition_chain(const size_t terms) -> std::string {
+    std::string body = "1";
+    body.reserve(terms * 4 + 2);
+    for (size_t i = 0; i < terms; ++i) body += i % 2 ? " - 1" : " + 1";
+    return module_of(body + "\n");
+  }
+
+  auto nested(const size_t depth) -> std::string {
+    return std::string(depth, '(') + "2 * 3" + std::string(depth, ')');
+  }
+
+  // 1 + (1 - (1 * (...))): each parenthesis opens as an operator's right
+  // operand, the deepest the generated parser goes per level (operand
+  // expression, atom, inner expression) where bare parentheses take two
+  auto nested_operands(const size_t depth) -> std::string {
+    std::string open;
+    open.reserve(depth * 5);
+    for (size_t i = 0; i < depth; ++i) {
+      open += "1 ";
+      open += "+-*"[i % 3];
+      open += " (";
+    }
+    return open + "2" + std::string(depth, ')');
+  }
+
+  auto statements(const size_t count) -> std::string {
+    std::string body;
+    for (size_t i = 0; i < count; ++i) body += i % 2 ? "(1 + 2) * 3\n" : "ret 4 / (5 - 3)\n";
+    return module_of(body);
+  }
+
+  auto nested_statements(const size_t count) -> std::string {
+    std::string body;
+    const auto bare = nested(argc::build::max_paren_nesting) + "\n";
+    const auto operands = nested_operands(argc::build::max_paren_nesting) + "\n";
+    for (size_t i = 0; i < count; ++i) body += i % 2 ? operands : bare;
+    return module_of(body);
+  }
+
+  // Every statement truncated: the parser recovers at each line, and the
+  // driver must still fail the module
+  auto syntax_errors(const size_t count) -> std::string {
+    std::string body;
+    for (size_t i = 0; i < count; ++i) body += i % 2 ? "ret (1 +\n" : "2 * * 3\n";
+    return module_of(body);
+  }
+
+  auto empty_lines(const size_t lines) -> std::string {
+    const std::string blank(lines / 2, '\n');
+    return module_of(blank + "1 + 2\n" + blank);
+  }
+
+  auto huge_literal(const size_t digits) -> std::string {
+    return module_of(std::string(digits, '9') + " + 1\n");
+  }
+
+}
+
+TEST_F(PathologicalInputTest, LongAdditionChainsScaleLinearly) {
+  expect_linear("chain", addition_chain, 25'000, 0);
+}
+
+TEST_F(PathologicalInputTest, ManyStatementsScaleLinearly) {
+  expect_linear("statements", statements, 5'000, 0);
+}
+
+TEST_F(PathologicalInputTest, NestingAtTheLimitScalesLinearly) {
+  expect_linear("nested", nested_statements, 50, 0);
+}
+
+TEST_F(PathologicalInputTest, SyntaxErrorsFailTheBuildInLinearTime) {
+  expect_linear("syntax_errors", syntax_errors, 2'000, 1);
+}
+
+TEST_F(PathologicalInputTest, MillionsOfEmptyLinesScaleLinearly) {
+  expect_linear("empty_lines", empty_lines, 500'000, 0);
+}
+
+TEST_F(PathologicalInputTest, HugeLiteralsAreRejectedInLinearTime) {
+  expect_linear("literal", huge_literal, 200'000, 1);
+}
+
+TEST_F(PathologicalInputTest, NestingPastTheLimitIsRejectedBeforeParsing) {
+  for (const size_t depth : { argc::build::max_paren_nesting + 1, size_t{ 1'000'000 } }) {
+    const auto run = compile("too_deep", module_of(nested(depth) + "\n"));
+    ASSERT_TRUE(run.exited) << "depth " << depth << " killed by signal " << run.status;
+    EXPECT_EQ(run.status, 1) << "depth " << depth;
+  }
+  const auto operands = compile("too_deep_operands", module_of(nested_operands(argc::build::max_paren_nesting + 1) + "\n"));
+  ASSERT_TRUE(operands.exited) << "killed by signal " << operands.status;
+  EXPECT_EQ(operands.status, 1);
+}
+
+TEST(ParenNestingTest, ReportsTheDeepestPointAcrossLines) {
+  const auto nesting = argc::build::paren_nesting("module m\n(1 + (2\n) * ((3)))\n");
+  EXPECT_EQ(nesting.depth, 3u);
+  EXPECT_EQ(nesting.line, 3u);
+  EXPECT_EQ(nesting.column, 6u);
+  EXPECT_EQ(argc::build::paren_nesting(")))(").depth, 1u);
+}
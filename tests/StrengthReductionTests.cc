@@ -0,0 +1,146 @@
+#include "StrengthReduction.hh"
+#include <gtest/gtest.h>
+#include <array>
+#include <cstdlib>
+#include <limits>
+#include <random>
+
+using namespace argc::codegen;
+
+namespace {
+
+constexpr int32_t kMin = std::numeric_limits<int32_t>::min();
+constexpr int32_t kMax = std::numeric_limits<int32_t>::max();
+
+// Truncating division with INT32_MIN / -1 wrapping, as the generated code does
+auto reference_div(const int32_t n, const int32_t d) -> int32_t {
+  return static_cast<int32_t>(static_cast<uint32_t>(static_cast<int64_t>(n) / d));
+}
+
+auto reference_mul(const int32_t x, const int32_t c) -> int32_t {
+  return static_cast<int32_t>(static_cast<uint32_t>(x) * static_cast<uint32_t>(c));
+}
+
+// Edge dividends around zero, the extremes and the rounding boundaries of d
+auto dividends_for(const int32_t d) -> std::vector<int32_t> {
+  std::vector<int32_t> values { 0, 1, -1, 2, -2, kMin, kMin + 1, kMax, kMax - 1 };
+  const int64_t ad = d < 0 ? -static_cast<int64_t>(d) : d;
+  for (const int64_t k : {1ll, 2ll, 3ll, 1000ll}) {
+    for (const int64_t delta : {-1ll, 0ll, 1ll}) {
+      const int64_t v = ad * k + delta;
+      if (v <= kMax) {
+        values.push_back(static_cast<int32_t>(v));
+        values.push_back(static_cast<int32_t>(-v));
+      }
+    }
+  }
+  return values;
+}
+
+auto check_divisor(const int32_t d, std::mt19937& rng) -> void {
+  const auto plan = plan_signed_division(d);
+  ASSERT_NE(plan.kind, DivisionPlan::Kind::Hardware) << "d = " << d;
+
+  for (const int32_t n : dividends_for(d)) {
+    ASSERT_EQ(evaluate(plan, n), reference_div(n, d)) << n << " / " << d;
+  }
+  std::uniform_int_distribution<int32_t> any(kMin, kMax);
+  for (int i = 0; i < 16; ++i) {
+    const int32_t n = any(rng);
+    ASSERT_EQ(evaluate(plan, n), reference_div(n, d)) << n << " / " << d;
+  }
+}
+
+}
+
+TEST(StrengthReductionTest, MagicNumbersMatchHackersDelight) {
+  EXPECT_EQ(signed_magic(3).multiplier, 0x55555556);
+  EXPECT_EQ(signed_magic(3).shift, 0);
+  EXPECT_EQ(signed_magic(7).multiplier, static_cast<int32_t>(0x92492493));
+  EXPECT_EQ(signed_magic(7).shift, 2);
+  EXPECT_EQ(signed_magic(-5).multiplier, static_cast<int32_t>(0x99999999));
+  EXPECT_EQ(signed_magic(-5).shift, 1);
+}
+
+TEST(StrengthReductionTest, DivisionPlanKinds) {
+  EXPECT_EQ(plan_signed_division(0).kind, DivisionPlan::Kind::Hardware);
+  EXPECT_EQ(plan_signed_division(1).kind, DivisionPlan::Kind::Identity);
+  EXPECT_EQ(plan_signed_division(-1).kind, DivisionPlan::Kind::Negate);
+  EXPECT_EQ(plan_signed_division(16).kind, DivisionPlan::Kind::PowerOfTwo);
+  EXPECT_EQ(plan_signed_division(kMin).kind, DivisionPlan::Kind::PowerOfTwo);
+  EXPECT_EQ(plan_signed_division(10).kind, DivisionPlan::Kind::Magic);
+}
+
+TEST(StrengthReductionTest, SmallDivisorsExhaustive) {
+  std::mt19937 rng(42);
+  for (int32_t d = -65536; d <= 65536; ++d) {
+    if (d == 0) continue;
+    check_divisor(d, rng);
+  }
+}
+
+TEST(StrengthReductionTest, LargeAndBoundaryDivisors) {
+  std::mt19937 rng(7);
+  for (int k = 1; k < 31; ++k) {
+    const int32_t p = 1 << k;
+    for (const int32_t d : {p - 1, p, p + 1, -(p - 1), -p, -(p + 1)}) {
+      if (d != 0) check_divisor(d, rng);
+    }
+  }
+  for (const int32_t d : {kMin, kMin + 1, kMax, kMax - 1, 641, 6700417, -1000000007}) {
+    check_divisor(d, rng);
+  }
+
+  std::uniform_int_distribution<int32_t> any(kMin, kMax);
+  for (int i = 0; i < 200000; ++i) {
+    const int32_t d = any(rng);
+    if (d != 0) check_divisor(d, rng);
+  }
+}
+
+// With the dividend's sign known the fixups are dropped; the result must not change
+TEST(StrengthReductionTest, NonNegativeDividendSkipsRounding) {
+  std::mt19937 rng(3);
+  std::uniform_int_distribution<int32_t> any(kMin, kMax), nonneg(0, kMax);
+  for (int i = 0; i < 200000; ++i) {
+    const int32_t d = i < 20000 ? (i % 2 ? 1 : -1) * (i / 2 + 2) : any(rng);
+    if (d == 0) continue;
+    const auto plan = plan_signed_division(d, true);
+    for (const int32_t n : {0, 1, kMax, kMax - 1, std::abs(d == kMin ? 0 : d), nonneg(rng)}) {
+      ASSERT_EQ(evaluate(plan, n), reference_div(n, d)) << n << " / " << d;
+    }
+  }
+}
+
+// Every 32-bit divisor; minutes of runtime, run with --gtest_also_run_disabled_tests
+TEST(StrengthReductionTest, DISABLED_AllThirtyTwoBitDivisors) {
+  std::mt19937 rng(1);
+  for (int64_t d = kMin; d <= kMax; ++d) {
+    if (d != 0) check_divisor(static_cast<int32_t>(d), rng);
+  }
+}
+
+TEST(StrengthReductionTest, MultiplicationRecipesAreExact) {
+  const std::array<int32_t, 11> xs { 0, 1, -1, 7, -7, 12345, -99991, kMin, kMax, kMin + 3, 1 << 20 };
+  for (int32_t c = -4096; c <= 4096; ++c) {
+    const auto recipe = plan_multiplication(c);
+    for (const int32_t x : xs) {
+      ASSERT_EQ(evaluate(recipe, x), reference_mul(x, c)) << x << " * " << c;
+    }
+  }
+  for (int k = 0; k < 32; ++k) {
+    const auto c = static_cast<int32_t>(1u << k);
+    const auto recipe = plan_multiplication(c);
+    EXPECT_FALSE(recipe.use_imul) << c;
+    for (const int32_t x : xs) ASSERT_EQ(evaluate(recipe, x), reference_mul(x, c));
+  }
+}
+
+TEST(StrengthReductionTest, CommonMultipliersAvoidImul) {
+  for (const int32_t c : {0, 1, 2, 3, 5, 9, 10, 12, 15, 24, 25, 40, 45, 81, 7, 31, -1, -3, 1023}) {
+    const auto recipe = plan_multiplication(c);
+    EXPECT_FALSE(recipe.use_imul) << c;
+    EXPECT_LE(recipe.steps.size(), 2u) << c;
+  }
+  EXPECT_TRUE(plan_multiplication(12345).use_imul);
+}
@@ -6,18 +6,18 @@ using namespace argc;
 class SymbolTableTest : public ::testing::Test {
 protected:
   SymbolTable table;
-  std::shared_ptr<Type> intType;
-  std::shared_ptr<Type> boolType;
+  const Type* intType = nullptr;
+  const Type* boolType = nullptr;
   loc::SourceLocation dummyLoc{0, 0, ""};
 
   void SetUp() override {
-    intType = std::make_shared<PrimitiveType>("i32");
-    boolType = std::make_shared<PrimitiveType>("bool");
+    intType = table.make_type<PrimitiveType>("i32");
+    boolType = table.make_type<PrimitiveType>("bool");
   }
 };
 
 TEST_F(SymbolTableTest, InsertAndLookupSymbolInGlobalScope) {
-  auto sym = std::make_shared<SymbolEntry>("x", SymbolKind::VARIABLE, intType, 0, dummyLoc);
+  auto* sym = table.make_symbol("x", SymbolKind::VARIABLE, intType, dummyLoc);
   ASSERT_TRUE(table.insert(sym));
 
   auto found = table.lookup("x");
@@ -27,10 +27,10 @@ TEST_F(SymbolTableTest, InsertAndLookupSymbolInGlobalScope) {
 }
 
 TEST_F(SymbolTableTest, SymbolShadowingAcrossScopes) {
-  table.insert(std::make_shared<SymbolEntry>("x", SymbolKind::VARIABLE, intType, 0, dummyLoc));
+  table.insert(table.make_symbol("x", SymbolKind::VARIABLE, intType, dummyLoc));
 
   table.enter_scope("func_main");
-  auto innerSym = std::make_shared<SymbolEntry>("x", SymbolKind::VARIABLE, boolType, 1, dummyLoc);
+  auto* innerSym = table.make_symbol("x", SymbolKind::VARIABLE, boolType, dummyLoc);
   ASSERT_TRUE(table.insert(innerSym));
 
   auto found = table.lookup("x");
@@ -51,15 +51,15 @@ TEST_F(SymbolTableTest, LookupFailsForUndeclaredSymbol) {
 }
 
 TEST_F(SymbolTableTest, InsertFailsOnDuplicateInSameScope) {
-  auto sym1 = std::make_shared<SymbolEntry>("x", SymbolKind::VARIABLE, intType, 0, dummyLoc);
-  auto sym2 = std::make_shared<SymbolEntry>("x", SymbolKind::VARIABLE, boolType, 0, dummyLoc);
+  auto* sym1 = table.make_symbol("x", SymbolKind::VARIABLE, intType, dummyLoc);
+  auto* sym2 = table.make_symbol("x", SymbolKind::VARIABLE, boolType, dummyLoc);
 
   EXPECT_TRUE(table.insert(sym1));
   EXPECT_FALSE(table.insert(sym2)); // should fail
 }
 
 TEST_F(SymbolTableTest, StructTypeAndFieldStorage) {
-  auto structType = std::make_shared<StructType>("MyStruct");
+  auto* structType = table.make_type<StructType>("MyStruct");
 
   TypeTable ttable;
   ttable.insert(structType);
@@ -69,3 +69,100 @@ TEST_F(SymbolTableTest, StructTypeAndFieldStorage) {
   EXPECT_EQ(retrieved->name(), "MyStruct");
   EXPECT_EQ(retrieved->kind(), TypeKind::STRUCT);
 }
+
+TEST_F(SymbolTableTest, ImportModuleExposesItsScope) {
+  SymbolTable util;
+  auto* module = util.make_symbol("util", SymbolKind::MODULE, util.make_type<ModuleType>("module"), dummyLoc);
+  ASSERT_TRUE(util.insert(module));
+  util.enter_scope("util");
+  util.insert(util.make_symbol("helper", SymbolKind::FUNCTION, intType, dummyLoc));
+  util.exit_scope();
+
+  table.enter_scope("app");
+  ASSERT_TRUE(table.import_module("util", util));
+  EXPECT_FALSE(table.import_module("util", util)); // already imported
+
+  auto imported = table.lookup("util");
+  ASSERT_NE(imported, nullptr);
+  EXPECT_EQ(imported->kind(), SymbolKind::MODULE);
+  EXPECT_TRUE(imported->is_imported());
+
+  auto helper = table.lookup_qualified("util", "helper");
+  ASSERT_NE(helper, nullptr);
+  EXPECT_EQ(helper->kind(), SymbolKind::FUNCTION);
+  EXPECT_EQ(table.lookup_qualified("util", "missing"), nullptr);
+  EXPECT_FALSE(table.import_module("other", util));
+
+  EXPECT_TRUE(table.remove_import("util"));
+  EXPECT_EQ(table.lookup("util"), nullptr);
+  EXPECT_EQ(table.lookup_qualified("util", "helper"), nullptr);
+  EXPECT_FALSE(table.remove_import("util"));
+  EXPECT_TRUE(table.import_module("util", util));
+}
+
+TEST_F(SymbolTableTest, ArenaOwnsSymbolsAcrossMoves) {
+  table.enter_scope("module");
+  for (int i = 0; i < 1000; ++i) {
+    table.insert(table.make_symbol("s" + std::to_string(i), SymbolKind::VARIABLE, intType, dummyLoc));
+  }
+  auto* first = table.lookup("s0");
+  ASSERT_NE(first, nullptr);
+
+  SymbolTable moved = std::move(table);
+  EXPECT_EQ(moved.lookup("s0"), first);
+  EXPECT_EQ(moved.lookup("s999")->type(), intType);
+  EXPECT_GT(moved.memory_stats().allocations, 1000u);
+  EXPECT_EQ(moved.current_scope_name(), "module");
+}
+
+TEST_F(SymbolTableTest, ResetKeepsTheArenaMemory) {
+  table.enter_scope("module");
+  for (int i = 0; i < 5000; ++i) {
+    table.insert(table.make_symbol("s" + std::to_string(i), SymbolKind::VARIABLE, intType, dummyLoc));
+  }
+  const auto grown = table.memory_stats();
+  ASSERT_GT(grown.blocks, 1u);
+
+  table.reset();
+  EXPECT_EQ(table.current_scope_name(), "global");
+  EXPECT_EQ(table.lookup("s0"), nullptr);
+  EXPECT_EQ(table.module_scope("module"), nullptr);
+  EXPECT_EQ(table.memory_stats().blocks, 1u);
+
+  // A module smaller than the largest chunk fits without growing
+  table.enter_scope("module");
+  auto* type = table.make_type<PrimitiveType>("i32");
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_TRUE(table.insert(table.make_symbol("t" + std::to_string(i), SymbolKind::VARIABLE, type, dummyLoc)));
+  }
+  EXPECT_EQ(table.memory_stats().blocks, 1u);
+  EXPECT_EQ(table.lookup("t99")->type(), type);
+
+  SymbolTable moved = std::move(table);
+  table.reset();
+  EXPECT_EQ(table.current_scope_name(), "global");
+  EXPECT_EQ(moved.lookup("t0")->type(), type);
+}
+
+TEST(SymbolTableLifetimeTest, EmptyTablesHoldNoMemory) {
+  std::vector<SymbolTable> placeholders(64);
+  for (const auto& t : placeholders) {
+    EXPECT_EQ(t.memory_stats().reserved, 0u);
+    EXPECT_EQ(t.lookup("anything"), nullptr);
+    EXPECT_EQ(t.current_scope_name(), "global");
+  }
+
+  auto& table = placeholders.front();
+  const auto* type = table.make_type<PrimitiveType>("i32");
+  ASSERT_TRUE(table.insert(table.make_symbol("x", SymbolKind::VARIABLE, type, loc::SourceLocation{0, 0, ""})));
+  EXPECT_GT(table.memory_stats().reserved, 0u);
+
+  // Releasing by assignment frees the arena without allocating another
+  SymbolTable kept = std::move(table);
+  EXPECT_EQ(table.memory_stats().reserved, 0u);
+  EXPECT_EQ(table.lookup("x"), nullptr);
+  EXPECT_EQ(kept.lookup("x")->type(), type);
+  kept = SymbolTable{};
+  EXPECT_EQ(kept.memory_stats().reserved, 0u);
+  EXPECT_FALSE(kept.import_module("m", table));
+}
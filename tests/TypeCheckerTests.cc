@@ -0,0 +1,154 @@
+#include "TypeChecker.hh"
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+
+using namespace argc;
+using namespace argc::sema;
+
+class TypeCheckerTest : public ::testing::Test {
+protected:
+  err::ErrorReporter reporter{false, 100};
+  ir::Module module{ "test", {}, {} };
+
+  void SetUp() override { reporter.setEcho(false); }
+
+  auto statement(const ir::NodeId first, const ir::NodeId root) -> void {
+    module.statements.push_back(ir::Statement{
+      ir::StmtKind::Expression, first, root, static_cast<uint32_t>(module.statements.size() + 1) });
+  }
+
+  auto binary(const ir::Op op, const int64_t a, const int64_t b) -> ir::NodeId {
+    auto& exprs = module.exprs;
+    const auto first = static_cast<ir::NodeId>(exprs.size());
+    const auto lhs = exprs.make_const(a);
+    const auto rhs = exprs.make_const(b);
+    const auto root = exprs.make_binary(op, lhs, rhs);
+    statement(first, root);
+    return root;
+  }
+
+  auto check() -> TypeInfo {
+    TypeChecker checker(reporter, "test.ar");
+    return checker.check(module).value();
+  }
+};
+
+TEST_F(TypeCheckerTest, LiteralsTakeTheNarrowestWidth) {
+  const auto a = binary(ir::Op::Add, 100, 27);
+  const auto b = binary(ir::Op::Add, 100, 28);
+  const auto c = binary(ir::Op::Mul, 256, 128);
+  const auto d = binary(ir::Op::Sub, -32768, 1);
+
+  const auto info = check();
+  EXPECT_EQ(info.type(a), IntType::I8);
+  EXPECT_EQ(info.type(b), IntType::I16);
+  EXPECT_EQ(info.type(c), IntType::I32);
+  EXPECT_EQ(info.type(d), IntType::I32);
+  EXPECT_EQ(info.range(c).lo, 32768);
+  EXPECT_TRUE(info.range(c).is_constant());
+  EXPECT_EQ(reporter.errorCount(), 0u);
+
+  EXPECT_EQ(info.stats.nodes, module.exprs.size());
+  EXPECT_EQ(info.stats.by_type[0] + info.stats.by_type[1] + info.stats.by_type[2], info.stats.nodes);
+}
+
+TEST_F(TypeCheckerTest, DivisionTruncatesTowardZero) {
+  const auto q = binary(ir::Op::Div, -7, 2);
+  const auto info = check();
+  EXPECT_EQ(info.range(q).lo, -3);
+  EXPECT_EQ(info.range(q).hi, -3);
+  EXPECT_FALSE(info.range(q).is_nonnegative());
+}
+
+TEST_F(TypeCheckerTest, WrappingArithmeticIsReportedAndWrapped) {
+  const auto m = binary(ir::Op::Mul, 65536, 65536);
+  const auto s = binary(ir::Op::Add, std::numeric_limits<int32_t>::max(), 1);
+
+  const auto info = check();
+  EXPECT_EQ(info.range(m).lo, 0);
+  EXPECT_EQ(info.range(s).lo, std::numeric_limits<int32_t>::min());
+  EXPECT_EQ(info.type(s), IntType::I32);
+  EXPECT_EQ(info.stats.overflows, 2u);
+  EXPECT_TRUE(info.wraps(m));
+  EXPECT_FALSE(info.wraps(module.exprs.node(m).lhs));
+  EXPECT_EQ(reporter.warningCount(), 2u);
+  EXPECT_EQ(reporter.errors().front().code, err::ErrorCode::IntegerOverflow);
+  EXPECT_EQ(reporter.errors().front().message, "Integer overflow: '*' wraps around in i32");
+}
+
+TEST_F(TypeCheckerTest, ConstantDivisionByZeroIsAnError) {
+  const auto q = binary(ir::Op::Div, 10, 0);
+  const auto info = check();
+  EXPECT_EQ(reporter.errorCount() - reporter.warningCount(), 1u);
+  EXPECT_EQ(reporter.errors().front().code, err::ErrorCode::InvalidOperation);
+  EXPECT_EQ(info.type(q), IntType::I32);
+}
+
+TEST_F(TypeCheckerTest, StoppingReporterEndsAtTheFailingStatement) {
+  binary(ir::Op::Div, 10, 0);
+  binary(ir::Op::Mul, 1 << 20, 1 << 20);    // Would warn if it were reached
+  reporter.setStopOnError(true);
+
+  const auto checked = TypeChecker(reporter, "test.ar").check(module);
+  ASSERT_FALSE(checked);
+  EXPECT_EQ(checked.error().code, err::ErrorCode::InvalidOperation);
+  EXPECT_EQ(checked.error().stage, err::CompileStage::TypeChecking);
+  EXPECT_EQ(reporter.errorCount(), 1u);
+}
+
+// Every inferred range must contain the value the program computes at run time
+TEST_F(TypeCheckerTest, RangesContainEvaluatedValues) {
+  std::mt19937 rng(33);
+  std::uniform_int_distribution<int> pick_op(0, 3);
+  std::uniform_int_distribution<int64_t> pick_value(-300, 300);
+  std::vector<int32_t> values;
+
+  auto wrap = [](const int64_t v) { return static_cast<int32_t>(static_cast<uint32_t>(static_cast<uint64_t>(v))); };
+
+  for (int s = 0; s < 200; ++s) {
+    auto& exprs = module.exprs;
+    const auto first = static_cast<ir::NodeId>(exprs.size());
+    std::vector<ir::NodeId> stack;
+    for (int i = 0; i < 24; ++i) {
+      if (stack.size() < 2 || (stack.size() < 6 && pick_op(rng) == 0)) {
+        const int64_t v = pick_value(rng);
+        stack.push_back(exprs.make_const(v));
+        values.push_back(static_cast<int32_t>(v));
+        continue;
+      }
+      const auto rhs = stack.back(); stack.pop_back();
+      const auto lhs = stack.back(); stack.pop_back();
+      auto op = static_cast<ir::Op>(static_cast<int>(ir::Op::Add) + pick_op(rng));
+      if (op == ir::Op::Div && values[rhs] == 0) op = ir::Op::Sub;
+
+      const int64_t a = values[lhs];
+      const int64_t b = values[rhs];
+      int64_t result = 0;
+      switch (op) {
+        case ir::Op::Add: result = a + b; break;
+        case ir::Op::Sub: result = a - b; break;
+        case ir::Op::Mul: result = a * b; break;
+        case ir::Op::Div: result = a / b; break;
+        case ir::Op::Const: break;
+      }
+      stack.push_back(exprs.make_binary(op, lhs, rhs));
+      values.push_back(wrap(result));
+    }
+    while (stack.size() > 1) {
+      const auto rhs = stack.back(); stack.pop_back();
+      const auto lhs = stack.back(); stack.pop_back();
+      stack.push_back(exprs.make_binary(ir::Op::Add, lhs, rhs));
+      values.push_back(wrap(static_cast<int64_t>(values[lhs]) + values[rhs]));
+    }
+    statement(first, stack.back());
+  }
+
+  const auto info = check();
+  for (ir::NodeId id = 0; id < module.exprs.size(); ++id) {
+    const auto& range = info.range(id);
+    EXPECT_LE(range.lo, values[id]) << "node " << id;
+    EXPECT_GE(range.hi, values[id]) << "node " << id;
+    EXPECT_EQ(info.type(id), narrowest_type(range));
+  }
+}
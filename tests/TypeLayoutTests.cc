@@ -0,0 +1,146 @@
+#include "TypeLayout.hh"
+#include <gtest/gtest.h>
+#include <cstddef>
+#include <cstdint>
+
+using namespace argc;
+using namespace argc::layout;
+
+class TypeLayoutTest : public ::testing::Test {
+protected:
+  SymbolTable table;
+  const Type* i8 = table.make_type<PrimitiveType>("i8");
+  const Type* i16 = table.make_type<PrimitiveType>("i16");
+  const Type* i32 = table.make_type<PrimitiveType>("i32");
+  const Type* i64 = table.make_type<PrimitiveType>("i64");
+  const Type* ptr = table.make_type<PrimitiveType>("ptr");
+
+  const TargetLayout x86_64 = TargetLayout::for_arch(ConfigHandler::TargetArch::X86_64);
+  const TargetLayout arm = TargetLayout::for_arch(ConfigHandler::TargetArch::ARM);
+
+  // { i8 a; i64 b; i16 c; ptr d; i8 e; }, the worst order for padding
+  auto padded(const LayoutPolicy policy) -> StructType* {
+    auto* s = table.make_type<StructType>("Padded");
+    s->add_field("a", i8);
+    s->add_field("b", i64);
+    s->add_field("c", i16);
+    s->add_field("d", ptr);
+    s->add_field("e", i8);
+    s->set_layout_policy(policy);
+    return s;
+  }
+};
+
+struct HostPadded {
+  int8_t a;
+  int64_t b;
+  int16_t c;
+  void* d;
+  int8_t e;
+};
+
+TEST_F(TypeLayoutTest, DeclaredOrderMatchesTheHostCompiler) {
+  LayoutEngine engine(x86_64);
+  const auto* l = engine.layout(*padded(LayoutPolicy::Declared));
+  ASSERT_NE(l, nullptr);
+  EXPECT_EQ(l->size, sizeof(HostPadded));
+  EXPECT_EQ(l->align, alignof(HostPadded));
+  EXPECT_EQ(l->offset_of(0), offsetof(HostPadded, a));
+  EXPECT_EQ(l->offset_of(1), offsetof(HostPadded, b));
+  EXPECT_EQ(l->offset_of(2), offsetof(HostPadded, c));
+  EXPECT_EQ(l->offset_of(3), offsetof(HostPadded, d));
+  EXPECT_EQ(l->offset_of(4), offsetof(HostPadded, e));
+  EXPECT_EQ(l->padding, 40u - 20u);
+  EXPECT_FALSE(l->reordered);
+}
+
+TEST_F(TypeLayoutTest, PointersFollowTheTarget) {
+  auto* s = padded(LayoutPolicy::Declared);
+  LayoutEngine engine(arm);
+  const auto* l = engine.layout(*s);
+  ASSERT_NE(l, nullptr);
+  EXPECT_EQ(engine.layout(*ptr)->size, 4u);
+  EXPECT_EQ(l->offset_of(3), 20u);      // After c at 16
+  EXPECT_EQ(l->size, 32u);
+}
+
+TEST_F(TypeLayoutTest, ArraysHaveAStrideOfTheElementSize) {
+  auto* element = table.make_type<StructType>("Pair");
+  element->add_field("x", i32);
+  element->add_field("tag", i8);
+  const auto* array = table.make_type<ArrayType>(element, 10);
+
+  LayoutEngine engine(x86_64);
+  const auto* l = engine.layout(*array);
+  ASSERT_NE(l, nullptr);
+  EXPECT_EQ(l->stride, 8u);
+  EXPECT_EQ(l->size, 80u);
+  EXPECT_EQ(l->align, 4u);
+  EXPECT_EQ(l->padding, 30u);
+}
+
+TEST_F(TypeLayoutTest, ReorderingIsOptInAndNeedsO2) {
+  auto* opted_out = padded(LayoutPolicy::Declared);
+  auto* opted_in = padded(LayoutPolicy::Reorder);
+
+  LayoutEngine o1(x86_64, false);
+  EXPECT_EQ(o1.layout(*opted_in)->size, 40u);
+
+  LayoutEngine o2(x86_64, true);
+  EXPECT_EQ(o2.layout(*opted_out)->size, 40u);
+  const auto* l = o2.layout(*opted_in);
+  EXPECT_TRUE(l->reordered);
+  EXPECT_EQ(l->size, 24u);
+  EXPECT_EQ(l->padding, 4u);
+  EXPECT_EQ(o2.stats().structs_reordered, 1u);
+  EXPECT_EQ(o2.stats().padding_saved, 16u);
+
+  // Every field keeps its natural alignment
+  for (const auto& f : l->fields) {
+    EXPECT_EQ(f.offset % o2.layout(*opted_in->fields()[f.field].type)->align, 0u);
+  }
+}
+
+TEST_F(TypeLayoutTest, HotFieldsShareTheFirstCacheLine) {
+  auto* s = table.make_type<StructType>("Node");
+  const auto* cold = table.make_type<ArrayType>(i64, 16);
+  s->add_field("payload", cold);
+  s->add_field("next", ptr, true);
+  s->add_field("key", i32, true);
+  s->add_field("log", cold);
+  s->add_field("count", i16, true);
+  s->set_layout_policy(LayoutPolicy::Reorder);
+
+  LayoutEngine engine(x86_64, true);
+  const auto* l = engine.layout(*s);
+  ASSERT_NE(l, nullptr);
+  for (const size_t hot : { 1u, 2u, 4u }) {
+    EXPECT_LT(*l->offset_of(hot), 64u);
+  }
+  EXPECT_EQ(l->size, 8u + 4u + 2u + 2u + 256u);
+}
+
+TEST_F(TypeLayoutTest, FieldsAreFoundByNameInDeclarationOrder) {
+  auto* s = table.make_type<StructType>("Wide");
+  for (int i = 0; i < 200; ++i) {
+    ASSERT_TRUE(s->add_field("f" + std::to_string(i), i % 2 ? i32 : i8));
+  }
+  EXPECT_FALSE(s->add_field("f7", i64));
+  for (int i = 0; i < 200; ++i) {
+    EXPECT_EQ(s->field_index("f" + std::to_string(i)), static_cast<size_t>(i));
+  }
+  EXPECT_EQ(s->get_field("f3"), i32);
+  EXPECT_EQ(s->get_field("missing"), nullptr);
+  EXPECT_EQ(s->fields()[199].name, "f199");
+}
+
+TEST_F(TypeLayoutTest, UnsizedTypesHaveNoLayout) {
+  auto* s = table.make_type<StructType>("List");
+  s->add_field("value", i32);
+  s->add_field("next", s);      // By value, so infinitely large
+
+  LayoutEngine engine(x86_64);
+  EXPECT_EQ(engine.layout(*s), nullptr);
+  EXPECT_EQ(engine.layout(*table.make_type<PrimitiveType>("quaternion")), nullptr);
+  EXPECT_EQ(engine.layout(*table.make_type<ModuleType>("module")), nullptr);
+}
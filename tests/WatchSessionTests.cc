@@ -0,0 +1,150 @@
+#include "WatchSession.hh"
+#include "CompilerInstance.hh"
+#include <gtest/gtest.h>
+#include <map>
+#include <fmt/core.h>
+
+using namespace argc;
+using err::ErrorCode;
+using err::ErrorSeverity;
+
+namespace {
+
+// Drives a watch session through edits and after each one compares it with
+// a full recompile of the same texts by the in-process compiler
+class WatchSessionTest : public ::testing::Test {
+protected:
+  err::ErrorReporter reporter{ false, 100 };
+  ConfigHandler config{ reporter };
+  WatchSession session{ config, reporter };
+  std::map<std::string, std::string> texts;
+  std::vector<std::string> order;               // Paths as first saved; both sides see files in this order
+
+  auto save(const std::string& path, const std::string& text) -> void {
+    if (!texts.contains(path)) order.push_back(path);
+    texts[path] = text;
+    session.update(path, text);
+  }
+
+  auto watch_diagnostics() const -> std::vector<err::ErrorReporter::Error> {
+    std::vector<err::ErrorReporter::Error> all;
+    for (const auto& path : order) {
+      const auto file = session.diagnostics(path);
+      all.insert(all.end(), file.begin(), file.end());
+    }
+    return all;
+  }
+
+  auto full_build() const -> CompileResult {
+    std::vector<SourceBuffer> sources;
+    for (const auto& path : order) sources.push_back(SourceBuffer{ path, texts.at(path) });
+    CompilerInstance instance;
+    return instance.compile(sources);
+  }
+
+  // Watch mode fails whenever the build does, and shows every error the
+  // build stopped at. It may show more: the build gives up at the first
+  // failing stage, watch mode checks every line.
+  auto expect_matches_full_build(const std::string_view step) const -> void {
+    const auto full = full_build();
+    const auto watched = watch_diagnostics();
+
+    const bool watch_failed = std::any_of(watched.begin(), watched.end(), [](const auto& d) {
+      return d.severity == ErrorSeverity::Error || d.severity == ErrorSeverity::Fatal;
+    });
+    EXPECT_EQ(watch_failed, !full.succeeded) << step;
+
+    for (const auto& expected : full.diagnostics) {
+      if (expected.severity == ErrorSeverity::Warning) continue;
+      const bool shown = std::any_of(watched.begin(), watched.end(), [&](const auto& d) {
+        return d.code == expected.code && d.location.file == expected.location.file
+            && d.location.line == expected.location.line;
+      });
+      EXPECT_TRUE(shown) << step << ": watch mode misses " << expected.message
+                         << " at " << expected.location.file << ":" << expected.location.line;
+    }
+  }
+
+  auto count(const ErrorCode code) const -> size_t {
+    const auto watched = watch_diagnostics();
+    return std::count_if(watched.begin(), watched.end(), [&](const auto& d) { return d.code == code; });
+  }
+};
+
+}
+
+TEST_F(WatchSessionTest, ImportCyclesAreRejectedLikeAFullBuild) {
+  save("a.ar", "module a\nret 1\n");
+  save("b.ar", "module b\nimport a\nret 2\n");
+  expect_matches_full_build("acyclic");
+  EXPECT_EQ(count(ErrorCode::CyclicImport), 0u);
+
+  save("a.ar", "module a\nimport b\nret 1\n");
+  expect_matches_full_build("a imports b");
+  ASSERT_EQ(count(ErrorCode::CyclicImport), 1u);
+
+  // Same message and position as the build, so the offending line is the same
+  const auto full = full_build();
+  ASSERT_EQ(full.diagnostics.size(), 1u);
+  const auto watched = watch_diagnostics();
+  const auto cycle = std::find_if(watched.begin(), watched.end(), [](const auto& d) { return d.code == ErrorCode::CyclicImport; });
+  EXPECT_EQ(cycle->message, full.diagnostics[0].message);
+  EXPECT_EQ(cycle->location.file, full.diagnostics[0].location.file);
+  EXPECT_EQ(cycle->location.column, full.diagnostics[0].location.column);
+
+  save("a.ar", "module a\nret 1\n");
+  expect_matches_full_build("cycle broken");
+  EXPECT_EQ(count(ErrorCode::CyclicImport), 0u);
+}
+
+TEST_F(WatchSessionTest, RenamingAModuleCanCloseACycle) {
+  save("a.ar", "module a\nimport c\nret 1\n");
+  save("b.ar", "module b\nimport a\nret 2\n");
+  save("c.ar", "module c\nret 3\n");
+  expect_matches_full_build("chain");
+
+  save("b.ar", "module x\nimport a\nret 2\n");
+  save("c.ar", "module c\nimport x\nret 3\n");
+  expect_matches_full_build("c imports x");
+  EXPECT_EQ(count(ErrorCode::CyclicImport), 1u);
+
+  save("b.ar", "module b\nimport a\nret 2\n");
+  expect_matches_full_build("x renamed back");
+  EXPECT_EQ(count(ErrorCode::CyclicImport), 0u);
+  EXPECT_EQ(count(ErrorCode::UnresolvedImport), 1u);
+}
+
+TEST_F(WatchSessionTest, DuplicateModuleNamesAreRejected) {
+  save("a.ar", "module a\nret 1\n");
+  save("b.ar", "module b\nret 2\n");
+  save("b.ar", "module a\nret 2\n");
+  expect_matches_full_build("two modules named a");
+  EXPECT_EQ(count(ErrorCode::DuplicateModule), 1u);
+
+  save("b.ar", "module b\nret 2\n");
+  expect_matches_full_build("renamed");
+  EXPECT_EQ(count(ErrorCode::DuplicateModule), 0u);
+}
+
+TEST_F(WatchSessionTest, EditSequenceMatchesFullRecompiles) {
+  const std::vector<std::pair<std::string, std::string>> edits {
+    { "main.ar", "module main\nimport util\nret 1 + 2\n" },
+    { "util.ar", "module util\nret 3\n" },
+    { "main.ar", "module main\nimport util\nret 1 +\n" },
+    { "main.ar", "module main\nimport util\nret 1 + 2\n" },
+    { "util.ar", "module util\nimport main\nret 3\n" },
+    { "util.ar", "module util\nimport main\nret 3 / 0\n" },
+    { "util.ar", "module util\nret 65536 * 65536\n" },
+    { "main.ar", "module main\nimport util\nimport lib\nret 1\n" },
+    { "lib.ar", "module lib\nimport util\nret 4\n" },
+    { "util.ar", "module util\nimport main\nret 3\n" },
+    { "main.ar", "module main\nimport util\nret 1\n" },
+    { "util.ar", "module util\nret 3\n" },
+    { "main.ar", "ret 1\n" },
+    { "main.ar", "module main\nret 1\n" },
+  };
+  for (size_t i = 0; i < edits.size(); ++i) {
+    save(edits[i].first, edits[i].second);
+    expect_matches_full_build(fmt::format("edit {} to {}", i, edits[i].first));
+  }
+}
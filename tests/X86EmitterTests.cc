@@ -0,0 +1,182 @@
+#include "X86Emitter.hh"
+#include "HostCompile.hh"
+#include <gtest/gtest.h>
+#include <random>
+
+using namespace argc;
+using namespace argc::codegen;
+using namespace argc::test;
+
+namespace {
+
+// Every leaf distinct and every level full: the Sethi-Ullman number is the depth
+auto balanced(ModuleBuilder& b, const int depth, int32_t& leaf) -> ir::NodeId {
+  if (depth == 0) return b.constant(leaf++ % 9 + 1);
+  const auto lhs = balanced(b, depth - 1, leaf);
+  const auto rhs = balanced(b, depth - 1, leaf);
+  return b.binary(depth % 2 ? ir::Op::Add : ir::Op::Mul, lhs, rhs);
+}
+
+auto random_tree(ModuleBuilder& b, std::mt19937& rng, const int depth) -> ir::NodeId {
+  if (depth == 0 || rng() % 5 == 0) return b.constant(static_cast<int32_t>(rng() % 7) + 1);
+  const auto op = static_cast<ir::Op>(1 + rng() % 4);
+  const auto lhs = random_tree(b, rng, depth - 1);
+  const auto rhs = random_tree(b, rng, depth - 1);
+  return b.binary(op, lhs, rhs);
+}
+
+}
+
+TEST(X86EmitterTest, ChainsNeedNoRegisters) {
+  ModuleBuilder b("chain", false);
+  auto left = b.constant(1);
+  for (int i = 0; i < 100; ++i) left = b.binary(ir::Op::Add, left, b.constant(i));
+  b.end_statement(ir::StmtKind::Expression, left);
+  const auto last = b.constant(100);
+  auto right = last;
+  for (int i = 0; i < 100; ++i) right = b.binary(ir::Op::Sub, b.constant(i), right);
+  b.end_statement(ir::StmtKind::Return, right);
+
+  X86Emitter emitter;
+  emitter.emit_module(b.module);
+  EXPECT_EQ(emitter.stats().register_values, 0u);
+  EXPECT_EQ(emitter.stats().spills, 0u);
+}
+
+TEST(X86EmitterTest, NeedierOperandIsEvaluatedFirst) {
+  // (1 * 2) - ((3 * 4) + (5 * 6)): left to right, 1 * 2 would wait in a
+  // register while the right side needs another
+  ModuleBuilder b("su", false);
+  const auto small = b.binary(ir::Op::Mul, b.constant(1), b.constant(2));
+  const auto a = b.binary(ir::Op::Mul, b.constant(3), b.constant(4));
+  const auto c = b.binary(ir::Op::Mul, b.constant(5), b.constant(6));
+  const auto big = b.binary(ir::Op::Add, a, c);
+  b.end_statement(ir::StmtKind::Return, b.binary(ir::Op::Sub, small, big));
+
+  X86Emitter one_register(true, Allocation::Registers, 1);
+  const auto code = one_register.emit_module(b.module);
+  EXPECT_EQ(one_register.stats().spills, 0u);
+  EXPECT_EQ(one_register.stats().register_values, 2u);
+  EXPECT_EQ(code.find("push"), std::string::npos);
+
+  X86Emitter stack(true, Allocation::Stack);
+  stack.emit_module(b.module);
+  EXPECT_EQ(stack.stats().spills, 2u);
+}
+
+TEST(X86EmitterTest, WideTreesSpillOnlyPastTheRegisterFile) {
+  ModuleBuilder b("wide", false);
+  int32_t leaf = 0;
+  b.end_statement(ir::StmtKind::Return, balanced(b, 12, leaf));   // Needs 11 waiting values
+
+  X86Emitter all;
+  const auto code = all.emit_module(b.module);
+  EXPECT_EQ(all.stats().spills, 0u);
+  EXPECT_EQ(all.stats().callee_saved, 5u);
+  EXPECT_NE(code.find("push rbx"), std::string::npos);
+  EXPECT_NE(code.find("pop r15"), std::string::npos);
+
+  X86Emitter fewer(true, Allocation::Registers, 8);
+  fewer.emit_module(b.module);
+  EXPECT_GT(fewer.stats().spills, 0u);
+  EXPECT_EQ(fewer.stats().callee_saved, 2u);
+
+  X86Emitter stack(true, Allocation::Stack);
+  stack.emit_module(b.module);
+  EXPECT_GT(stack.stats().spills, fewer.stats().spills);
+}
+
+TEST(X86EmitterTest, SharedValuesLiveInRegistersAcrossStatements) {
+  ModuleBuilder b("shared", true);
+  const auto ab = b.binary(ir::Op::Mul, b.constant(7), b.constant(9));
+  b.end_statement(ir::StmtKind::Expression, ab);
+  const auto again = b.binary(ir::Op::Mul, b.constant(7), b.constant(9));
+  ASSERT_EQ(again, ab);
+  b.end_statement(ir::StmtKind::Expression, b.binary(ir::Op::Add, b.constant(1), b.constant(2)));
+  b.end_statement(ir::StmtKind::Return, b.binary(ir::Op::Sub, again, b.constant(3)));
+
+  X86Emitter emitter;
+  const auto code = emitter.emit_module(b.module);
+  EXPECT_EQ(emitter.stats().shared_values, 1u);
+  EXPECT_EQ(emitter.stats().register_values, 1u);
+  EXPECT_EQ(code.find("rbp"), std::string::npos);
+}
+
+// A=1+2; X=3+4; 5+6; X+7; B=8+9; C=(A+10)+11; 13+14; Z=C+15; ret B+Z with
+// one register. B is spilled after it was written, while A's slot falls
+// free at the same position; A is read after B's write, so the slot must
+// not be shared.
+TEST(X86EmitterTest, RetroactiveSpillsTakeSlotsFreeSinceTheirWrite) {
+  ModuleBuilder b("f0", true);
+  const auto value = [&](const int32_t lhs, const int32_t rhs) { return b.binary(ir::Op::Add, b.constant(lhs), b.constant(rhs)); };
+  const auto a = value(1, 2);
+  b.end_statement(ir::StmtKind::Expression, a);
+  const auto x = value(3, 4);
+  b.end_statement(ir::StmtKind::Expression, x);
+  b.end_statement(ir::StmtKind::Expression, value(5, 6));
+  b.end_statement(ir::StmtKind::Expression, b.binary(ir::Op::Add, x, b.constant(7)));
+  const auto bv = value(8, 9);
+  b.end_statement(ir::StmtKind::Expression, bv);
+  const auto c = b.binary(ir::Op::Add, b.binary(ir::Op::Add, a, b.constant(10)), b.constant(11));
+  b.end_statement(ir::StmtKind::Expression, c);
+  b.end_statement(ir::StmtKind::Expression, value(13, 14));
+  const auto z = b.binary(ir::Op::Add, c, b.constant(15));
+  b.end_statement(ir::StmtKind::Expression, z);
+  const auto result = b.end_statement(ir::StmtKind::Return, b.binary(ir::Op::Add, bv, z));
+  ASSERT_EQ(result, 56);
+
+  X86Emitter emitter(true, Allocation::Registers, 1);
+  const auto code = emitter.emit_module(b.module);
+  EXPECT_GT(emitter.stats().spills, 0u);
+  EXPECT_NE(code.find("[rbp-8]"), std::string::npos);     // A and B overlap, so two slots
+
+  if (!have_cc()) GTEST_SKIP() << "no host C compiler";
+#if defined(__x86_64__)
+  EXPECT_EQ(run_mismatches(X86Emitter::file_header() + code + X86Emitter::file_footer(), "s", { result }, "-O2"), 0);
+#endif
+}
+
+// Every lowering, with any number of registers, computes the same values
+TEST(X86EmitterTest, AllocationsAgreeWhenRun) {
+  if (!have_cc()) GTEST_SKIP() << "no host C compiler";
+
+  std::string unit = X86Emitter::file_header();
+  std::vector<int32_t> expected;
+  const auto add = [&](const ir::Module& module, X86Emitter& emitter, const int32_t value) {
+    ir::Module named{ "f" + std::to_string(expected.size()), module.exprs, module.statements };
+    unit += emitter.emit_module(named);
+    expected.push_back(value);
+  };
+
+  std::mt19937 rng(41);
+  for (int m = 0; m < 40; ++m) {
+    ModuleBuilder b("random", m % 2 == 1);
+    int32_t result = 0;
+    for (int s = 0; s < 4; ++s) {
+      const auto kind = s == 3 ? ir::StmtKind::Return : ir::StmtKind::Expression;
+      result = b.end_statement(kind, random_tree(b, rng, 7));
+    }
+    if (b.divides_by_zero()) continue;
+    for (const size_t registers : { size_t{ 0 }, size_t{ 1 }, size_t{ 3 }, X86Emitter::allocatable_registers }) {
+      X86Emitter emitter(true, Allocation::Registers, registers);
+      add(b.module, emitter, result);
+    }
+    X86Emitter stack(true, Allocation::Stack);
+    add(b.module, stack, result);
+  }
+
+  for (const int depth : { 8, 13 }) {
+    ModuleBuilder b("wide", false);
+    int32_t leaf = 0;
+    const auto result = b.end_statement(ir::StmtKind::Return, balanced(b, depth, leaf));
+    for (const size_t registers : { size_t{ 2 }, X86Emitter::allocatable_registers }) {
+      X86Emitter emitter(true, Allocation::Registers, registers);
+      add(b.module, emitter, result);
+    }
+  }
+  unit += X86Emitter::file_footer();
+
+#if defined(__x86_64__)
+  EXPECT_EQ(run_mismatches(unit, "s", expected, "-O2"), 0);
+#endif
+}